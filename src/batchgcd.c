@@ -0,0 +1,439 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "batchgcd.h"
+#include "uintp.h"
+#include "ntt.h"
+#include "workspace.h"
+
+typedef struct
+{
+  uint64_t *p;
+  size_t n;
+} node_t;
+
+typedef struct
+{
+  const uintN_t *moduli;
+  node_t **levels; /* levels[0] are the moduli, levels[depth - 1] the root */
+  size_t *counts;
+  size_t depth;
+  size_t level;
+  node_t *rem; /* remainders of level + 1 */
+  size_t rem_count;
+  node_t *next; /* remainders of level */
+  uintN_batchgcd_cb cb;
+  void *arg;
+  pthread_mutex_t lock;
+  int failed;
+} tree_t;
+
+typedef void
+(*node_fn) (tree_t *tree, size_t i);
+
+typedef struct
+{
+  tree_t *tree;
+  node_fn fn;
+  size_t count;
+  size_t next;
+} task_t;
+
+static void
+fail (tree_t *tree)
+{
+  __atomic_store_n (&tree->failed, 1, __ATOMIC_RELAXED);
+}
+
+static void *
+worker (void *arg)
+{
+  task_t *task = arg;
+  size_t i;
+
+  while (!__atomic_load_n (&task->tree->failed, __ATOMIC_RELAXED)
+      && (i = __atomic_fetch_add (&task->next, 1, __ATOMIC_RELAXED))
+	  < task->count)
+    task->fn (task->tree, i);
+  return NULL;
+}
+
+/*
+ * fn for every node i < count of a level, on up to threads threads counting
+ * the caller.
+ */
+static void
+parallel (tree_t *tree, node_fn fn, size_t count, unsigned int threads)
+{
+  task_t task =
+    { tree, fn, count, 0 };
+  pthread_t tid[UINTN_BATCHGCD_MAX_THREADS];
+  unsigned int i, started;
+
+  threads = min(threads, count);
+
+  // a thread that fails to start only leaves more work to the others
+  for (started = 0; started + 1 < threads; started++)
+    if (pthread_create (&tid[started], NULL, worker, &task) != 0)
+      break;
+
+  worker (&task);
+
+  for (i = 0; i < started; i++)
+    pthread_join (tid[i], NULL);
+}
+
+static void
+free_nodes (node_t *v, size_t count)
+{
+  size_t i;
+
+  if (v == NULL)
+    return;
+  for (i = 0; i < count; i++)
+    free (v[i].p);
+  free (v);
+}
+
+static bool
+copy_node (node_t *r, const node_t *a)
+{
+  r->p = malloc (max(a->n, 1) * sizeof(uint64_t));
+  if (r->p == NULL)
+    return false;
+  uintp_copy (r->p, a->p, a->n);
+  r->n = a->n;
+  return true;
+}
+
+/*
+ * node i of level + 1 is the product of the nodes 2i and 2i + 1 of level.
+ */
+static void
+product_node (tree_t *tree, size_t i)
+{
+  const node_t *a = &tree->levels[tree->level][2 * i];
+  node_t *r = &tree->levels[tree->level + 1][i];
+
+  // the odd one out moves up unchanged
+  if (2 * i + 1 == tree->counts[tree->level])
+    {
+      if (!copy_node (r, a))
+	fail (tree);
+      return;
+    }
+
+  r->n = a[0].n + a[1].n;
+  r->p = malloc (r->n * sizeof(uint64_t));
+  if (r->p == NULL
+      || !uintp_mul_large (r->p, a[0].p, a[0].n, a[1].p, a[1].n))
+    {
+      fail (tree);
+      return;
+    }
+  r->n = uintp_normalize (r->p, r->n);
+}
+
+/*
+ * remainder of node i of level, the remainder of its parent modulo its
+ * square.
+ */
+static void
+remainder_node (tree_t *tree, size_t i)
+{
+  const node_t *c = &tree->levels[tree->level][i];
+  const node_t *parent = &tree->rem[i / 2];
+  node_t *r = &tree->next[i];
+  uint64_t *sq;
+  size_t sn;
+
+  sq = malloc (2 * c->n * sizeof(uint64_t));
+  r->p = malloc (2 * c->n * sizeof(uint64_t));
+  if (sq == NULL || r->p == NULL)
+    {
+      free (sq);
+      fail (tree);
+      return;
+    }
+
+  if (!uintp_mul_large (sq, c->p, c->n, c->p, c->n))
+    {
+      free (sq);
+      fail (tree);
+      return;
+    }
+  sn = uintp_normalize (sq, 2 * c->n);
+
+  if (parent->n < sn)
+    {
+      uintp_copy (r->p, parent->p, parent->n);
+      uintp_zero (r->p + parent->n, sn - parent->n);
+    }
+  else if (!uintp_divrem_large (NULL, r->p, parent->p, parent->n, sq, sn))
+    {
+      free (sq);
+      fail (tree);
+      return;
+    }
+  r->n = uintp_normalize (r->p, sn);
+
+  free (sq);
+}
+
+/*
+ * g = gcd(N_i, (P mod N_i^2) / N_i) for modulus i, from the remainder of its
+ * parent.
+ */
+static void
+leaf_node (tree_t *tree, size_t i)
+{
+  const uintN_t *m = &tree->moduli[i];
+  const node_t *parent = &tree->rem[i / 2];
+  uintN_ws_t *ws = uintN_ws_thread ();
+  size_t n, sn, rn;
+
+  n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *sq = uintN_ws_alloc (ws, 2 * n);
+  uint64_t *r = uintN_ws_alloc (ws, 2 * n);
+  uint64_t *t = uintN_ws_alloc (ws, NUMBER_OF_PARTS + 1);
+  uint64_t *tp = uintN_ws_alloc (ws,
+				 UINTP_DIVREM_SCRATCH(max(parent->n, 2 * n),
+						      2 * n));
+  uintN_t *g = uintN_ws_alloc_N (ws);
+
+  uintp_sqr (sq, m->parts, n);
+  sn = uintp_normalize (sq, 2 * n);
+
+  // r = P mod N^2, the parent has at most twice the limbs of N^2
+  if (parent->n < sn)
+    {
+      uintp_copy (r, parent->p, parent->n);
+      uintp_zero (r + parent->n, sn - parent->n);
+    }
+  else
+    uintp_divrem (NULL, r, parent->p, parent->n, sq, sn, tp);
+  rn = uintp_normalize (r, sn);
+
+  // t = r / N < N
+  uintp_zero (t, NUMBER_OF_PARTS + 1);
+  if (rn >= n)
+    uintp_divrem (t, NULL, r, rn, m->parts, n, tp);
+
+  uintN_gcd_ws (m, (const uintN_t *) t, g, ws);
+  if (!uintN_isone (g))
+    {
+      pthread_mutex_lock (&tree->lock);
+      tree->cb (i, g, tree->arg);
+      pthread_mutex_unlock (&tree->lock);
+    }
+
+  uintN_ws_release (ws, mark);
+}
+
+bool
+uintN_batchgcd (const uintN_t *moduli, size_t k, unsigned int threads,
+		uintN_batchgcd_cb cb, void *arg)
+{
+  assert(moduli != NULL || k == 0);
+  assert(cb != NULL);
+
+  tree_t tree;
+  size_t i, c, level;
+  long cpus;
+  bool ok;
+
+  if (k == 0)
+    return true;
+
+  if (threads == 0)
+    {
+      cpus = sysconf (_SC_NPROCESSORS_ONLN);
+      threads = cpus > 0 ? cpus : 1;
+    }
+  threads = min(threads, UINTN_BATCHGCD_MAX_THREADS);
+
+  memset (&tree, 0, sizeof(tree));
+  tree.moduli = moduli;
+  tree.cb = cb;
+  tree.arg = arg;
+  pthread_mutex_init (&tree.lock, NULL);
+
+  for (c = k, tree.depth = 1; c > 1; c = (c + 1) / 2)
+    tree.depth++;
+
+  tree.levels = calloc (tree.depth, sizeof(node_t *));
+  tree.counts = calloc (tree.depth, sizeof(size_t));
+  if (tree.levels == NULL || tree.counts == NULL
+      || (tree.levels[0] = malloc (k * sizeof(node_t))) == NULL)
+    {
+      free (tree.levels);
+      free (tree.counts);
+      pthread_mutex_destroy (&tree.lock);
+      return false;
+    }
+
+  // the leaves point into the moduli
+  for (i = 0; i < k; i++)
+    {
+      tree.levels[0][i].p = (uint64_t *) moduli[i].parts;
+      tree.levels[0][i].n = uintp_normalize (moduli[i].parts,
+					     NUMBER_OF_PARTS);
+      assert(tree.levels[0][i].n > 0);
+    }
+  tree.counts[0] = k;
+
+  // up the product tree
+  for (level = 0; level + 1 < tree.depth && !tree.failed; level++)
+    {
+      tree.counts[level + 1] = (tree.counts[level] + 1) / 2;
+      tree.levels[level + 1] = calloc (tree.counts[level + 1],
+				       sizeof(node_t));
+      if (tree.levels[level + 1] == NULL)
+	{
+	  fail (&tree);
+	  break;
+	}
+      tree.level = level;
+      parallel (&tree, product_node, tree.counts[level + 1], threads);
+    }
+
+  // down the remainder tree, the root is its own remainder P mod P^2
+  if (!tree.failed)
+    {
+      tree.rem = calloc (1, sizeof(node_t));
+      tree.rem_count = 1;
+      if (tree.rem == NULL
+	  || !copy_node (tree.rem, &tree.levels[tree.depth - 1][0]))
+	fail (&tree);
+    }
+
+  for (level = tree.depth - 1; level > 1 && !tree.failed;)
+    {
+      level--;
+      tree.next = calloc (tree.counts[level], sizeof(node_t));
+      if (tree.next == NULL)
+	{
+	  fail (&tree);
+	  break;
+	}
+      tree.level = level;
+      parallel (&tree, remainder_node, tree.counts[level], threads);
+
+      free_nodes (tree.rem, tree.rem_count);
+      tree.rem = tree.next;
+      tree.rem_count = tree.counts[level];
+      tree.next = NULL;
+
+      // a product level is done once the remainders below it exist
+      free_nodes (tree.levels[level + 1], tree.counts[level + 1]);
+      tree.levels[level + 1] = NULL;
+    }
+
+  if (!tree.failed)
+    parallel (&tree, leaf_node, k, threads);
+
+  ok = !tree.failed;
+
+  free_nodes (tree.rem, tree.rem_count);
+  for (i = 1; i < tree.depth; i++)
+    free_nodes (tree.levels[i], tree.counts[i]);
+  free (tree.levels[0]);
+  free (tree.levels);
+  free (tree.counts);
+  pthread_mutex_destroy (&tree.lock);
+
+  return ok;
+}
+
+typedef struct
+{
+  FILE *out;
+  ssize_t found;
+} report_t;
+
+static void
+report (size_t i, const uintN_t *g, void *arg)
+{
+  report_t *rep = arg;
+  size_t n;
+
+  n = uintp_normalize (g->parts, NUMBER_OF_PARTS);
+  fprintf (rep->out, "%zu %" PRIx64, i, g->parts[n - 1]);
+  while (n-- > 1)
+    fprintf (rep->out, "%016" PRIx64, g->parts[n - 1]);
+  fputc ('\n', rep->out);
+
+  rep->found++;
+}
+
+ssize_t
+uintN_batchgcd_file (const char *path, FILE *out, unsigned int threads)
+{
+  assert(path != NULL);
+  assert(out != NULL);
+
+  int fd;
+  struct stat st;
+  size_t i, k;
+  const uintN_t *moduli;
+  void *map;
+  report_t rep =
+    { out, 0 };
+
+  fd = open (path, O_RDONLY);
+  if (fd < 0)
+    return -1;
+  if (fstat (fd, &st) != 0)
+    {
+      close (fd);
+      return -1;
+    }
+  if (st.st_size % NUMBER_OF_BYTES != 0)
+    {
+      close (fd);
+      errno = EINVAL;
+      return -1;
+    }
+
+  k = st.st_size / NUMBER_OF_BYTES;
+  if (k == 0)
+    {
+      close (fd);
+      return 0;
+    }
+
+  map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    return -1;
+  madvise (map, st.st_size, MADV_WILLNEED);
+  moduli = map;
+
+  for (i = 0; i < k; i++)
+    if (uintN_iszero (&moduli[i]))
+      {
+	munmap (map, st.st_size);
+	errno = EINVAL;
+	return -1;
+      }
+
+  if (!uintN_batchgcd (moduli, k, threads, report, &rep))
+    {
+      rep.found = -1;
+      errno = ENOMEM;
+    }
+
+  munmap (map, st.st_size);
+  return rep.found;
+}
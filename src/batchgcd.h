@@ -0,0 +1,83 @@
+/*
+ * batchgcd.h
+ *
+ * Header file for Bernstein's batch GCD over a large set of moduli.
+ *
+ * Testing every pair of k moduli for a common factor costs k^2 / 2 gcds.
+ * Batch GCD finds all moduli that share a factor with any other one in
+ * quasi-linear time:
+ *
+ *   product tree    the moduli are the leaves, every node is the product of
+ *                   its two children, the root is P = N_0 N_1 ... N_(k-1).
+ *   remainder tree  going back down, every node receives the remainder of
+ *                   its parent modulo its own square, the leaves end up with
+ *                   P mod N_i^2.
+ *   leaves          g_i = gcd(N_i, (P mod N_i^2) / N_i), which is the product
+ *                   of the factors N_i shares with the other moduli.
+ *
+ * The nodes grow far beyond NUMBER_OF_BITS, they are limb arrays multiplied
+ * and divided with uintp_mul_large and uintp_divrem_large. The nodes of a
+ * tree level are independent and computed on several threads. A level of
+ * the product tree takes about as much memory as the input, all levels are
+ * kept until the way down passes them.
+ *
+ * Every modulus with g_i != 1 is reported through a callback as soon as its
+ * leaf is done, g_i = N_i means all of its factors are shared (for instance
+ * a duplicate).
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef BATCHGCD_H_
+#define BATCHGCD_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "uintN.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* upper bound on the number of threads */
+#define UINTN_BATCHGCD_MAX_THREADS 256
+
+typedef void
+(*uintN_batchgcd_cb) (size_t i, const uintN_t *g, void *arg);
+
+/**
+ * batch gcd of the k non-zero moduli, cb is called with the index and g_i
+ * for every modulus that shares a factor with another one. calls to cb are
+ * serialized but not ordered. threads is the number of threads, 0 for one
+ * per online processor.
+ * returns false if memory ran out.
+ *
+ * The running time of implemented algorithm is O(M(k n) log k), M the cost of
+ * a multiplication and n the limbs of a modulus.
+ */
+bool
+uintN_batchgcd (const uintN_t *moduli, size_t k, unsigned int threads,
+		uintN_batchgcd_cb cb, void *arg);
+
+/**
+ * batch gcd of the moduli in the file at path, k records of NUMBER_OF_BYTES
+ * bytes each holding the limbs of a uintN_t least significant first (an
+ * array of uintN_t as written by fwrite). the file is mapped, not read.
+ * every modulus sharing a factor is written to out as a line with its
+ * index and g_i in hex.
+ * returns the number of such moduli, or -1 with errno set if the file could
+ * not be mapped, is not made of non-zero records or memory ran out.
+ *
+ * The running time of implemented algorithm is O(M(k n) log k).
+ */
+ssize_t
+uintN_batchgcd_file (const char *path, FILE *out, unsigned int threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BATCHGCD_H_ */
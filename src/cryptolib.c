@@ -1,12 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
 
 #include "uintN.h"
+#include "loadgen.h"
+#include "tune.h"
 #include "../test/test.h"
 
-int main(void)
+int main(int argc, char **argv)
 {
+	// cryptolib load [options] runs the workload driver instead
+	if (argc > 1 && strcmp(argv[1], "load") == 0)
+		return loadgen_main(argc - 1, argv + 1, stdout);
+
+	// cryptolib tune [profile] tunes the thresholds for this machine
+	if (argc > 1 && strcmp(argv[1], "tune") == 0)
+		return uintN_tune_main(argc - 1, argv + 1, stdout);
+
 	test();
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#include "fixedbase.h"
+#include "uintp.h"
+
+#define ENTRY(fb, s, j) ((fb)->table + (((size_t) (s) << (fb)->teeth) + (j)) * (fb)->mont.n)
+
+static unsigned int
+get_bit (const uint64_t *a, size_t pos)
+{
+  if (pos >= NUMBER_OF_BITS)
+    return 0;
+  return (a[pos / PART_SIZE_BITS] >> (pos % PART_SIZE_BITS)) & 1;
+}
+
+bool
+uintN_fb_init (uintN_fb_t *fb, const uintN_t *g, const uintN_t *p,
+	       uint16_t ebits, uint8_t teeth, uint8_t blocks)
+{
+  assert(fb != NULL);
+  assert(g != NULL);
+  assert(p != NULL);
+  assert(ebits > 0 && ebits <= NUMBER_OF_BITS);
+  assert(teeth > 0 && teeth < 16);
+  assert(blocks > 0);
+
+  size_t n, k, s, j, i;
+
+  memset (fb, 0, sizeof(*fb));
+
+  if (!uintN_mont_init (&fb->mont, p))
+    return false;
+
+  n = fb->mont.n;
+  fb->ebits = ebits;
+  fb->teeth = teeth;
+  fb->a = (ebits + teeth - 1) / teeth;
+  fb->b = (fb->a + blocks - 1) / blocks;
+  // drop columns that would lie entirely past a
+  fb->blocks = (fb->a + fb->b - 1) / fb->b;
+  blocks = fb->blocks;
+
+  fb->table = malloc (((size_t) blocks << teeth) * n * sizeof(uint64_t));
+  if (fb->table == NULL)
+    return false;
+
+  uintN_ws_t *ws = uintN_ws_thread ();
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, 2 * n);
+  uint64_t *pw = uintN_ws_alloc (ws, n);
+  uintN_t *_g = uintN_ws_alloc_N (ws);
+
+  // pw = g R, then walk g ^ (2 ^ (k a + s b)) in one chain of squarings
+  uintN_mod_ws (g, p, _g, ws);
+  uintN_set (&fb->g, _g->parts);
+  uintN_mont_mulp (&fb->mont, pw, _g->parts, fb->mont.rr.parts, tp);
+
+  for (s = 0; s < blocks; s++)
+    uintp_copy (ENTRY(fb, s, 0), fb->mont.one.parts, n);
+
+  for (k = 0; k < teeth; k++)
+    for (s = 0; s < blocks; s++)
+      {
+	// table[s][j | 1 << k] = table[s][j] * g ^ (2 ^ (k a + s b))
+	for (j = 0; j < ((size_t) 1 << k); j++)
+	  uintN_mont_mulp (&fb->mont, ENTRY(fb, s, j | ((size_t) 1 << k)),
+			   ENTRY(fb, s, j), pw, tp);
+
+	// advance to the next column, or to the next row from the last one
+	for (i = (s + 1 < blocks) ? fb->b : fb->a - s * fb->b; i > 0; i--)
+	  uintN_mont_mulp (&fb->mont, pw, pw, pw, tp);
+      }
+
+  uintN_ws_release (ws, mark);
+
+  return true;
+}
+
+void
+uintN_fb_free (uintN_fb_t *fb)
+{
+  assert(fb != NULL);
+
+  if (fb->table != NULL && !fb->mapped)
+    {
+      uintN_wipe (fb->table, UINTN_FB_TABLE_SIZE(fb) * sizeof(uint64_t));
+      free (fb->table);
+    }
+  uintN_wipe (fb, sizeof(*fb));
+}
+
+/*
+ * r = table[s][j] without an access pattern depending on j.
+ */
+static void
+lookup (const uintN_fb_t *fb, size_t s, size_t j, uint64_t *r)
+{
+  size_t t, i, n;
+  uint64_t mask;
+
+  n = fb->mont.n;
+  uintp_zero (r, n);
+
+  for (t = 0; t < ((size_t) 1 << fb->teeth); t++)
+    {
+      mask = -(((uint64_t) (t ^ j) - 1) >> 63);
+      for (i = 0; i < n; i++)
+	r[i] |= ENTRY(fb, s, t)[i] & mask;
+    }
+}
+
+void
+uintN_fb_modp (const uintN_fb_t *fb, const uintN_t *exp, uintN_t *dest,
+	       uintN_ws_t *ws)
+{
+  assert(fb != NULL);
+  assert(exp != NULL);
+  assert(dest != NULL);
+  assert(ws != NULL);
+
+  size_t n, i, s, k, j, col;
+
+  n = fb->mont.n;
+
+  if (fb->ebits < NUMBER_OF_BITS)
+    {
+      uintN_t high;
+
+      uintN_rshift (exp, fb->ebits, &high);
+      if (!uintN_iszero (&high))
+	{
+	  uintN_mont_modp (&fb->mont, &fb->g, exp, dest, ws);
+	  return;
+	}
+    }
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, 2 * n);
+  uint64_t *e = uintN_ws_alloc (ws, n);
+  uintN_t *acc = uintN_ws_alloc_N (ws);
+
+  uintN_zeroize (acc);
+  uintp_copy (acc->parts, fb->mont.one.parts, n);
+
+  for (i = fb->b; i > 0;)
+    {
+      i--;
+      if (i + 1 < fb->b)
+	uintN_mont_mulp (&fb->mont, acc->parts, acc->parts, acc->parts, tp);
+
+      for (s = fb->blocks; s > 0;)
+	{
+	  s--;
+	  col = s * fb->b + i;
+	  if (col >= fb->a)
+	    continue;
+
+	  for (k = 0, j = 0; k < fb->teeth; k++)
+	    j |= (size_t) get_bit (exp->parts, k * fb->a + col) << k;
+
+	  lookup (fb, s, j, e);
+	  uintN_mont_mulp (&fb->mont, acc->parts, acc->parts, e, tp);
+	}
+    }
+
+  uintN_mont_from (&fb->mont, acc, dest, ws);
+
+  uintN_ws_release (ws, mark);
+}
@@ -0,0 +1,85 @@
+/*
+ * fixedbase.h
+ *
+ * Header file for fixed-base modular exponentiation g ^ e (mod p).
+ *
+ * When the base and modulus are fixed, e.g. the generator of a DH group,
+ * the powers of g can be computed once. The implementation use the Lim-Lee
+ * comb: the exponent is cut into teeth rows of a bits, each row again into
+ * blocks columns of b bits, and table[s][j] holds the product of
+ * g ^ (2 ^ (k a + s b)) over the bits k set in j. An exponentiation then
+ * needs b - 1 squarings and b * blocks multiplications.
+ *
+ * Table lookups scan the whole table and every step multiplies, so the
+ * running time does not depend on the exponent.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef FIXEDBASE_H_
+#define FIXEDBASE_H_
+
+#include <stddef.h>
+
+#include "uintN.h"
+#include "workspace.h"
+#include "montgomery.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* default comb shape, a table of 4 * 2^6 entries */
+#define UINTN_FB_TEETH 6
+#define UINTN_FB_BLOCKS 4
+
+typedef struct
+{
+  uintN_mont_t mont;
+  uintN_t g;
+  uint64_t *table;
+  size_t ebits;
+  size_t a;
+  size_t b;
+  uint8_t teeth;
+  uint8_t blocks;
+  bool mapped; /* table lives in a read-only mapping, see tables.h */
+} uintN_fb_t;
+
+/* limbs of the comb table of fb */
+#define UINTN_FB_TABLE_SIZE(fb) (((size_t) (fb)->blocks << (fb)->teeth) * (fb)->mont.n)
+
+/**
+ * fixed-base init for g (mod p) and exponents of up to ebits bits.
+ * returns false if p is even or the table could not be allocated.
+ *
+ * The running time of implemented algorithm is O(ebits + blocks 2^teeth)
+ * multiplications.
+ */
+bool
+uintN_fb_init (uintN_fb_t *fb, const uintN_t *g, const uintN_t *p,
+	       uint16_t ebits, uint8_t teeth, uint8_t blocks);
+
+/**
+ * fixed-base free the table, a mapped table is left to its mapping.
+ */
+void
+uintN_fb_free (uintN_fb_t *fb);
+
+/**
+ * fixed-base modular exponentiation c ≡ g ^ exp (mod p).
+ * exponents longer than ebits fall back to uintN_mont_modp.
+ *
+ * The running time of implemented algorithm is O(ebits / teeth)
+ * multiplications.
+ */
+void
+uintN_fb_modp (const uintN_fb_t *fb, const uintN_t *exp, uintN_t *c,
+	       uintN_ws_t *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FIXEDBASE_H_ */
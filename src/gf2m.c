@@ -0,0 +1,329 @@
+#include <assert.h>
+#include <string.h>
+
+#include "gf2m.h"
+#include "uintp.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_PCLMUL 1
+#endif
+
+/*
+ * low half of the carry-less product of x and y. Each operand is cut into
+ * four parts keeping one bit in every four, so the integer product of two
+ * parts adds at most 15 ones into any bit below 60. Their sum fits the bit
+ * and the three above it, which belong to other parts and are masked off.
+ */
+static inline uint64_t
+bmul64 (uint64_t x, uint64_t y)
+{
+  const uint64_t m0 = 0x1111111111111111, m1 = m0 << 1, m2 = m0 << 2, m3 =
+      m0 << 3;
+  uint64_t x0, x1, x2, x3, y0, y1, y2, y3, z0, z1, z2, z3;
+
+  x0 = x & m0;
+  x1 = x & m1;
+  x2 = x & m2;
+  x3 = x & m3;
+  y0 = y & m0;
+  y1 = y & m1;
+  y2 = y & m2;
+  y3 = y & m3;
+
+  z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+  z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+  z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+  z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+
+  return (z0 & m0) | (z1 & m1) | (z2 & m2) | (z3 & m3);
+}
+
+static inline uint64_t
+rev64 (uint64_t x)
+{
+  x = ((x >> 1) & 0x5555555555555555) | ((x & 0x5555555555555555) << 1);
+  x = ((x >> 2) & 0x3333333333333333) | ((x & 0x3333333333333333) << 2);
+  x = ((x >> 4) & 0x0f0f0f0f0f0f0f0f) | ((x & 0x0f0f0f0f0f0f0f0f) << 4);
+  return __builtin_bswap64 (x);
+}
+
+/*
+ * x with a zero bit after every bit, the square of a 32-bit polynomial.
+ */
+static inline uint64_t
+spread (uint32_t x)
+{
+  uint64_t v = x;
+
+  v = (v | (v << 16)) & 0x0000ffff0000ffff;
+  v = (v | (v << 8)) & 0x00ff00ff00ff00ff;
+  v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0f;
+  v = (v | (v << 2)) & 0x3333333333333333;
+  v = (v | (v << 1)) & 0x5555555555555555;
+  return v;
+}
+
+void
+uintp_clmul_portable (uint64_t *r, const uint64_t *a, size_t an,
+		      const uint64_t *b, size_t bn)
+{
+  assert(r != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+
+  size_t i, j;
+  uint64_t ra;
+
+  uintp_zero (r, an + bn);
+  for (i = 0; i < an; i++)
+    {
+      // the high half is the reversed low half of the reversed operands
+      ra = rev64 (a[i]);
+      for (j = 0; j < bn; j++)
+	{
+	  r[i + j] ^= bmul64 (a[i], b[j]);
+	  r[i + j + 1] ^= rev64 (bmul64 (ra, rev64 (b[j]))) >> 1;
+	}
+    }
+}
+
+#ifdef HAVE_PCLMUL
+__attribute__((target ("pclmul")))
+static void
+clmul_pclmul (uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b,
+	      size_t bn)
+{
+  size_t i, j;
+  __m128i x, z;
+
+  uintp_zero (r, an + bn);
+  for (i = 0; i < an; i++)
+    {
+      x = _mm_cvtsi64_si128 ((long long) a[i]);
+      for (j = 0; j < bn; j++)
+	{
+	  z = _mm_clmulepi64_si128 (x, _mm_cvtsi64_si128 ((long long) b[j]),
+				    0x00);
+	  r[i + j] ^= (uint64_t) _mm_cvtsi128_si64 (z);
+	  r[i + j + 1] ^= (uint64_t) _mm_cvtsi128_si64 (
+	      _mm_unpackhi_epi64 (z, z));
+	}
+    }
+}
+#endif
+
+void
+uintp_clmul (uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b,
+	     size_t bn)
+{
+  assert(r != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+
+#ifdef HAVE_PCLMUL
+  if (__builtin_cpu_supports ("pclmul"))
+    {
+      clmul_pclmul (r, a, an, b, bn);
+      return;
+    }
+#endif
+  uintp_clmul_portable (r, a, an, b, bn);
+}
+
+bool
+uintN_gf2m_init (uintN_gf2m_t *f, unsigned int m, unsigned int k1,
+		 unsigned int k2, unsigned int k3)
+{
+  assert(f != NULL);
+
+  memset (f, 0, sizeof(*f));
+
+  if (m > NUMBER_OF_BITS || k1 >= m || k1 == 0)
+    return false;
+  if ((k2 != 0 || k3 != 0) && !(k1 > k2 && k2 > k3 && k3 > 0))
+    return false;
+
+  f->m = m;
+  f->k[0] = k1;
+  f->k[1] = k2;
+  f->k[2] = k3;
+  f->terms = k2 == 0 ? 1 : 3;
+  f->n = (m + PART_SIZE_BITS - 1) / PART_SIZE_BITS;
+
+  return true;
+}
+
+/*
+ * t ^= h x^d for d + 63 below the degree bound of the tn limbs of t.
+ */
+static inline void
+fold (uint64_t *t, size_t tn, uint64_t h, size_t d)
+{
+  size_t l = d / PART_SIZE_BITS;
+  unsigned int s = d % PART_SIZE_BITS;
+
+  t[l] ^= h << s;
+  if (s != 0 && l + 1 < tn)
+    t[l + 1] ^= h >> (PART_SIZE_BITS - s);
+}
+
+/*
+ * t = t mod f in place for tn limbs, from the top limb down. x^m = x^k1 +
+ * ... + 1 moves every word down by at least m - k1 bits, so a word is
+ * cleared in a fixed number of passes whatever its value.
+ */
+static void
+reduce (const uintN_gf2m_t *f, uint64_t *t, size_t tn)
+{
+  size_t i, d, top = f->m / PART_SIZE_BITS;
+  unsigned int s = f->m % PART_SIZE_BITS, j, pass, passes;
+  uint64_t h;
+
+  passes = (PART_SIZE_BITS + (f->m - f->k[0]) - 1) / (f->m - f->k[0]);
+
+  for (i = tn; i-- > top;)
+    for (pass = 0; pass < passes; pass++)
+      {
+	// the coefficients of x^d and up in limb i, d >= m
+	if (i == top)
+	  {
+	    h = s == 0 ? t[i] : t[i] >> s;
+	    t[i] = s == 0 ? 0 : t[i] & ((1ull << s) - 1);
+	    d = f->m;
+	  }
+	else
+	  {
+	    h = t[i];
+	    t[i] = 0;
+	    d = i * PART_SIZE_BITS;
+	  }
+
+	d -= f->m;
+	fold (t, tn, h, d);
+	for (j = 0; j < f->terms; j++)
+	  fold (t, tn, h, d + f->k[j]);
+      }
+}
+
+void
+uintN_gf2m_reduce (const uintN_gf2m_t *f, const uintN_t *a, uintN_t *c)
+{
+  assert(f != NULL);
+  assert(a != NULL);
+  assert(c != NULL);
+
+  uint64_t t[NUMBER_OF_PARTS];
+
+  uintp_copy (t, a->parts, NUMBER_OF_PARTS);
+  reduce (f, t, NUMBER_OF_PARTS);
+  uintN_zeroize (c);
+  uintp_copy (c->parts, t, f->n);
+}
+
+void
+uintN_gf2m_add (const uintN_gf2m_t *f, const uintN_t *a, const uintN_t *b,
+		uintN_t *c)
+{
+  assert(f != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(c != NULL);
+
+  size_t i;
+
+  for (i = 0; i < f->n; i++)
+    c->parts[i] = a->parts[i] ^ b->parts[i];
+  uintp_zero (c->parts + f->n, NUMBER_OF_PARTS - f->n);
+}
+
+void
+uintN_gf2m_mul (const uintN_gf2m_t *f, const uintN_t *a, const uintN_t *b,
+		uintN_t *c, uintN_ws_t *ws)
+{
+  assert(f != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(c != NULL);
+  assert(ws != NULL);
+
+  size_t n = f->n;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *t = uintN_ws_alloc (ws, 2 * n);
+
+  uintp_clmul (t, a->parts, n, b->parts, n);
+  reduce (f, t, 2 * n);
+  uintN_zeroize (c);
+  uintp_copy (c->parts, t, n);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_gf2m_sqr (const uintN_gf2m_t *f, const uintN_t *a, uintN_t *c,
+		uintN_ws_t *ws)
+{
+  assert(f != NULL);
+  assert(a != NULL);
+  assert(c != NULL);
+  assert(ws != NULL);
+
+  size_t n = f->n, i;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *t = uintN_ws_alloc (ws, 2 * n);
+
+  for (i = 0; i < n; i++)
+    {
+      t[2 * i] = spread ((uint32_t) a->parts[i]);
+      t[2 * i + 1] = spread ((uint32_t) (a->parts[i] >> 32));
+    }
+  reduce (f, t, 2 * n);
+  uintN_zeroize (c);
+  uintp_copy (c->parts, t, n);
+
+  uintN_ws_release (ws, mark);
+}
+
+bool
+uintN_gf2m_inv (const uintN_gf2m_t *f, const uintN_t *a, uintN_t *c,
+		uintN_ws_t *ws)
+{
+  assert(f != NULL);
+  assert(a != NULL);
+  assert(c != NULL);
+  assert(ws != NULL);
+
+  unsigned int e = f->m - 1, k = 1, i;
+  int bit;
+  bool nonzero = !uintN_iszero (a);
+
+  size_t mark = uintN_ws_mark (ws);
+  uintN_t *r = uintN_ws_alloc_N (ws);
+  uintN_t *t = uintN_ws_alloc_N (ws);
+
+  // r = a^(2^k - 1), up the bits of m - 1: k -> 2k and k -> k + 1
+  uintN_set (r, a->parts);
+  for (bit = 30 - __builtin_clz (e); bit >= 0; bit--)
+    {
+      uintN_set (t, r->parts);
+      for (i = 0; i < k; i++)
+	uintN_gf2m_sqr (f, t, t, ws);
+      uintN_gf2m_mul (f, t, r, r, ws);
+      k *= 2;
+
+      if ((e >> bit) & 1)
+	{
+	  uintN_gf2m_sqr (f, r, r, ws);
+	  uintN_gf2m_mul (f, r, a, r, ws);
+	  k++;
+	}
+    }
+
+  // a^(2^m - 2) = (a^(2^(m - 1) - 1))^2
+  uintN_gf2m_sqr (f, r, c, ws);
+
+  uintN_ws_release (ws, mark);
+  return nonzero;
+}
@@ -0,0 +1,129 @@
+/*
+ * gf2m.h
+ *
+ * Header file for arithmetic in binary fields GF(2^m).
+ *
+ * An element is a polynomial over GF(2) of degree below m, held in a uintN_t
+ * with the coefficient of x^i in bit i. The field is given by a sparse
+ * irreducible polynomial, a trinomial f = x^m + x^k1 + 1 or a pentanomial
+ * f = x^m + x^k1 + x^k2 + x^k3 + 1, e.g.
+ *
+ *   GF(2^128)  x^128 + x^7 + x^2 + x + 1 (the GCM polynomial, in plain
+ *              rather than GCM's reflected bit order)
+ *   GF(2^233)  x^233 + x^74 + 1
+ *   GF(2^283)  x^283 + x^12 + x^7 + x^5 + 1
+ *
+ * Products are carry-less: uintp_clmul uses the PCLMULQDQ instruction when
+ * the processor has it and otherwise multiplies with integer multiplications
+ * on operands with holes every four bits, which keeps the carries out of
+ * the bits that count (as in BearSSL). Both run in constant time. Squaring
+ * is linear over GF(2) and only spreads the bits. The reduction folds the
+ * words above x^m down along the terms of f.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef GF2M_H_
+#define GF2M_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uintN.h"
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+typedef struct
+{
+  unsigned int m;
+  unsigned int k[3]; /* exponents of the middle terms, descending */
+  unsigned int terms; /* 1 for a trinomial, 3 for a pentanomial */
+  size_t n; /* limbs of an element */
+} uintN_gf2m_t;
+
+/**
+ * gf2m field of f = x^m + x^k1 + x^k2 + x^k3 + 1, k2 = k3 = 0 for a
+ * trinomial. f must be irreducible, which is not checked.
+ * returns false unless m <= NUMBER_OF_BITS and m > k1 > k2 > k3 > 0, or
+ * m > k1 > 0 = k2 = k3.
+ */
+bool
+uintN_gf2m_init (uintN_gf2m_t *f, unsigned int m, unsigned int k1,
+		 unsigned int k2, unsigned int k3);
+
+/**
+ * uintp carry-less product r = a * b of polynomials, r holds an + bn limbs
+ * and must not overlap a or b.
+ *
+ * The running time of implemented algorithm is O(an bn).
+ */
+void
+uintp_clmul (uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b,
+	     size_t bn);
+
+/**
+ * uintp carry-less product as uintp_clmul without the carry-less multiply
+ * instruction, the code path of processors that lack it.
+ *
+ * The running time of implemented algorithm is O(an bn).
+ */
+void
+uintp_clmul_portable (uint64_t *r, const uint64_t *a, size_t an,
+		      const uint64_t *b, size_t bn);
+
+/**
+ * gf2m reduction c = a mod f of any polynomial a.
+ *
+ * The running time of implemented algorithm is O(NUMBER_OF_PARTS).
+ */
+void
+uintN_gf2m_reduce (const uintN_gf2m_t *f, const uintN_t *a, uintN_t *c);
+
+/**
+ * gf2m sum c = a + b, the same as the difference.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintN_gf2m_add (const uintN_gf2m_t *f, const uintN_t *a, const uintN_t *b,
+		uintN_t *c);
+
+/**
+ * gf2m product c = a b mod f of reduced a and b.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_gf2m_mul (const uintN_gf2m_t *f, const uintN_t *a, const uintN_t *b,
+		uintN_t *c, uintN_ws_t *ws);
+
+/**
+ * gf2m square c = a^2 mod f of a reduced a.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintN_gf2m_sqr (const uintN_gf2m_t *f, const uintN_t *a, uintN_t *c,
+		uintN_ws_t *ws);
+
+/**
+ * gf2m inverse c = a^-1 mod f of a reduced a.
+ * returns false if a is zero.
+ * the implementation use Itoh and Tsujii's a^(2^m - 2), the same squarings
+ * and multiplications for every a.
+ *
+ * The running time of implemented algorithm is O(m n + n^2 log m).
+ */
+bool
+uintN_gf2m_inv (const uintN_gf2m_t *f, const uintN_t *a, uintN_t *c,
+		uintN_ws_t *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GF2M_H_ */
@@ -0,0 +1,466 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+
+#include "jobpool.h"
+#include "montgomery.h"
+#include "modcache.h"
+#include "workspace.h"
+
+/* the worker running on this thread, for submissions from callbacks */
+static __thread uintN_worker_t *current;
+
+static void
+job_init (uintN_job_t *job, uint8_t op)
+{
+  assert(job != NULL);
+
+  memset (job, 0, sizeof(*job));
+  job->op = op;
+}
+
+void
+uintN_job_modp (uintN_job_t *job, const uintN_t *base, const uintN_t *exp,
+		const uintN_t *mod)
+{
+  assert(base != NULL);
+  assert(exp != NULL);
+  assert(mod != NULL);
+
+  job_init (job, UINTN_JOB_MODP);
+  job->a = base;
+  job->b = exp;
+  job->m = mod;
+}
+
+void
+uintN_job_fb_modp (uintN_job_t *job, const uintN_fb_t *fb,
+		   const uintN_t *exp)
+{
+  assert(fb != NULL);
+  assert(exp != NULL);
+
+  job_init (job, UINTN_JOB_FB_MODP);
+  job->a = exp;
+  job->key = fb;
+}
+
+void
+uintN_job_rsa_public (uintN_job_t *job, const rsa_pub_t *pub,
+		      const uintN_t *m)
+{
+  assert(pub != NULL);
+  assert(m != NULL);
+
+  job_init (job, UINTN_JOB_RSA_PUBLIC);
+  job->a = m;
+  job->key = pub;
+}
+
+void
+uintN_job_rsa_verify (uintN_job_t *job, const rsa_pub_t *pub,
+		      const uintN_t *sig, const uintN_t *em)
+{
+  assert(pub != NULL);
+  assert(sig != NULL);
+  assert(em != NULL);
+
+  job_init (job, UINTN_JOB_RSA_VERIFY);
+  job->a = sig;
+  job->b = em;
+  job->key = pub;
+}
+
+bool
+uintN_job_done (const uintN_job_t *job)
+{
+  assert(job != NULL);
+
+  return __atomic_load_n (&job->done, __ATOMIC_ACQUIRE) != 0;
+}
+
+/*
+ * the job is finished, hand it back through its callback or the done queue.
+ */
+static void
+complete (uintN_pool_t *pool, uintN_job_t *job)
+{
+  uint64_t one = 1;
+  ssize_t ret;
+  uintN_job_cb cb = job->cb;
+  void *arg = job->arg;
+
+  if (cb != NULL)
+    {
+      // a poller may free or reuse the job once it sees done, so the
+      // callback and its argument are read before
+      __atomic_store_n (&job->done, 1, __ATOMIC_RELEASE);
+      cb (job, arg);
+    }
+  else
+    {
+      job->next = NULL;
+      pthread_mutex_lock (&pool->lock);
+      if (pool->done_tail != NULL)
+	pool->done_tail->next = job;
+      else
+	pool->done_head = job;
+      pool->done_tail = job;
+      __atomic_store_n (&job->done, 1, __ATOMIC_RELEASE);
+      pthread_mutex_unlock (&pool->lock);
+
+      ret = write (pool->fd, &one, sizeof(one));
+      (void) ret;
+    }
+
+  if (__atomic_sub_fetch (&pool->pending, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+      pthread_mutex_lock (&pool->lock);
+      pthread_cond_broadcast (&pool->idle);
+      pthread_mutex_unlock (&pool->lock);
+    }
+}
+
+/*
+ * run a list of jobs, consecutive modp jobs under the same odd modulus
+ * share the Montgomery context.
+ */
+static void
+run (uintN_pool_t *pool, uintN_job_t *job)
+{
+  uintN_ws_t *ws = uintN_ws_thread ();
+  uintN_job_t *next;
+  uintN_mont_t ctx;
+  bool shared = false;
+
+  for (; job != NULL; job = next)
+    {
+      next = job->next;
+
+      switch (job->op)
+	{
+	case UINTN_JOB_MODP:
+	  if (shared && uintN_isequal (&ctx.m, job->m))
+	    uintN_mont_modp (&ctx, job->a, job->b, &job->result, ws);
+	  else if (next != NULL && next->op == UINTN_JOB_MODP
+	      && uintN_isequal (next->m, job->m)
+	      && uintN_modcache_mont (job->m, &ctx))
+	    {
+	      shared = true;
+	      uintN_mont_modp (&ctx, job->a, job->b, &job->result, ws);
+	    }
+	  else
+	    uintN_modp_ws (job->a, job->b, job->m, &job->result, ws);
+	  job->ok = true;
+	  break;
+	case UINTN_JOB_FB_MODP:
+	  uintN_fb_modp (job->key, job->a, &job->result, ws);
+	  job->ok = true;
+	  break;
+	case UINTN_JOB_RSA_PUBLIC:
+	  job->ok = rsa_public (job->key, job->a, &job->result, ws);
+	  break;
+	case UINTN_JOB_RSA_VERIFY:
+	  job->ok = rsa_verify (job->key, job->a, job->b, ws);
+	  break;
+	default:
+	  assert(0);
+	}
+
+      complete (pool, job);
+    }
+}
+
+/*
+ * take up to max jobs from the head of the queue of w.
+ */
+static uintN_job_t *
+take (uintN_worker_t *w, size_t max)
+{
+  uintN_job_t *head, *job;
+  size_t k;
+
+  pthread_mutex_lock (&w->lock);
+  head = w->head;
+  for (k = 0, job = NULL; k < max && w->head != NULL; k++)
+    {
+      job = w->head;
+      w->head = job->next;
+    }
+  if (job != NULL)
+    job->next = NULL;
+  if (w->head == NULL)
+    w->tail = NULL;
+  __atomic_store_n (&w->len, w->len - k, __ATOMIC_RELAXED);
+  pthread_mutex_unlock (&w->lock);
+
+  __atomic_sub_fetch (&w->pool->queued, k, __ATOMIC_ACQ_REL);
+  return k > 0 ? head : NULL;
+}
+
+/*
+ * take half of the queue, at most a batch, from the tail of another worker.
+ */
+static uintN_job_t *
+steal (uintN_worker_t *w)
+{
+  uintN_pool_t *pool = w->pool;
+  uintN_worker_t *v;
+  uintN_job_t *job, *stolen;
+  unsigned int i;
+  size_t k, j;
+
+  for (i = 1; i < pool->threads; i++)
+    {
+      v = &pool->workers[(w->id + i) % pool->threads];
+      if (__atomic_load_n (&v->len, __ATOMIC_RELAXED) == 0)
+	continue;
+
+      pthread_mutex_lock (&v->lock);
+      k = min((v->len + 1) / 2, UINTN_POOL_BATCH);
+      if (k == 0)
+	{
+	  pthread_mutex_unlock (&v->lock);
+	  continue;
+	}
+
+      if (k == v->len)
+	{
+	  stolen = v->head;
+	  v->head = v->tail = NULL;
+	}
+      else
+	{
+	  // the owner keeps the first len - k jobs
+	  for (j = 1, job = v->head; j < v->len - k; j++)
+	    job = job->next;
+	  stolen = job->next;
+	  job->next = NULL;
+	  v->tail = job;
+	}
+      __atomic_store_n (&v->len, v->len - k, __ATOMIC_RELAXED);
+      pthread_mutex_unlock (&v->lock);
+
+      __atomic_sub_fetch (&pool->queued, k, __ATOMIC_ACQ_REL);
+      return stolen;
+    }
+  return NULL;
+}
+
+static void *
+worker_main (void *arg)
+{
+  uintN_worker_t *w = arg;
+  uintN_pool_t *pool = w->pool;
+  uintN_job_t *jobs;
+  bool stop;
+
+  current = w;
+
+  for (;;)
+    {
+      jobs = take (w, UINTN_POOL_BATCH);
+      if (jobs == NULL)
+	jobs = steal (w);
+      if (jobs != NULL)
+	{
+	  run (pool, jobs);
+	  continue;
+	}
+
+      pthread_mutex_lock (&pool->lock);
+      while (__atomic_load_n (&pool->queued, __ATOMIC_ACQUIRE) == 0
+	  && !pool->stop)
+	pthread_cond_wait (&pool->wake, &pool->lock);
+      stop = pool->stop
+	  && __atomic_load_n (&pool->queued, __ATOMIC_ACQUIRE) == 0;
+      pthread_mutex_unlock (&pool->lock);
+
+      if (stop)
+	break;
+    }
+
+  current = NULL;
+  return NULL;
+}
+
+static void
+stop_workers (uintN_pool_t *pool, unsigned int started)
+{
+  unsigned int i;
+
+  pthread_mutex_lock (&pool->lock);
+  pool->stop = true;
+  pthread_cond_broadcast (&pool->wake);
+  pthread_mutex_unlock (&pool->lock);
+
+  for (i = 0; i < started; i++)
+    pthread_join (pool->workers[i].thread, NULL);
+  for (i = 0; i < pool->threads; i++)
+    pthread_mutex_destroy (&pool->workers[i].lock);
+}
+
+bool
+uintN_pool_init (uintN_pool_t *pool, unsigned int threads)
+{
+  assert(pool != NULL);
+
+  unsigned int i;
+  long cpus;
+
+  memset (pool, 0, sizeof(*pool));
+
+  if (threads == 0)
+    {
+      cpus = sysconf (_SC_NPROCESSORS_ONLN);
+      threads = cpus > 0 ? (unsigned int) cpus : 1;
+    }
+  threads = min(threads, UINTN_POOL_MAX_THREADS);
+
+  pool->fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (pool->fd < 0)
+    return false;
+
+  pool->workers = calloc (threads, sizeof(uintN_worker_t));
+  if (pool->workers == NULL)
+    {
+      close (pool->fd);
+      return false;
+    }
+
+  pool->threads = threads;
+  pthread_mutex_init (&pool->lock, NULL);
+  pthread_cond_init (&pool->wake, NULL);
+  pthread_cond_init (&pool->idle, NULL);
+
+  for (i = 0; i < threads; i++)
+    {
+      pthread_mutex_init (&pool->workers[i].lock, NULL);
+      pool->workers[i].pool = pool;
+      pool->workers[i].id = i;
+    }
+
+  for (i = 0; i < threads; i++)
+    if (pthread_create (&pool->workers[i].thread, NULL, worker_main,
+			&pool->workers[i]) != 0)
+      {
+	stop_workers (pool, i);
+	uintN_pool_free (pool);
+	return false;
+      }
+
+  return true;
+}
+
+void
+uintN_pool_free (uintN_pool_t *pool)
+{
+  assert(pool != NULL);
+
+  if (pool->workers == NULL)
+    return;
+
+  if (!pool->stop)
+    {
+      uintN_pool_drain (pool);
+      stop_workers (pool, pool->threads);
+    }
+
+  pthread_cond_destroy (&pool->idle);
+  pthread_cond_destroy (&pool->wake);
+  pthread_mutex_destroy (&pool->lock);
+  close (pool->fd);
+  free (pool->workers);
+  memset (pool, 0, sizeof(*pool));
+}
+
+void
+uintN_pool_submit (uintN_pool_t *pool, uintN_job_t *job, uintN_job_cb cb,
+		   void *arg)
+{
+  assert(pool != NULL);
+  assert(job != NULL);
+  assert(!pool->stop);
+
+  uintN_worker_t *w;
+
+  job->cb = cb;
+  job->arg = arg;
+  job->done = 0;
+  job->next = NULL;
+  __atomic_add_fetch (&pool->pending, 1, __ATOMIC_ACQ_REL);
+
+  // jobs submitted from a callback stay on the worker's own queue
+  if (current != NULL && current->pool == pool)
+    w = current;
+  else
+    w = &pool->workers[__atomic_fetch_add (&pool->next, 1, __ATOMIC_RELAXED)
+	% pool->threads];
+
+  pthread_mutex_lock (&w->lock);
+  if (w->tail != NULL)
+    w->tail->next = job;
+  else
+    w->head = job;
+  w->tail = job;
+  __atomic_store_n (&w->len, w->len + 1, __ATOMIC_RELAXED);
+  pthread_mutex_unlock (&w->lock);
+
+  __atomic_add_fetch (&pool->queued, 1, __ATOMIC_ACQ_REL);
+
+  pthread_mutex_lock (&pool->lock);
+  pthread_cond_signal (&pool->wake);
+  pthread_mutex_unlock (&pool->lock);
+}
+
+int
+uintN_pool_fd (const uintN_pool_t *pool)
+{
+  assert(pool != NULL);
+
+  return pool->fd;
+}
+
+size_t
+uintN_pool_reap (uintN_pool_t *pool, uintN_job_t **jobs, size_t max)
+{
+  assert(pool != NULL);
+  assert(jobs != NULL || max == 0);
+
+  size_t k;
+  uint64_t count;
+  ssize_t ret;
+
+  pthread_mutex_lock (&pool->lock);
+  for (k = 0; k < max && pool->done_head != NULL; k++)
+    {
+      jobs[k] = pool->done_head;
+      pool->done_head = jobs[k]->next;
+      jobs[k]->next = NULL;
+    }
+  if (pool->done_head == NULL)
+    {
+      pool->done_tail = NULL;
+
+      // nothing left, reset the eventfd counter
+      ret = read (pool->fd, &count, sizeof(count));
+      (void) ret;
+    }
+  pthread_mutex_unlock (&pool->lock);
+
+  return k;
+}
+
+void
+uintN_pool_drain (uintN_pool_t *pool)
+{
+  assert(pool != NULL);
+
+  pthread_mutex_lock (&pool->lock);
+  while (__atomic_load_n (&pool->pending, __ATOMIC_ACQUIRE) != 0)
+    pthread_cond_wait (&pool->idle, &pool->lock);
+  pthread_mutex_unlock (&pool->lock);
+}
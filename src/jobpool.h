@@ -0,0 +1,187 @@
+/*
+ * jobpool.h
+ *
+ * Header file for asynchronous modular exponentiation on a pool of worker
+ * threads.
+ *
+ * A job describes one exponentiation: a generic uintN_modp, a fixed-base
+ * uintN_fb_modp (e.g. a DH key share) or an RSA public operation. Jobs are
+ * submitted without blocking and completed on a worker thread:
+ *
+ *   callback  if the job has one, it is called on the worker thread and the
+ *             job belongs to the caller again from that point on.
+ *   reap      otherwise the job is queued on the pool and the pool's fd
+ *             (an eventfd) becomes readable, the event loop calls
+ *             uintN_pool_reap to collect the finished jobs.
+ *
+ * In both cases uintN_job_done can be polled on the job itself.
+ *
+ * Every worker owns a queue, submissions are spread over the queues and an
+ * idle worker steals half of the queue of a busy one. A worker takes up to
+ * UINTN_POOL_BATCH jobs at a time and consecutive exponentiations under the
+ * same odd modulus share one Montgomery context.
+ *
+ * The operands are referenced, not copied, and must stay valid until the job
+ * is complete.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef JOBPOOL_H_
+#define JOBPOOL_H_
+
+#include <stddef.h>
+#include <pthread.h>
+
+#include "uintN.h"
+#include "fixedbase.h"
+#include "rsa.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+#define UINTN_JOB_MODP 1
+#define UINTN_JOB_FB_MODP 2
+#define UINTN_JOB_RSA_PUBLIC 3
+#define UINTN_JOB_RSA_VERIFY 4
+
+/* jobs taken from a queue at a time */
+#define UINTN_POOL_BATCH 8
+
+/* upper bound on the number of worker threads */
+#define UINTN_POOL_MAX_THREADS 256
+
+typedef struct uintN_job uintN_job_t;
+
+typedef void
+(*uintN_job_cb) (uintN_job_t *job, void *arg);
+
+struct uintN_job
+{
+  uint8_t op;
+  const uintN_t *a;
+  const uintN_t *b;
+  const uintN_t *m;
+  const void *key;
+  uintN_t result;
+  bool ok;
+  uintN_job_cb cb;
+  void *arg;
+  int done;
+  uintN_job_t *next;
+};
+
+typedef struct uintN_pool uintN_pool_t;
+
+typedef struct
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  uintN_job_t *head;
+  uintN_job_t *tail;
+  size_t len;
+  uintN_pool_t *pool;
+  unsigned int id;
+} uintN_worker_t;
+
+struct uintN_pool
+{
+  uintN_worker_t *workers;
+  unsigned int threads;
+  unsigned int next;
+  size_t queued;
+  size_t pending;
+  bool stop;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t idle;
+  uintN_job_t *done_head;
+  uintN_job_t *done_tail;
+  int fd;
+};
+
+/**
+ * job set up c ≡ base ^ exp (mod mod), as uintN_modp.
+ */
+void
+uintN_job_modp (uintN_job_t *job, const uintN_t *base, const uintN_t *exp,
+		const uintN_t *mod);
+
+/**
+ * job set up c ≡ g ^ exp (mod p) with a fixed-base table, as uintN_fb_modp.
+ */
+void
+uintN_job_fb_modp (uintN_job_t *job, const uintN_fb_t *fb,
+		   const uintN_t *exp);
+
+/**
+ * job set up the RSA public operation, as rsa_public.
+ */
+void
+uintN_job_rsa_public (uintN_job_t *job, const rsa_pub_t *pub,
+		      const uintN_t *m);
+
+/**
+ * job set up an RSA signature verification, as rsa_verify.
+ * the result is only in job->ok.
+ */
+void
+uintN_job_rsa_verify (uintN_job_t *job, const rsa_pub_t *pub,
+		      const uintN_t *sig, const uintN_t *em);
+
+/**
+ * job completion check, safe to poll from any thread.
+ */
+bool
+uintN_job_done (const uintN_job_t *job);
+
+/**
+ * pool init with the given number of worker threads, 0 for one per online
+ * processor.
+ * returns false if the threads or the eventfd could not be created.
+ */
+bool
+uintN_pool_init (uintN_pool_t *pool, unsigned int threads);
+
+/**
+ * pool finish all submitted jobs, stop the workers and free the pool.
+ * jobs left to reap are dropped.
+ */
+void
+uintN_pool_free (uintN_pool_t *pool);
+
+/**
+ * pool submit a job, cb (may be NULL) is called on completion.
+ * never blocks on the computation.
+ */
+void
+uintN_pool_submit (uintN_pool_t *pool, uintN_job_t *job, uintN_job_cb cb,
+		   void *arg);
+
+/**
+ * pool file descriptor readable while completed jobs without a callback
+ * wait to be reaped.
+ */
+int
+uintN_pool_fd (const uintN_pool_t *pool);
+
+/**
+ * pool collect up to max completed jobs without a callback.
+ * returns the number of jobs stored in jobs, never blocks.
+ */
+size_t
+uintN_pool_reap (uintN_pool_t *pool, uintN_job_t **jobs, size_t max);
+
+/**
+ * pool wait until every submitted job is complete.
+ */
+void
+uintN_pool_drain (uintN_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JOBPOOL_H_ */
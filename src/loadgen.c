@@ -0,0 +1,613 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "loadgen.h"
+#include "rsa.h"
+#include "fixedbase.h"
+#include "montgomery.h"
+#include "random.h"
+#include "workspace.h"
+
+/* operands prepared per thread and cycled through, drawn outside the clock */
+#define INPUTS 16
+
+/* DH exponents, twice the 112-bit security of the 2048-bit group */
+#define DH_EXP_BITS 256
+
+static const char *const names[LOADGEN_OPS] =
+  { "sign", "verify", "dh" };
+
+/*
+ * 2048-bit test key, e = 65537, and a 2048-bit prime for DH with g = 2.
+ * Random primes so that no special-form reduction kicks in.
+ */
+static const uintN_t rsa_n =
+  {
+    { 0x1aee7721c46c9cc9, 0xcf6420c5d1a19f2a, 0xab14fe12feefbd2c,
+	0xac892a9d85ba04a9, 0x70d7d628b79a1408, 0xaacc1916ae66a946,
+	0xdad5762e9086432e, 0x12b95ab142c704eb, 0xca960b13cdbd3798,
+	0x2b47836a8b0a66b7, 0x1e4da3897b0b7842, 0xb495d33ab4687368,
+	0xe9a81d250c596a7e, 0x8c67c6c8e176a4cb, 0x1b743df450cd577a,
+	0x65dec5d4f7e064db, 0x8722bd8180b2b37f, 0x5035c42f57e02648,
+	0xd3e96277a6e0a934, 0x6e350af5f3c2a85f, 0x6232015729c00712,
+	0x6852b663edf89124, 0x26c1d939c0a6c87d, 0x3f6b8df94cb1da24,
+	0x79ae463291939cc3, 0x0dca13bb2d26967f, 0x6692a4d056bcddf9,
+	0xd3ba4c49096e30be, 0x15aa246bd58444be, 0x0b31bca2f2397909,
+	0x050f7e05af31f8f2, 0xd6f61579064cab5f } };
+
+static const uintN_t rsa_d =
+  {
+    { 0x3cafe569fa0c08c1, 0x4cbebfae17fb04f9, 0x9e3d79110645a736,
+	0x31dbd46432276498, 0x75e02bb704b7edeb, 0xdc18377713d3cd4a,
+	0xe24c6b360236ce45, 0x92c360d55fe7f896, 0x57f3d5595138e966,
+	0xe9b039ecb3df75eb, 0x55c37659479b6e1b, 0xb7b8f8292426d738,
+	0xf7e2ae6863b640c7, 0x934abf2fea3b292a, 0x6af51b95c37a7e18,
+	0xfbd23fe07fcb09dc, 0x85ab665c1b0992fc, 0xdfbec18be82dcb30,
+	0x3f805564468b777f, 0x23e1bdac1f7d11bb, 0x0e0bc4d36b454330,
+	0x517e015b9268b4d4, 0x722b97c72926d4f3, 0xafa2afb6505f5d66,
+	0x52459dcb19e1e835, 0x604ba585a15a1e24, 0x9eee10f740f834d2,
+	0xfe0ede355dcc0461, 0x12570dd3c6653066, 0xbf8c6f95122f12de,
+	0x5f813d1520900f69, 0x0a23de9c70672278 } };
+
+static const uintN_t dh_p =
+  {
+    { 0x8b013f16da4a4ac7, 0xef5d248af59b05be, 0xe67b8f5641f4f510,
+	0xe4c2971ffc2627af, 0x7f12da6862de9643, 0x90d497b431e17bdc,
+	0x3d3ea0fc657f8f7f, 0x05aa256c5f09a423, 0x80af381755c02ed1,
+	0xa8e40b1f6bde2720, 0x252983f18abe24e0, 0x4986d09f93f216f1,
+	0x1d87eb707b8dd550, 0x5d09a0b11d26ef7f, 0xdf8d8504bfdac4e3,
+	0x02d13361cf5ca1a2, 0x57c846aa5b119d1e, 0x953e6fd3357589f7,
+	0xa9a328ac231d9424, 0x2c8210aa867d9234, 0x866e216416936303,
+	0x0d3cf28f29574d71, 0x77ba2634a798ba71, 0x5186e14a7683f1d3,
+	0x84caed603bb9489a, 0x9c63af8c9ead7527, 0x5bd3d11f710836b7,
+	0xbd9885850dbcef8c, 0xa2e38c4f5ba32fba, 0xf4e9612a2c5b4991,
+	0xda5cccae2bb72ea5, 0xdf6db2b616f0ae77 } };
+
+typedef struct
+{
+  rsa_pub_t pub;
+  rsa_blind_t blind;
+  uintN_t em;
+  uintN_t sig;
+  uintN_fb_t fb;
+  uintN_t peer;
+} keys_t;
+
+/* holds the workers back until all of them are started */
+typedef struct
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  unsigned int threads;
+  bool go;
+} gate_t;
+
+typedef struct
+{
+  const loadgen_conf_t *conf;
+  keys_t *keys;
+  gate_t *gate;
+  unsigned int index;
+  loadgen_result_t res;
+} worker_t;
+
+static uint64_t
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void
+sleep_until (uint64_t t)
+{
+  struct timespec ts;
+
+  ts.tv_sec = t / 1000000000ull;
+  ts.tv_nsec = t % 1000000000ull;
+  while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    ;
+}
+
+static unsigned int
+bucket (uint64_t ns)
+{
+  unsigned int e;
+
+  if (ns < 64)
+    return ns;
+  e = PART_SIZE_BITS - 1 - __builtin_clzll (ns);
+  if (e >= 40)
+    return LOADGEN_BUCKETS - 1;
+  return 64 + ((e - 6) << LOADGEN_SUB_BITS)
+      + ((ns >> (e - LOADGEN_SUB_BITS)) & ((1u << LOADGEN_SUB_BITS) - 1));
+}
+
+/*
+ * middle of the latencies falling into bucket b.
+ */
+static uint64_t
+bucket_ns (unsigned int b)
+{
+  unsigned int e, sub;
+
+  if (b < 64)
+    return b;
+  e = (b - 64) / (1u << LOADGEN_SUB_BITS) + 6;
+  sub = (b - 64) % (1u << LOADGEN_SUB_BITS);
+  return ((uint64_t) ((1u << LOADGEN_SUB_BITS) + sub) << (e - LOADGEN_SUB_BITS))
+      + (1ull << (e - LOADGEN_SUB_BITS)) / 2;
+}
+
+static bool
+keys_init (keys_t *keys)
+{
+  uintN_ws_t *ws = uintN_ws_thread ();
+  uintN_t g, y;
+
+  memset (keys, 0, sizeof(*keys));
+
+  if (!rsa_pub_init (&keys->pub, &rsa_n, RSA_F4)
+      || !rsa_blind_init (&keys->blind, &keys->pub, 0))
+    return false;
+
+  // a valid signature to verify, which also checks the key
+  uintN_random_below (&keys->em, &rsa_n);
+  if (!rsa_private (&keys->pub, &rsa_d, &keys->blind, &keys->em, &keys->sig,
+		    ws)
+      || !rsa_verify (&keys->pub, &keys->sig, &keys->em, ws))
+    {
+      rsa_blind_free (&keys->blind);
+      return false;
+    }
+
+  uintN_zeroize (&g);
+  g.parts[0] = 2;
+  if (!uintN_fb_init (&keys->fb, &g, &dh_p, DH_EXP_BITS, UINTN_FB_TEETH,
+		      UINTN_FB_BLOCKS))
+    {
+      rsa_blind_free (&keys->blind);
+      return false;
+    }
+
+  uintN_random_bits (&y, DH_EXP_BITS);
+  uintN_fb_modp (&keys->fb, &y, &keys->peer, ws);
+  uintN_zeroize (&y);
+  return true;
+}
+
+static void
+keys_free (keys_t *keys)
+{
+  uintN_fb_free (&keys->fb);
+  rsa_blind_free (&keys->blind);
+  uintN_wipe (keys, sizeof(*keys));
+}
+
+/*
+ * one operation of the mix on the operands in and exp, returns false if it
+ * failed.
+ */
+static bool
+run_op (keys_t *keys, unsigned int op, const uintN_t *in, const uintN_t *exp,
+	uintN_ws_t *ws)
+{
+  uintN_t out, share;
+
+  switch (op)
+    {
+    case LOADGEN_SIGN:
+      return rsa_private (&keys->pub, &rsa_d, &keys->blind, in, &out, ws);
+    case LOADGEN_VERIFY:
+      return rsa_verify (&keys->pub, &keys->sig, &keys->em, ws);
+    case LOADGEN_DH:
+      uintN_fb_modp (&keys->fb, exp, &share, ws);
+      uintN_mont_modp_ct (&keys->fb.mont, &keys->peer, exp, DH_EXP_BITS,
+			  &out, ws);
+      return true;
+    }
+  return false;
+}
+
+static void *
+worker (void *arg)
+{
+  worker_t *w = arg;
+  const loadgen_conf_t *conf = w->conf;
+  uintN_ws_t *ws = uintN_ws_thread ();
+  uintN_t in[INPUTS], exp[INPUTS];
+  uint64_t begin, deadline, interval, next, start, end, x;
+  unsigned int i, op, total, r, threads;
+  size_t k;
+
+  for (k = 0; k < INPUTS; k++)
+    {
+      uintN_random_below (&in[k], &rsa_n);
+      uintN_random_bits (&exp[k], DH_EXP_BITS);
+    }
+  uintN_rng_bytes (uintN_rng_thread (), &x, sizeof(x));
+  x |= 1;
+
+  for (i = 0, total = 0; i < LOADGEN_OPS; i++)
+    total += conf->weight[i];
+
+  pthread_mutex_lock (&w->gate->lock);
+  while (!w->gate->go)
+    pthread_cond_wait (&w->gate->cond, &w->gate->lock);
+  threads = w->gate->threads;
+  pthread_mutex_unlock (&w->gate->lock);
+
+  // the threads share the rate and start staggered over one interval
+  interval = conf->rate > 0 ? threads * 1e9 / conf->rate : 0;
+
+  begin = now_ns ();
+  deadline = begin + (uint64_t) (conf->seconds * 1e9);
+  next = begin + interval * w->index / threads;
+
+  for (k = 0;; k++)
+    {
+      if (interval != 0)
+	{
+	  if (next >= deadline)
+	    break;
+	  sleep_until (next);
+	  start = next;
+	  next += interval;
+	}
+      else
+	{
+	  start = now_ns ();
+	  if (start >= deadline)
+	    break;
+	}
+
+      // xorshift picks the operation
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      r = x % total;
+      for (op = 0; r >= conf->weight[op]; op++)
+	r -= conf->weight[op];
+
+      if (!run_op (w->keys, op, &in[k % INPUTS], &exp[k % INPUTS], ws))
+	w->res.failed++;
+      end = now_ns ();
+
+      w->res.hist[op][bucket (end - start)]++;
+      w->res.count[op]++;
+    }
+
+  w->res.seconds = (now_ns () - begin) / 1e9;
+  uintN_wipe (exp, sizeof(exp));
+  return NULL;
+}
+
+void
+loadgen_conf_init (loadgen_conf_t *conf)
+{
+  assert(conf != NULL);
+
+  memset (conf, 0, sizeof(*conf));
+  conf->seconds = 5;
+  conf->weight[LOADGEN_SIGN] = 1;
+  conf->weight[LOADGEN_VERIFY] = 4;
+  conf->weight[LOADGEN_DH] = 2;
+}
+
+static unsigned int
+online_threads (unsigned int threads)
+{
+  long cpus;
+
+  if (threads == 0)
+    {
+      cpus = sysconf (_SC_NPROCESSORS_ONLN);
+      threads = cpus > 0 ? cpus : 1;
+    }
+  return min(threads, LOADGEN_MAX_THREADS);
+}
+
+bool
+loadgen_run (const loadgen_conf_t *conf, loadgen_result_t *res)
+{
+  assert(conf != NULL);
+  assert(res != NULL);
+  assert(conf->seconds > 0);
+  assert(conf->weight[0] + conf->weight[1] + conf->weight[2] > 0);
+
+  pthread_t tid[LOADGEN_MAX_THREADS];
+  gate_t gate =
+    { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, false };
+  unsigned int threads, i, op, b;
+  worker_t *w;
+  keys_t keys;
+
+  memset (res, 0, sizeof(*res));
+  threads = online_threads (conf->threads);
+
+  w = calloc (threads, sizeof(worker_t));
+  if (w == NULL)
+    return false;
+  if (!keys_init (&keys))
+    {
+      free (w);
+      return false;
+    }
+
+  // a thread that fails to start only leaves the load to the others
+  for (i = 0; i < threads; i++)
+    {
+      w[i].conf = conf;
+      w[i].keys = &keys;
+      w[i].gate = &gate;
+      w[i].index = i;
+      if (pthread_create (&tid[i], NULL, worker, &w[i]) != 0)
+	break;
+    }
+
+  pthread_mutex_lock (&gate.lock);
+  gate.threads = i;
+  gate.go = true;
+  pthread_cond_broadcast (&gate.cond);
+  pthread_mutex_unlock (&gate.lock);
+
+  for (i = 0; i < gate.threads; i++)
+    {
+      pthread_join (tid[i], NULL);
+      for (op = 0; op < LOADGEN_OPS; op++)
+	{
+	  for (b = 0; b < LOADGEN_BUCKETS; b++)
+	    res->hist[op][b] += w[i].res.hist[op][b];
+	  res->count[op] += w[i].res.count[op];
+	}
+      res->failed += w[i].res.failed;
+      res->seconds = max(res->seconds, w[i].res.seconds);
+    }
+  res->threads = gate.threads;
+
+  keys_free (&keys);
+  free (w);
+  return res->threads > 0;
+}
+
+uint64_t
+loadgen_percentile (const loadgen_result_t *res, unsigned int op, double q)
+{
+  assert(res != NULL);
+  assert(op <= LOADGEN_OPS);
+  assert(q >= 0 && q <= 1);
+
+  uint64_t total, seen, target, n;
+  unsigned int b, i;
+
+  for (i = 0, total = 0; i < LOADGEN_OPS; i++)
+    if (op == LOADGEN_OPS || op == i)
+      total += res->count[i];
+  if (total == 0)
+    return 0;
+
+  // rank of the sample, at least the first one
+  target = (uint64_t) (q * total + 0.999999);
+  target = max(target, 1);
+
+  for (b = 0, seen = 0; b < LOADGEN_BUCKETS; b++)
+    {
+      for (i = 0, n = 0; i < LOADGEN_OPS; i++)
+	if (op == LOADGEN_OPS || op == i)
+	  n += res->hist[i][b];
+      seen += n;
+      if (seen >= target)
+	return bucket_ns (b);
+    }
+  return bucket_ns (LOADGEN_BUCKETS - 1);
+}
+
+static double
+throughput (const loadgen_result_t *res)
+{
+  uint64_t total = 0;
+  unsigned int op;
+
+  for (op = 0; op < LOADGEN_OPS; op++)
+    total += res->count[op];
+  return res->seconds > 0 ? total / res->seconds : 0;
+}
+
+static void
+report (FILE *out, const loadgen_result_t *res)
+{
+  unsigned int op;
+  uint64_t count;
+
+  fprintf (out, "%-8s %10s %10s %10s %10s %10s\n", "op", "count", "ops/s",
+	   "p50 us", "p99 us", "p999 us");
+  for (op = 0; op <= LOADGEN_OPS; op++)
+    {
+      count = op < LOADGEN_OPS ?
+	  res->count[op] :
+	  res->count[LOADGEN_SIGN] + res->count[LOADGEN_VERIFY]
+	      + res->count[LOADGEN_DH];
+      if (count == 0)
+	continue;
+      fprintf (out, "%-8s %10" PRIu64 " %10.1f %10.1f %10.1f %10.1f\n",
+	       op < LOADGEN_OPS ? names[op] : "all", count,
+	       count / res->seconds, loadgen_percentile (res, op, 0.5) / 1e3,
+	       loadgen_percentile (res, op, 0.99) / 1e3,
+	       loadgen_percentile (res, op, 0.999) / 1e3);
+    }
+  if (res->failed != 0)
+    fprintf (out, "%" PRIu64 " operations failed\n", res->failed);
+}
+
+static void
+usage (FILE *out, const char *name)
+{
+  fprintf (out, "usage: %s [-t threads] [-d seconds] [-r rate] [-m mix] [-s]\n"
+	   "  -t threads  worker threads, default one per processor\n"
+	   "  -d seconds  length of every run, default 5\n"
+	   "  -r rate     operations per second over all threads, default 0\n"
+	   "              to saturate\n"
+	   "  -m mix      weights as sign=1,verify=4,dh=2\n"
+	   "  -s          sweep 1, 2, 4, .. threads for the scaling efficiency\n",
+	   name);
+}
+
+/*
+ * weights of a mix "op=weight,..", ops left out get weight 0.
+ */
+static bool
+parse_mix (const char *s, unsigned int *weight)
+{
+  unsigned int op;
+  size_t len;
+  char *end;
+
+  memset (weight, 0, LOADGEN_OPS * sizeof(*weight));
+  while (*s != '\0')
+    {
+      for (op = 0; op < LOADGEN_OPS; op++)
+	{
+	  len = strlen (names[op]);
+	  if (strncmp (s, names[op], len) == 0 && s[len] == '=')
+	    break;
+	}
+      if (op == LOADGEN_OPS)
+	return false;
+
+      s += len + 1;
+      errno = 0;
+      weight[op] = strtoul (s, &end, 10);
+      if (end == s || errno != 0 || (*end != ',' && *end != '\0'))
+	return false;
+      s = *end == ',' ? end + 1 : end;
+    }
+  return weight[0] + weight[1] + weight[2] > 0;
+}
+
+int
+loadgen_main (int argc, char **argv, FILE *out)
+{
+  assert(argv != NULL);
+  assert(out != NULL);
+
+  loadgen_conf_t conf, run;
+  loadgen_result_t *res, *base;
+  unsigned int threads, op;
+  double x1;
+  char *end;
+  bool ok;
+  int c;
+
+  loadgen_conf_init (&conf);
+
+  optind = 1;
+  while ((c = getopt (argc, argv, "t:d:r:m:sh")) != -1)
+    {
+      switch (c)
+	{
+	case 't':
+	  conf.threads = strtoul (optarg, &end, 10);
+	  break;
+	case 'd':
+	  conf.seconds = strtod (optarg, &end);
+	  break;
+	case 'r':
+	  conf.rate = strtod (optarg, &end);
+	  break;
+	case 'm':
+	  end = parse_mix (optarg, conf.weight) ? "" : optarg;
+	  break;
+	case 's':
+	  conf.sweep = true;
+	  end = "";
+	  break;
+	default:
+	  usage (c == 'h' ? out : stderr, argv[0]);
+	  return c == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+      if (*end != '\0' || conf.seconds <= 0 || conf.rate < 0)
+	{
+	  fprintf (stderr, "%s: bad value for -%c: %s\n", argv[0], c, optarg);
+	  return EXIT_FAILURE;
+	}
+    }
+  if (optind != argc)
+    {
+      usage (stderr, argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  threads = online_threads (conf.threads);
+  res = malloc (sizeof(*res));
+  base = malloc (sizeof(*base));
+  if (res == NULL || base == NULL)
+    {
+      free (res);
+      free (base);
+      fprintf (stderr, "%s: out of memory\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  fprintf (out, "%u threads, %.1f s per run, ", threads, conf.seconds);
+  if (conf.rate > 0)
+    fprintf (out, "%.1f ops/s", conf.rate);
+  else
+    fprintf (out, "saturation");
+  for (op = 0; op < LOADGEN_OPS; op++)
+    fprintf (out, ", %s %u", names[op], conf.weight[op]);
+  fprintf (out, "\n\n");
+
+  // the single thread baseline of the scaling efficiency, meaningless when
+  // the rate is fixed
+  ok = true;
+  x1 = 0;
+  if (conf.rate == 0 && threads > 1)
+    {
+      run = conf;
+      run.threads = 1;
+      ok = loadgen_run (&run, base) && (x1 = throughput (base)) > 0;
+      if (ok)
+	{
+	  fprintf (out, "%-8s %10s %10s\n", "threads", "ops/s", "efficiency");
+	  fprintf (out, "%-8u %10.1f %9.1f%%\n", 1, x1, 100.0);
+	}
+    }
+
+  run = conf;
+  for (run.threads = 2; ok && x1 > 0 && conf.sweep && run.threads < threads;
+      run.threads *= 2)
+    {
+      ok = loadgen_run (&run, base);
+      if (ok)
+	fprintf (out, "%-8u %10.1f %9.1f%%\n", base->threads,
+		 throughput (base),
+		 100 * throughput (base) / (base->threads * x1));
+    }
+
+  run.threads = threads;
+  ok = ok && loadgen_run (&run, res);
+  if (ok)
+    {
+      if (x1 > 0)
+	fprintf (out, "%-8u %10.1f %9.1f%%\n\n", res->threads,
+		 throughput (res),
+		 100 * throughput (res) / (res->threads * x1));
+      report (out, res);
+      ok = res->failed == 0;
+    }
+  else
+    fprintf (stderr, "%s: could not set up the keys or threads\n", argv[0]);
+
+  free (base);
+  free (res);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+/*
+ * loadgen.h
+ *
+ * Header file for the workload driver, a load generator simulating the
+ * public-key side of TLS handshakes.
+ *
+ * Worker threads run a weighted mix of operations against shared keys:
+ *
+ *   sign    RSA private operation with the shared blinding context.
+ *   verify  RSA signature verification with e = 65537.
+ *   dh      DH key agreement, a fixed-base key share and the shared secret
+ *           from the peer's share.
+ *
+ * All keys are 2048 bits. The keys, the blinding context and the fixed-base
+ * table are shared by all threads as a server would share them, so their
+ * locks and cache lines are part of the measurement.
+ *
+ * A run either saturates the threads or paces them to a target rate. Paced
+ * operations are timed from their scheduled start, so a stall shows up in
+ * the latency of every operation queued behind it instead of being hidden.
+ * Latencies go into log-linear histograms of 32 buckets per power of two,
+ * about 3% resolution.
+ *
+ * The report holds throughput and p50/p99/p999 latency per operation, and
+ * the scaling efficiency against one thread, X(N) / (N X(1)) for a
+ * throughput X, either for the configured thread count or for a sweep over
+ * powers of two.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef LOADGEN_H_
+#define LOADGEN_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "uintN.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+#define LOADGEN_SIGN 0
+#define LOADGEN_VERIFY 1
+#define LOADGEN_DH 2
+#define LOADGEN_OPS 3
+
+/* upper bound on the number of threads */
+#define LOADGEN_MAX_THREADS 256
+
+/* histogram buckets: 64 exact ones, then 32 per power of two up to 2^40 ns */
+#define LOADGEN_SUB_BITS 5
+#define LOADGEN_BUCKETS (64 + (40 - 6) * (1 << LOADGEN_SUB_BITS))
+
+typedef struct
+{
+  unsigned int threads; /* 0 for one per online processor */
+  double seconds; /* length of every run */
+  double rate; /* operations per second over all threads, 0 to saturate */
+  unsigned int weight[LOADGEN_OPS]; /* relative frequency of each operation */
+  bool sweep; /* scale from one thread up to threads in powers of two */
+} loadgen_conf_t;
+
+typedef struct
+{
+  uint64_t hist[LOADGEN_OPS][LOADGEN_BUCKETS];
+  uint64_t count[LOADGEN_OPS];
+  uint64_t failed;
+  double seconds;
+  unsigned int threads;
+} loadgen_result_t;
+
+/**
+ * loadgen default configuration: every processor, 5 seconds at saturation,
+ * a mix of 1 sign : 4 verify : 2 dh.
+ */
+void
+loadgen_conf_init (loadgen_conf_t *conf);
+
+/**
+ * loadgen run the mix of conf on conf->threads threads and collect the
+ * latencies in res.
+ * returns false if the keys could not be set up or no thread started.
+ */
+bool
+loadgen_run (const loadgen_conf_t *conf, loadgen_result_t *res);
+
+/**
+ * loadgen latency in ns below which the fraction q of the op operations of
+ * res finished, for op one of LOADGEN_* or LOADGEN_OPS for all of them.
+ */
+uint64_t
+loadgen_percentile (const loadgen_result_t *res, unsigned int op, double q);
+
+/**
+ * loadgen command line driver, runs the workload described by argv and
+ * writes the report to out.
+ * returns the process exit status.
+ */
+int
+loadgen_main (int argc, char **argv, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOADGEN_H_ */
@@ -0,0 +1,750 @@
+#include <assert.h>
+#include <string.h>
+
+#include "modarith.h"
+#include "reducer.h"
+#include "montgomery.h"
+#include "modcache.h"
+#include "uintp.h"
+#include "workspace.h"
+
+#define ACC_PARTS (2 * NUMBER_OF_PARTS + 1)
+
+void
+uintN_modadd (const uintN_t *a, const uintN_t *b, const uintN_t *m,
+	      uintN_t *c)
+{
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(m != NULL);
+  assert(c != NULL);
+
+  uint64_t carry;
+
+  carry = uintp_add_n (c->parts, a->parts, b->parts, NUMBER_OF_PARTS);
+  if (carry || uintp_cmp (c->parts, m->parts, NUMBER_OF_PARTS) >= 0)
+    uintp_sub_n (c->parts, c->parts, m->parts, NUMBER_OF_PARTS);
+}
+
+void
+uintN_modsub (const uintN_t *a, const uintN_t *b, const uintN_t *m,
+	      uintN_t *c)
+{
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(m != NULL);
+  assert(c != NULL);
+
+  if (uintp_sub_n (c->parts, a->parts, b->parts, NUMBER_OF_PARTS))
+    uintp_add_n (c->parts, c->parts, m->parts, NUMBER_OF_PARTS);
+}
+
+void
+uintN_modneg (const uintN_t *a, const uintN_t *m, uintN_t *c)
+{
+  assert(a != NULL);
+  assert(m != NULL);
+  assert(c != NULL);
+
+  if (uintN_iszero (a))
+    uintN_zeroize (c);
+  else
+    uintp_sub_n (c->parts, m->parts, a->parts, NUMBER_OF_PARTS);
+}
+
+/*
+ * r = t (mod m) for a tn-limb t, r receives NUMBER_OF_PARTS limbs.
+ */
+static void
+reduce (const uint64_t *t, size_t tn, const uintN_t *m, uint64_t *r,
+	uintN_ws_t *ws)
+{
+  size_t mn;
+  uintN_reducer_t red;
+
+  mn = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+  tn = uintp_normalize (t, tn);
+  assert(mn > 0);
+
+  // a peek, one-off moduli must not push the long-lived ones out
+  if (tn >= mn && uintN_modcache_reducer_peek (m, &red))
+    {
+      uintN_reducer_reduce (&red, r, t, tn, ws);
+      uintp_zero (r + mn, NUMBER_OF_PARTS - mn);
+      return;
+    }
+
+  if (tn < mn)
+    {
+      uintp_copy (r, t, tn);
+      uintp_zero (r + tn, NUMBER_OF_PARTS - tn);
+      return;
+    }
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, UINTP_DIVREM_SCRATCH(tn, mn));
+  uint64_t *_r = uintN_ws_alloc (ws, mn);
+
+  uintp_divrem (NULL, _r, t, tn, m->parts, mn, tp);
+  uintp_copy (r, _r, mn);
+  uintp_zero (r + mn, NUMBER_OF_PARTS - mn);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_modmul (const uintN_t *a, const uintN_t *b, const uintN_t *m,
+	      uintN_t *c)
+{
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(m != NULL);
+  assert(c != NULL);
+
+  size_t an, bn;
+  uintN_ws_t *ws = uintN_ws_thread ();
+
+  an = uintp_normalize (a->parts, NUMBER_OF_PARTS);
+  bn = uintp_normalize (b->parts, NUMBER_OF_PARTS);
+  if (an == 0 || bn == 0)
+    {
+      uintN_zeroize (c);
+      return;
+    }
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *p = uintN_ws_alloc (ws, an + bn);
+
+  uintp_mul (p, a->parts, an, b->parts, bn);
+  reduce (p, an + bn, m, c->parts, ws);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_modsqr (const uintN_t *a, const uintN_t *m, uintN_t *c)
+{
+  uintN_modmul (a, a, m, c);
+}
+
+void
+uintN_modaddmul (const uintN_t *c, const uintN_t *a, const uintN_t *b,
+		 const uintN_t *m, uintN_t *d)
+{
+  assert(c != NULL);
+  assert(d != NULL);
+
+  uintN_modacc_t acc;
+
+  uintN_modacc_init (&acc, m);
+  uintN_modacc_add (&acc, c);
+  uintN_modacc_addmul (&acc, a, b);
+  uintN_modacc_get (&acc, d);
+  uintN_modacc_zeroize (&acc);
+}
+
+void
+uintN_modsop (const uintN_t *const *a, const uintN_t *const *b, size_t k,
+	      const uintN_t *m, uintN_t *c)
+{
+  assert(a != NULL || k == 0);
+  assert(b != NULL || k == 0);
+  assert(c != NULL);
+
+  size_t i;
+  uintN_modacc_t acc;
+
+  uintN_modacc_init (&acc, m);
+  for (i = 0; i < k; i++)
+    uintN_modacc_addmul (&acc, a[i], b[i]);
+  uintN_modacc_get (&acc, c);
+  uintN_modacc_zeroize (&acc);
+}
+
+typedef __int128 int128_t;
+
+#define M62 (UINT64_MAX >> 2)
+
+/* 2x2 transition matrix of 62 divsteps, scaled by 2^62 */
+typedef struct
+{
+  int64_t u, v, q, r;
+} trans_t;
+
+/*
+ * limbs of the signed 62-bit representation of values below 2^(64 n + 1),
+ * the top limb carries the sign.
+ */
+static size_t
+s62_limbs (size_t n)
+{
+  return (PART_SIZE_BITS * n + 2 + 61) / 62;
+}
+
+/*
+ * x = a in L signed 62-bit limbs for an n-limb a.
+ */
+static void
+to_s62 (int64_t *x, size_t L, const uint64_t *a, size_t n)
+{
+  size_t i, bit, j, s;
+
+  for (i = 0; i < L; i++)
+    {
+      bit = 62 * i;
+      j = bit / PART_SIZE_BITS;
+      s = bit % PART_SIZE_BITS;
+      x[i] = 0;
+      if (j < n)
+	x[i] = a[j] >> s;
+      if (s > 2 && j + 1 < n)
+	x[i] |= a[j + 1] << (PART_SIZE_BITS - s);
+      x[i] &= M62;
+    }
+}
+
+/*
+ * r = x in n limbs for an x of L limbs in [0, 2^62).
+ */
+static void
+from_s62 (uint64_t *r, size_t n, const int64_t *x, size_t L)
+{
+  size_t i, bit, j, s;
+
+  uintp_zero (r, n);
+  for (i = 0; i < L; i++)
+    {
+      bit = 62 * i;
+      j = bit / PART_SIZE_BITS;
+      s = bit % PART_SIZE_BITS;
+      if (j < n)
+	r[j] |= (uint64_t) x[i] << s;
+      if (s > 2 && j + 1 < n)
+	r[j + 1] |= (uint64_t) x[i] >> (PART_SIZE_BITS - s);
+    }
+}
+
+/*
+ * 62 divsteps on the low limbs of f and g, delta is updated and the
+ * transition matrix returned in t. The branches of the divstep are replaced
+ * by masks.
+ */
+static int64_t
+divsteps_62 (int64_t delta, uint64_t f, uint64_t g, trans_t *t)
+{
+  uint64_t u = 1, v = 0, q = 0, r = 1;
+  uint64_t c1, c2, x, y, z;
+  int i;
+
+  for (i = 0; i < 62; i++)
+    {
+      // c1 is all ones if delta > 0, c2 if g is odd
+      c1 = (uint64_t) (-delta >> 63);
+      c2 = -(g & 0x01);
+
+      // g += ±f when g is odd, negated on a swap
+      x = (f ^ c1) - c1;
+      y = (u ^ c1) - c1;
+      z = (v ^ c1) - c1;
+      g += x & c2;
+      q += y & c2;
+      r += z & c2;
+
+      // swap: f = g, delta = 1 - delta, else delta = 1 + delta
+      c1 &= c2;
+      delta = (int64_t) (((uint64_t) delta ^ c1) - c1) + 1;
+      f += g & c1;
+      u += q & c1;
+      v += r & c1;
+
+      g >>= 1;
+      u <<= 1;
+      v <<= 1;
+    }
+
+  t->u = (int64_t) u;
+  t->v = (int64_t) v;
+  t->q = (int64_t) q;
+  t->r = (int64_t) r;
+  return delta;
+}
+
+/*
+ * [d, e] = t [d, e] / 2^62 (mod m) for d, e in (-2m, m), the result stays in
+ * that range. minv is m^-1 mod 2^62.
+ */
+static void
+update_de (int64_t *d, int64_t *e, const trans_t *t, const int64_t *m,
+	   uint64_t minv, size_t L)
+{
+  const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+  int64_t sd, se, md, me;
+  int128_t cd, ce;
+  size_t i;
+
+  // add m [u, q] if d is negative, m [v, r] if e is, keeps the result above
+  // -2m
+  sd = d[L - 1] >> 63;
+  se = e[L - 1] >> 63;
+  md = (u & sd) + (v & se);
+  me = (q & sd) + (r & se);
+
+  cd = (int128_t) u * d[0] + (int128_t) v * e[0];
+  ce = (int128_t) q * d[0] + (int128_t) r * e[0];
+
+  // and the multiple of m that clears the low 62 bits
+  md -= (int64_t) ((minv * (uint64_t) cd + (uint64_t) md) & M62);
+  me -= (int64_t) ((minv * (uint64_t) ce + (uint64_t) me) & M62);
+
+  cd += (int128_t) m[0] * md;
+  ce += (int128_t) m[0] * me;
+  cd >>= 62;
+  ce >>= 62;
+
+  for (i = 1; i < L; i++)
+    {
+      cd += (int128_t) u * d[i] + (int128_t) v * e[i] + (int128_t) m[i] * md;
+      ce += (int128_t) q * d[i] + (int128_t) r * e[i] + (int128_t) m[i] * me;
+      d[i - 1] = (int64_t) cd & M62;
+      e[i - 1] = (int64_t) ce & M62;
+      cd >>= 62;
+      ce >>= 62;
+    }
+  d[L - 1] = (int64_t) cd;
+  e[L - 1] = (int64_t) ce;
+}
+
+/*
+ * [f, g] = t [f, g] / 2^62, the division is exact.
+ */
+static void
+update_fg (int64_t *f, int64_t *g, const trans_t *t, size_t L)
+{
+  const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+  int128_t cf, cg;
+  size_t i;
+
+  cf = (int128_t) u * f[0] + (int128_t) v * g[0];
+  cg = (int128_t) q * f[0] + (int128_t) r * g[0];
+  cf >>= 62;
+  cg >>= 62;
+
+  for (i = 1; i < L; i++)
+    {
+      cf += (int128_t) u * f[i] + (int128_t) v * g[i];
+      cg += (int128_t) q * f[i] + (int128_t) r * g[i];
+      f[i - 1] = (int64_t) cf & M62;
+      g[i - 1] = (int64_t) cg & M62;
+      cf >>= 62;
+      cg >>= 62;
+    }
+  f[L - 1] = (int64_t) cf;
+  g[L - 1] = (int64_t) cg;
+}
+
+/*
+ * x = x + (m & mask) with the carries propagated, the low limbs end up in
+ * [0, 2^62).
+ */
+static void
+add_masked (int64_t *x, const int64_t *m, int64_t mask, size_t L)
+{
+  int64_t c = 0;
+  size_t i;
+
+  for (i = 0; i < L; i++)
+    {
+      c += x[i] + (m[i] & mask);
+      x[i] = i + 1 < L ? (int64_t) (c & M62) : c;
+      c >>= 62;
+    }
+}
+
+/*
+ * x = -x if mask is all ones.
+ */
+static void
+neg_masked (int64_t *x, int64_t mask, size_t L)
+{
+  int64_t c = 0;
+  size_t i;
+
+  for (i = 0; i < L; i++)
+    {
+      c += (x[i] ^ mask) - mask;
+      x[i] = i + 1 < L ? (int64_t) (c & M62) : c;
+      c >>= 62;
+    }
+}
+
+/*
+ * r = a^-1 (mod m) for an odd n-limb m and an n-limb a, with the
+ * Bernstein-Yang safegcd: f = m and g = a go through a fixed number of
+ * divsteps in batches of 62, each batch applies its transition matrix to
+ * f, g and to the Bezout coefficients d, e with f ≡ d a and g ≡ e a (mod m).
+ * In the end g = 0 and f = ±gcd(a, m). The steps and the memory accesses
+ * only depend on n.
+ * returns false if a is not invertible.
+ */
+static bool
+inverse (uint64_t *r, const uint64_t *a, const uint64_t *m, size_t n,
+	 uintN_ws_t *ws)
+{
+  size_t L, i, bits, steps;
+  int64_t delta, sign, one, minus;
+  uint64_t minv, w;
+  trans_t t;
+  bool ok;
+
+  L = s62_limbs (n);
+
+  size_t mark = uintN_ws_mark (ws);
+  int64_t *f = (int64_t *) uintN_ws_alloc (ws, 5 * L);
+  int64_t *g = f + L;
+  int64_t *d = g + L;
+  int64_t *e = d + L;
+  int64_t *ms = e + L;
+
+  to_s62 (ms, L, m, n);
+  to_s62 (f, L, m, n);
+  to_s62 (g, L, a, n);
+  memset (d, 0, 2 * L * sizeof(int64_t));
+  e[0] = 1;
+
+  // m^-1 mod 2^64 by Newton's iteration, m is its own inverse mod 8 and
+  // every step doubles the correct bits
+  for (i = 0, w = m[0]; i < 5; i++)
+    w *= 2 - m[0] * w;
+  minv = w & M62;
+
+  // divsteps needed for inputs below 2^bits >= 2^46, Bernstein and Yang
+  // theorem 11.2
+  bits = PART_SIZE_BITS * n;
+  steps = (49 * bits + 57) / 17;
+
+  for (i = 0, delta = 1; i < steps; i += 62)
+    {
+      delta = divsteps_62 (delta, (uint64_t) f[0], (uint64_t) g[0], &t);
+      update_de (d, e, &t, ms, minv, L);
+      update_fg (f, g, &t, L);
+    }
+
+  // f = ±1 if a is invertible
+  sign = f[L - 1] >> 63;
+  one = f[0] ^ 1;
+  minus = f[0] ^ M62;
+  for (i = 1; i < L; i++)
+    {
+      one |= f[i];
+      minus |= f[i] ^ (int64_t) (i + 1 < L ? M62 : ~0ull);
+    }
+  ok = (sign ? minus : one) == 0;
+
+  // r = ±d in [0, m), from d in (-2m, m)
+  add_masked (d, ms, d[L - 1] >> 63, L);
+  neg_masked (d, sign, L);
+  add_masked (d, ms, d[L - 1] >> 63, L);
+  if (ok)
+    from_s62 (r, n, d, L);
+
+  uintN_wipe (f, 5 * L * sizeof(int64_t));
+  uintN_ws_release (ws, mark);
+  return ok;
+}
+
+static bool
+modinv_odd (const uintN_t *a, const uintN_t *m, uintN_t *c)
+{
+  bool ok;
+  size_t i, n;
+  uint64_t high;
+  uintN_ws_t *ws = uintN_ws_thread ();
+
+  n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+
+  size_t mark = uintN_ws_mark (ws);
+  uintN_t *_a = uintN_ws_alloc_N (ws);
+
+  // divsteps take any a below 2^(64 n), only a longer one is divided and
+  // the branch does not depend on the low n limbs
+  for (i = n, high = 0; i < NUMBER_OF_PARTS; i++)
+    high |= a->parts[i];
+  if (high != 0)
+    reduce (a->parts, NUMBER_OF_PARTS, m, _a->parts, ws);
+  else
+    uintN_set (_a, a->parts);
+
+  // everything is 0 modulo 1
+  ok = inverse (_a->parts, _a->parts, m->parts, n, ws) && !uintN_isone (m);
+  if (ok)
+    {
+      uintp_copy (c->parts, _a->parts, n);
+      uintp_zero (c->parts + n, NUMBER_OF_PARTS - n);
+    }
+
+  uintN_zeroize (_a);
+  uintN_ws_release (ws, mark);
+  return ok;
+}
+
+/*
+ * c = a^-1 (mod m) for an even m through an inverse modulo the odd a:
+ * x = m^-1 (mod a) makes 1 + m (a - x) a multiple of a, and the quotient is
+ * 1 (mod m) times a^-1, below m for a > 1. m is the secret (lambda for an
+ * RSA d = e^-1), so it goes only through fixed sequences: m mod a bit by
+ * bit with masked subtractions, and the exact quotient as the product
+ * with a^-1 mod 2^(64 n) instead of a division.
+ */
+static bool
+modinv_even (const uintN_t *a, const uintN_t *m, uintN_t *c)
+{
+  bool ok;
+  size_t n, an, i;
+  uint64_t top, borrow, v, carry;
+  uintN_ws_t *ws = uintN_ws_thread ();
+
+  n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+
+  size_t mark = uintN_ws_mark (ws);
+  uintN_t *_a = uintN_ws_alloc_N (ws);
+  uintN_t *x = uintN_ws_alloc_N (ws);
+  uintN_t *r = uintN_ws_alloc_N (ws);
+  uint64_t *p = uintN_ws_alloc (ws, n);
+  uint64_t *ia = uintN_ws_alloc (ws, n);
+  uint64_t *s = uintN_ws_alloc (ws, n);
+  uint64_t *t = uintN_ws_alloc (ws, n);
+
+  // a is public, only an a above m is divided by it
+  if (uintN_cmp (a, m) >= 0)
+    reduce (a->parts, NUMBER_OF_PARTS, m, _a->parts, ws);
+  else
+    uintN_set (_a, a->parts);
+  an = uintp_normalize (_a->parts, NUMBER_OF_PARTS);
+
+  // an even a shares the factor 2 with m
+  ok = uintN_isodd (_a);
+  if (ok && uintN_isone (_a))
+    uintN_set (c, _a->parts);
+  else if (ok)
+    {
+      // r = m mod a over all 64 n bits of m, 2 r + 1 < 2 a fits an limbs
+      // and the carry
+      uintN_zeroize (r);
+      for (i = n * PART_SIZE_BITS; i-- > 0;)
+	{
+	  top = uintp_lshift (r->parts, r->parts, an, 1);
+	  r->parts[0] |= (m->parts[i / PART_SIZE_BITS] >> (i % PART_SIZE_BITS))
+	      & 1;
+	  borrow = uintp_sub_n (t, r->parts, _a->parts, an);
+	  uintp_cselect (r->parts, t, r->parts, an, -(top | (borrow ^ 1)));
+	}
+      ok = modinv_odd (r, _a, x);
+    }
+
+  if (ok && !uintN_isone (_a))
+    {
+      // p = 1 + m (a - x) mod 2^(64 n), the quotient is below m
+      uintp_sub_n (x->parts, _a->parts, x->parts, an);
+      uintp_mullo_n (p, m->parts, x->parts, n);
+      for (i = 0, carry = 1; i < n; i++)
+	carry = __builtin_add_overflow (p[i], carry, &p[i]);
+
+      // ia = a^-1 mod 2^(64 n): Newton's ia + ia (1 - a ia), the low limb
+      // first, then doubling the correct limbs
+      for (i = 0, v = _a->parts[0]; i < 5; i++)
+	v *= 2 - _a->parts[0] * v;
+      uintp_zero (ia, n);
+      ia[0] = v;
+      for (i = 1; i < n; i *= 2)
+	{
+	  uintp_mullo_n (s, _a->parts, ia, n);
+	  s[0] -= 1;
+	  uintp_mullo_n (t, ia, s, n);
+	  uintp_sub_n (ia, ia, t, n);
+	}
+
+      uintp_mullo_n (t, p, ia, n);
+      uintp_copy (c->parts, t, n);
+      uintp_zero (c->parts + n, NUMBER_OF_PARTS - n);
+    }
+
+  uintN_wipe (_a, (uintN_ws_mark (ws) - mark) * sizeof(uint64_t));
+  uintN_ws_release (ws, mark);
+  return ok;
+}
+
+bool
+uintN_modinv (const uintN_t *a, const uintN_t *m, uintN_t *c)
+{
+  assert(a != NULL);
+  assert(m != NULL);
+  assert(c != NULL);
+  assert(!uintN_iszero (m));
+
+  if (uintN_isodd (m))
+    return modinv_odd (a, m, c);
+  return modinv_even (a, m, c);
+}
+
+bool
+uintN_modinv_batch (const uintN_t *a, size_t k, const uintN_t *m, uintN_t *c)
+{
+  assert(a != NULL || k == 0);
+  assert(m != NULL);
+  assert(c != NULL || k == 0);
+  assert(uintN_isodd (m));
+
+  bool ok;
+  size_t i, n;
+  uintN_mont_t ctx;
+  uintN_ws_t *ws = uintN_ws_thread ();
+
+  if (k == 0)
+    return true;
+
+  uintN_modcache_mont (m, &ctx);
+  n = ctx.n;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *inv = uintN_ws_alloc (ws, n);
+  uint64_t *tp = uintN_ws_alloc (ws, 2 * n);
+
+  // c[i] = a[0] ... a[i] R^-i, the Montgomery factors cancel out on the way
+  // back so a and c stay plain
+  uintN_set (&c[0], a[0].parts);
+  for (i = 1; i < k; i++)
+    {
+      uintN_mont_mulp (&ctx, c[i].parts, c[i - 1].parts, a[i].parts, tp);
+      uintp_zero (c[i].parts + n, NUMBER_OF_PARTS - n);
+    }
+
+  // inv = (a[0] ... a[i])^-1 R^i, the one real inversion
+  ok = uintp_normalize (c[k - 1].parts, n) != 0
+      && inverse (inv, c[k - 1].parts, m->parts, n, ws);
+
+  if (ok)
+    {
+      for (i = k - 1; i > 0; i--)
+	{
+	  uintN_mont_mulp (&ctx, c[i].parts, inv, c[i - 1].parts, tp);
+	  uintN_mont_mulp (&ctx, inv, inv, a[i].parts, tp);
+	}
+      uintp_copy (c[0].parts, inv, n);
+    }
+
+  uintN_wipe (inv, 3 * n * sizeof(uint64_t));
+  uintN_ws_release (ws, mark);
+  return ok;
+}
+
+void
+uintN_modacc_init (uintN_modacc_t *acc, const uintN_t *m)
+{
+  assert(acc != NULL);
+  assert(m != NULL);
+  assert(!uintN_iszero (m));
+
+  uintp_zero (acc->parts, ACC_PARTS);
+  uintN_set (&acc->m, m->parts);
+  acc->n = 0;
+}
+
+/*
+ * fold the accumulator back below m, called when the headroom limb is full.
+ */
+static void
+fold (uintN_modacc_t *acc)
+{
+  uintN_ws_t *ws = uintN_ws_thread ();
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *r = uintN_ws_alloc (ws, NUMBER_OF_PARTS);
+
+  reduce (acc->parts, acc->n, &acc->m, r, ws);
+  uintp_copy (acc->parts, r, NUMBER_OF_PARTS);
+  uintp_zero (acc->parts + NUMBER_OF_PARTS, ACC_PARTS - NUMBER_OF_PARTS);
+  acc->n = uintp_normalize (acc->parts, NUMBER_OF_PARTS);
+
+  uintN_ws_release (ws, mark);
+}
+
+/*
+ * acc += t for a tn-limb t, carries stop at the first limb not overflowing.
+ */
+static void
+accumulate (uintN_modacc_t *acc, const uint64_t *t, size_t tn)
+{
+  uint64_t carry;
+
+  if (acc->parts[ACC_PARTS - 1] == UINT64_MAX)
+    fold (acc);
+
+  carry = uintp_add_n (acc->parts, acc->parts, t, tn);
+  if (carry)
+    uintp_add_1 (acc->parts + tn, acc->parts + tn, ACC_PARTS - tn, carry);
+  acc->n = uintp_normalize (acc->parts, ACC_PARTS);
+}
+
+void
+uintN_modacc_add (uintN_modacc_t *acc, const uintN_t *a)
+{
+  assert(acc != NULL);
+  assert(a != NULL);
+
+  accumulate (acc, a->parts, uintp_normalize (a->parts, NUMBER_OF_PARTS));
+}
+
+void
+uintN_modacc_addmul (uintN_modacc_t *acc, const uintN_t *a, const uintN_t *b)
+{
+  assert(acc != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+
+  size_t an, bn;
+  uintN_ws_t *ws = uintN_ws_thread ();
+
+  an = uintp_normalize (a->parts, NUMBER_OF_PARTS);
+  bn = uintp_normalize (b->parts, NUMBER_OF_PARTS);
+  if (an == 0 || bn == 0)
+    return;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *p = uintN_ws_alloc (ws, an + bn);
+
+  uintp_mul (p, a->parts, an, b->parts, bn);
+  accumulate (acc, p, an + bn);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_modacc_submul (uintN_modacc_t *acc, const uintN_t *a, const uintN_t *b)
+{
+  assert(acc != NULL);
+  assert(a != NULL);
+  assert(uintN_isless (a, &acc->m));
+
+  uintN_t _a;
+
+  uintN_modneg (a, &acc->m, &_a);
+  uintN_modacc_addmul (acc, &_a, b);
+  uintN_zeroize (&_a);
+}
+
+void
+uintN_modacc_get (uintN_modacc_t *acc, uintN_t *c)
+{
+  assert(acc != NULL);
+  assert(c != NULL);
+
+  fold (acc);
+  uintp_copy (c->parts, acc->parts, NUMBER_OF_PARTS);
+}
+
+void
+uintN_modacc_zeroize (uintN_modacc_t *acc)
+{
+  assert(acc != NULL);
+
+  uintN_wipe (acc, sizeof(*acc));
+}
@@ -0,0 +1,185 @@
+/*
+ * modarith.h
+ *
+ * Header file for arithmetic in the residue ring modulo a uintN_t m.
+ *
+ * modadd, modsub and modneg expect operands already reduced below m and
+ * cost one linear pass. modmul and modsqr reduce the full double-width
+ * product once.
+ *
+ * Expressions like sum(a_i * b_i) mod m go through an accumulator instead:
+ * the products are added up unreduced in a double-width register with one
+ * extra limb of headroom, and reduced once when the result is read.
+ *
+ * Inverses come one at a time from uintN_modinv, in constant time for an odd
+ * m, or many at once modulo an odd m from uintN_modinv_batch at the price of
+ * one inversion and three multiplications each.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef MODARITH_H_
+#define MODARITH_H_
+
+#include <stddef.h>
+
+#include "uintN.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+typedef struct
+{
+  uint64_t parts[2 * NUMBER_OF_PARTS + 1];
+  uintN_t m;
+  size_t n;
+} uintN_modacc_t;
+
+/**
+ * uintN modular addition c ≡ a + b (mod m), a and b must be less than m.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintN_modadd (const uintN_t *a, const uintN_t *b, const uintN_t *m,
+	      uintN_t *c);
+
+/**
+ * uintN modular subtraction c ≡ a - b (mod m), a and b must be less than m.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintN_modsub (const uintN_t *a, const uintN_t *b, const uintN_t *m,
+	      uintN_t *c);
+
+/**
+ * uintN modular negation c ≡ -a (mod m), a must be less than m.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintN_modneg (const uintN_t *a, const uintN_t *m, uintN_t *c);
+
+/**
+ * uintN modular multiplication c ≡ a * b (mod m).
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_modmul (const uintN_t *a, const uintN_t *b, const uintN_t *m,
+	      uintN_t *c);
+
+/**
+ * uintN modular squaring c ≡ a ^ 2 (mod m).
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_modsqr (const uintN_t *a, const uintN_t *m, uintN_t *c);
+
+/**
+ * uintN fused multiply-add d ≡ c + a * b (mod m), with a single reduction.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_modaddmul (const uintN_t *c, const uintN_t *a, const uintN_t *b,
+		 const uintN_t *m, uintN_t *d);
+
+/**
+ * uintN sum of products c ≡ a[0] * b[0] + ... + a[k-1] * b[k-1] (mod m),
+ * with a single reduction.
+ *
+ * The running time of implemented algorithm is O(k n^2).
+ */
+void
+uintN_modsop (const uintN_t *const *a, const uintN_t *const *b, size_t k,
+	      const uintN_t *m, uintN_t *c);
+
+/**
+ * uintN modular inverse c ≡ a^-1 (mod m) for a non-zero m.
+ * returns false if a is not invertible, c is left unchanged.
+ * the implementation use the safegcd divsteps of Bernstein and Yang in
+ * batches of 62, a fixed number of them for the limb length n of m. for an
+ * odd m and an a below 2^(64 n) the running time and memory accesses depend
+ * on n only, a longer a is reduced first. an even m, e.g. a secret
+ * lambda(n) for d = e^-1 mod lambda(n), takes x = m^-1 (mod a) and
+ * c = (1 + m (a - x)) / a: m mod a is taken bit by bit and the exact
+ * quotient as a product with a^-1 mod 2^(64 n), so the running time depends
+ * on a and the limb length of m only. a is treated as public and an a not
+ * below m is reduced by a division first.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+bool
+uintN_modinv (const uintN_t *a, const uintN_t *m, uintN_t *c);
+
+/**
+ * uintN batch modular inverse c[i] ≡ a[i]^-1 (mod m) for an odd m and
+ * 0 < a[i] < m, c must not overlap a.
+ * the implementation use Montgomery's trick: the prefix products are kept in
+ * c, their total is inverted once and the way back peels off one inverse per
+ * element, 3 (k - 1) multiplications in all. both passes run sequentially
+ * over a and c with a fixed amount of scratch, so arrays far larger than the
+ * cache stream through memory.
+ * returns false if some a[i] is not invertible, c is undefined then.
+ *
+ * The running time of implemented algorithm is O(k n^2) plus one inversion.
+ */
+bool
+uintN_modinv_batch (const uintN_t *a, size_t k, const uintN_t *m, uintN_t *c);
+
+/**
+ * accumulator init to zero modulo m.
+ */
+void
+uintN_modacc_init (uintN_modacc_t *acc, const uintN_t *m);
+
+/**
+ * accumulator acc += a, unreduced.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintN_modacc_add (uintN_modacc_t *acc, const uintN_t *a);
+
+/**
+ * accumulator acc += a * b, unreduced.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_modacc_addmul (uintN_modacc_t *acc, const uintN_t *a, const uintN_t *b);
+
+/**
+ * accumulator acc -= a * b, added as (m - a) * b so it stays unreduced and
+ * non-negative. a must be less than m.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_modacc_submul (uintN_modacc_t *acc, const uintN_t *a, const uintN_t *b);
+
+/**
+ * accumulator c ≡ acc (mod m), the one reduction of the expression.
+ * the accumulator keeps its (reduced) value and can be used further.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_modacc_get (uintN_modacc_t *acc, uintN_t *c);
+
+/**
+ * accumulator wipe.
+ */
+void
+uintN_modacc_zeroize (uintN_modacc_t *acc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODARITH_H_ */
@@ -0,0 +1,245 @@
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "modcache.h"
+#include "workspace.h"
+
+typedef struct
+{
+  uintN_mont_t mont;
+  uintN_reducer_t red;
+  uint64_t hash;
+  uint64_t stamp; /* last use, 0 for a free slot */
+  unsigned int pins;
+  bool odd;
+} entry_t;
+
+static entry_t entries[UINTN_MODCACHE_SLOTS];
+static uint64_t ticks;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t
+hash (const uintN_t *m)
+{
+  uint16_t i;
+  uint64_t h;
+
+  for (i = 0, h = 0; i < NUMBER_OF_PARTS; i++)
+    h = ((h << 5) | (h >> 59)) ^ m->parts[i];
+  return h;
+}
+
+/*
+ * entry of m or NULL, a hit counts as a use. lock must be held.
+ */
+static entry_t *
+find (const uintN_t *m, uint64_t h)
+{
+  unsigned int i;
+
+  for (i = 0; i < UINTN_MODCACHE_SLOTS; i++)
+    if (entries[i].stamp != 0 && entries[i].hash == h
+	&& uintN_isequal (&entries[i].red.m, m))
+      {
+	entries[i].stamp = ++ticks;
+	return &entries[i];
+      }
+  return NULL;
+}
+
+/*
+ * entry of m, set up and inserted in place of the least recently used
+ * unpinned entry on a miss. returns with the lock held, or NULL without it
+ * if every slot is pinned, fresh holds the set up entry in both cases of a
+ * miss.
+ */
+static entry_t *
+acquire (const uintN_t *m, entry_t *fresh)
+{
+  unsigned int i;
+  uint64_t h;
+  entry_t *e;
+
+  h = hash (m);
+
+  pthread_mutex_lock (&lock);
+  e = find (m, h);
+  if (e != NULL)
+    return e;
+  pthread_mutex_unlock (&lock);
+
+  // set up outside the lock, the Montgomery constants take two divisions
+  memset (fresh, 0, sizeof(*fresh));
+  fresh->odd = uintN_mont_init (&fresh->mont, m);
+  uintN_reducer_init (&fresh->red, m);
+  fresh->hash = h;
+
+  pthread_mutex_lock (&lock);
+
+  // another thread may have set up the same modulus in the meantime
+  e = find (m, h);
+  if (e != NULL)
+    return e;
+
+  // free slots have stamp 0 and go first
+  for (i = 0; i < UINTN_MODCACHE_SLOTS; i++)
+    if (entries[i].pins == 0 && (e == NULL || entries[i].stamp < e->stamp))
+      e = &entries[i];
+
+  if (e == NULL)
+    {
+      pthread_mutex_unlock (&lock);
+      return NULL;
+    }
+
+  memcpy (e, fresh, sizeof(*e));
+  e->stamp = ++ticks;
+  return e;
+}
+
+bool
+uintN_modcache_mont (const uintN_t *m, uintN_mont_t *ctx)
+{
+  assert(m != NULL);
+  assert(ctx != NULL);
+
+  entry_t fresh, *e;
+  const entry_t *src;
+  bool odd;
+
+  e = acquire (m, &fresh);
+  src = e != NULL ? e : &fresh;
+
+  odd = src->odd;
+  if (odd)
+    memcpy (ctx, &src->mont, sizeof(*ctx));
+
+  if (e != NULL)
+    pthread_mutex_unlock (&lock);
+  return odd;
+}
+
+bool
+uintN_modcache_reducer (const uintN_t *m, uintN_reducer_t *red)
+{
+  assert(m != NULL);
+  assert(red != NULL);
+
+  entry_t fresh, *e;
+  const entry_t *src;
+
+  e = acquire (m, &fresh);
+  src = e != NULL ? e : &fresh;
+
+  if (src->red.form != UINTN_FORM_GENERIC)
+    memcpy (red, &src->red, sizeof(*red));
+  else
+    red->form = UINTN_FORM_GENERIC;
+
+  if (e != NULL)
+    pthread_mutex_unlock (&lock);
+  return red->form != UINTN_FORM_GENERIC;
+}
+
+bool
+uintN_modcache_lookup (const uintN_t *m, uintN_mont_t *ctx,
+		       uintN_reducer_t *red)
+{
+  assert(m != NULL);
+  assert(ctx != NULL);
+  assert(red != NULL);
+
+  entry_t fresh, *e;
+  const entry_t *src;
+  bool odd;
+
+  e = acquire (m, &fresh);
+  src = e != NULL ? e : &fresh;
+
+  odd = src->odd;
+  if (odd)
+    memcpy (ctx, &src->mont, sizeof(*ctx));
+  if (src->red.form != UINTN_FORM_GENERIC)
+    memcpy (red, &src->red, sizeof(*red));
+  else
+    red->form = UINTN_FORM_GENERIC;
+
+  if (e != NULL)
+    pthread_mutex_unlock (&lock);
+  return odd;
+}
+
+bool
+uintN_modcache_reducer_peek (const uintN_t *m, uintN_reducer_t *red)
+{
+  assert(m != NULL);
+  assert(red != NULL);
+
+  entry_t *e;
+  bool found;
+
+  // most moduli are generic, those need neither the lock nor a detection
+  if (!uintN_reducer_maybe (m))
+    {
+      red->form = UINTN_FORM_GENERIC;
+      return false;
+    }
+
+  pthread_mutex_lock (&lock);
+  e = find (m, hash (m));
+  found = e != NULL;
+  if (found && e->red.form != UINTN_FORM_GENERIC)
+    memcpy (red, &e->red, sizeof(*red));
+  else if (found)
+    red->form = UINTN_FORM_GENERIC;
+  pthread_mutex_unlock (&lock);
+
+  // a one-off modulus is detected here and not cached, it would evict a
+  // long-lived one
+  if (!found)
+    uintN_reducer_init (red, m);
+  return red->form != UINTN_FORM_GENERIC;
+}
+
+bool
+uintN_modcache_pin (const uintN_t *m)
+{
+  assert(m != NULL);
+
+  entry_t fresh, *e;
+
+  e = acquire (m, &fresh);
+  if (e == NULL)
+    return false;
+
+  e->pins++;
+  pthread_mutex_unlock (&lock);
+  return true;
+}
+
+void
+uintN_modcache_unpin (const uintN_t *m)
+{
+  assert(m != NULL);
+
+  entry_t *e;
+
+  pthread_mutex_lock (&lock);
+  e = find (m, hash (m));
+  assert(e != NULL && e->pins > 0);
+  e->pins--;
+  pthread_mutex_unlock (&lock);
+}
+
+void
+uintN_modcache_clear (void)
+{
+  unsigned int i;
+
+  pthread_mutex_lock (&lock);
+  for (i = 0; i < UINTN_MODCACHE_SLOTS; i++)
+    if (entries[i].pins == 0)
+      uintN_wipe (&entries[i], sizeof(entries[i]));
+  pthread_mutex_unlock (&lock);
+}
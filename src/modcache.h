@@ -0,0 +1,107 @@
+/*
+ * modcache.h
+ *
+ * Header file for the cache of per-modulus precomputation.
+ *
+ * Everything a modulus needs before the first reduction is computed once
+ * and kept in a small process-wide cache: the Montgomery context of an odd
+ * modulus (m^-1 mod 2^64, R and R^2 mod m) and the special form detected by
+ * the reducer. uintN_modp, the batch inversion and the job pool fetch their
+ * constants from here, so a workload cycling through a handful of RSA keys
+ * or DH groups pays for the setup once per modulus instead of once per call.
+ * uintN_mod and the modarith reductions only look moduli up and do not
+ * insert them.
+ *
+ * The cache holds UINTN_MODCACHE_SLOTS moduli and evicts the least recently
+ * used one. Long-lived keys can be pinned so a burst of other moduli does
+ * not push them out. Entries are copied out under a lock, safe to use from
+ * several threads.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef MODCACHE_H_
+#define MODCACHE_H_
+
+#include <stddef.h>
+
+#include "uintN.h"
+#include "montgomery.h"
+#include "reducer.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* number of moduli remembered by the cache */
+#define UINTN_MODCACHE_SLOTS 32
+
+/**
+ * modcache Montgomery context of m, set up on first use.
+ * returns false if m is even.
+ *
+ * The running time of implemented algorithm is O(n) on a hit, O(n^2) on a
+ * miss.
+ */
+bool
+uintN_modcache_mont (const uintN_t *m, uintN_mont_t *ctx);
+
+/**
+ * modcache reducer of m, the form of m is detected on first use.
+ * returns true and copies the reducer into red if m has a special form.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+bool
+uintN_modcache_reducer (const uintN_t *m, uintN_reducer_t *red);
+
+/**
+ * modcache Montgomery context and reducer of m in one lookup, as
+ * uintN_modcache_mont and uintN_modcache_reducer under a single lock.
+ * returns false if m is even, ctx is then not set.
+ *
+ * The running time of implemented algorithm is O(n) on a hit, O(n^2) on a
+ * miss.
+ */
+bool
+uintN_modcache_lookup (const uintN_t *m, uintN_mont_t *ctx,
+		       uintN_reducer_t *red);
+
+/**
+ * modcache reducer of m as uintN_modcache_reducer, but a modulus that is not
+ * cached yet is detected without being inserted. For callers like uintN_mod
+ * that see many one-off moduli.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+bool
+uintN_modcache_reducer_peek (const uintN_t *m, uintN_reducer_t *red);
+
+/**
+ * modcache pin m, its entry is set up now and never evicted until unpinned.
+ * pins nest, every pin needs its unpin.
+ * returns false if every slot is pinned already.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+bool
+uintN_modcache_pin (const uintN_t *m);
+
+/**
+ * modcache unpin m, its entry becomes evictable again after the last unpin.
+ */
+void
+uintN_modcache_unpin (const uintN_t *m);
+
+/**
+ * modcache drop and wipe every entry that is not pinned.
+ */
+void
+uintN_modcache_clear (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODCACHE_H_ */
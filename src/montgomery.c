@@ -0,0 +1,280 @@
+#include <assert.h>
+#include <string.h>
+
+#include "montgomery.h"
+#include "uintp.h"
+#include "tune.h"
+
+bool
+uintN_mont_init (uintN_mont_t *ctx, const uintN_t *m)
+{
+  assert(ctx != NULL);
+  assert(m != NULL);
+
+  size_t n, i;
+  uint64_t inv;
+
+  if (uintN_iseven (m))
+    return false;
+
+  n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+
+  memset (ctx, 0, sizeof(*ctx));
+  uintN_set (&ctx->m, m->parts);
+  ctx->n = n;
+
+  // Newton iteration, every step doubles the number of correct low bits
+  for (i = 0, inv = m->parts[0]; i < 5; i++)
+    inv *= 2 - m->parts[0] * inv;
+  ctx->minv = -inv;
+
+  uintN_ws_t *ws = uintN_ws_thread ();
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *t = uintN_ws_alloc (ws, 2 * n + 1);
+  uint64_t *tp = uintN_ws_alloc (ws, UINTP_DIVREM_SCRATCH(2 * n + 1, n));
+
+  // R mod m
+  uintp_zero (t, n + 1);
+  t[n] = 1;
+  uintp_divrem (NULL, ctx->one.parts, t, n + 1, m->parts, n, tp);
+
+  // R^2 mod m
+  uintp_zero (t, 2 * n + 1);
+  t[2 * n] = 1;
+  uintp_divrem (NULL, ctx->rr.parts, t, 2 * n + 1, m->parts, n, tp);
+
+  uintN_ws_release (ws, mark);
+
+  return true;
+}
+
+void
+uintN_mont_redc (const uintN_mont_t *ctx, uint64_t *r, uint64_t *t)
+{
+  assert(ctx != NULL);
+  assert(r != NULL);
+  assert(t != NULL);
+
+  size_t i, n;
+  uint64_t q, c, top;
+
+  n = ctx->n;
+
+  for (i = 0, top = 0; i < n; i++)
+    {
+      q = t[i] * ctx->minv;
+      c = uintp_addmul_1 (t + i, ctx->m.parts, n, q);
+
+      // the carry limb and the previous carry bit both land on t[i + n]
+      top = __builtin_add_overflow (t[i + n], top, &t[i + n]);
+      top += __builtin_add_overflow (t[i + n], c, &t[i + n]);
+    }
+
+  // the low half is free now: subtract m there and keep the difference
+  // unless it borrowed past the carry limb, without a branch on the data
+  c = uintp_sub_n (t, t + n, ctx->m.parts, n);
+  uintp_cselect (r, t, t + n, n, -(top | (c ^ 1)));
+}
+
+void
+uintN_mont_mulp (const uintN_mont_t *ctx, uint64_t *r, const uint64_t *a,
+		 const uint64_t *b, uint64_t *tp)
+{
+  assert(ctx != NULL);
+
+  uintp_mul (tp, a, ctx->n, b, ctx->n);
+  uintN_mont_redc (ctx, r, tp);
+}
+
+void
+uintN_mont_sqrp (const uintN_mont_t *ctx, uint64_t *r, const uint64_t *a,
+		 uint64_t *tp)
+{
+  assert(ctx != NULL);
+
+  uintp_sqr (tp, a, ctx->n);
+  uintN_mont_redc (ctx, r, tp);
+}
+
+void
+uintN_mont_mul (const uintN_mont_t *ctx, const uintN_t *a, const uintN_t *b,
+		uintN_t *c, uintN_ws_t *ws)
+{
+  assert(ctx != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(c != NULL);
+  assert(ws != NULL);
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, 2 * ctx->n);
+
+  uintN_mont_mulp (ctx, c->parts, a->parts, b->parts, tp);
+  uintp_zero (c->parts + ctx->n, NUMBER_OF_PARTS - ctx->n);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_mont_to (const uintN_mont_t *ctx, const uintN_t *a, uintN_t *c,
+	       uintN_ws_t *ws)
+{
+  uintN_mont_mul (ctx, a, &ctx->rr, c, ws);
+}
+
+void
+uintN_mont_from (const uintN_mont_t *ctx, const uintN_t *a, uintN_t *c,
+		 uintN_ws_t *ws)
+{
+  assert(ctx != NULL);
+  assert(a != NULL);
+  assert(c != NULL);
+  assert(ws != NULL);
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *t = uintN_ws_alloc (ws, 2 * ctx->n);
+
+  uintp_copy (t, a->parts, ctx->n);
+  uintp_zero (t + ctx->n, ctx->n);
+  uintN_mont_redc (ctx, c->parts, t);
+  uintp_zero (c->parts + ctx->n, NUMBER_OF_PARTS - ctx->n);
+
+  uintN_ws_release (ws, mark);
+}
+
+static size_t
+bit_length (const uint64_t *a, size_t n)
+{
+  n = uintp_normalize (a, n);
+  if (n == 0)
+    return 0;
+  return n * PART_SIZE_BITS - __builtin_clzll (a[n - 1]);
+}
+
+static unsigned int
+get_bits (const uint64_t *a, size_t pos, unsigned int w)
+{
+  size_t i = pos / PART_SIZE_BITS, s = pos % PART_SIZE_BITS;
+  uint64_t v = a[i] >> s;
+
+  if (s + w > PART_SIZE_BITS && i + 1 < NUMBER_OF_PARTS)
+    v |= a[i + 1] << (PART_SIZE_BITS - s);
+  return v & ((1u << w) - 1);
+}
+
+void
+uintN_mont_modp (const uintN_mont_t *ctx, const uintN_t *base,
+		 const uintN_t *exp, uintN_t *dest, uintN_ws_t *ws)
+{
+  assert(ctx != NULL);
+  assert(base != NULL);
+  assert(exp != NULL);
+  assert(dest != NULL);
+  assert(ws != NULL);
+
+  size_t bits, pos, n, i;
+  unsigned int w, d;
+
+  n = ctx->n;
+  bits = bit_length (exp->parts, NUMBER_OF_PARTS);
+  w = uintN_tune_window (bits);
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, 2 * n);
+  uint64_t *table = uintN_ws_alloc (ws, (1u << w) * n);
+  uint64_t *acc = uintN_ws_alloc (ws, n);
+  uintN_t *b = uintN_ws_alloc_N (ws);
+
+  // table[i] = base^i R (mod m)
+  uintN_mod_ws (base, &ctx->m, b, ws);
+  uintp_copy (table, ctx->one.parts, n);
+  uintN_mont_mulp (ctx, table + n, b->parts, ctx->rr.parts, tp);
+  for (i = 2; i < (1u << w); i++)
+    uintN_mont_mulp (ctx, table + i * n, table + (i - 1) * n, table + n, tp);
+
+  uintp_copy (acc, ctx->one.parts, n);
+
+  // left-to-right, the top window may be shorter than w
+  pos = (bits + w - 1) / w * w;
+  while (pos > 0)
+    {
+      if (pos < bits)
+	for (i = 0; i < w; i++)
+	  uintN_mont_sqrp (ctx, acc, acc, tp);
+      pos -= w;
+
+      d = get_bits (exp->parts, pos, w);
+      if (d != 0)
+	uintN_mont_mulp (ctx, acc, acc, table + d * n, tp);
+    }
+
+  uintp_zero (b->parts, NUMBER_OF_PARTS);
+  uintp_copy (b->parts, acc, n);
+  uintN_mont_from (ctx, b, dest, ws);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_mont_modp_ct (const uintN_mont_t *ctx, const uintN_t *base,
+		    const uintN_t *exp, size_t bits, uintN_t *dest,
+		    uintN_ws_t *ws)
+{
+  assert(ctx != NULL);
+  assert(base != NULL);
+  assert(exp != NULL);
+  assert(dest != NULL);
+  assert(ws != NULL);
+  assert(bits > 0 && bits <= NUMBER_OF_BITS);
+  assert(bit_length (exp->parts, NUMBER_OF_PARTS) <= bits);
+
+  size_t pos, n, i, j;
+  unsigned int w, d;
+  uint64_t mask;
+
+  n = ctx->n;
+  w = uintN_tune_window (bits);
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, 2 * n);
+  uint64_t *table = uintN_ws_alloc (ws, (1u << w) * n);
+  uint64_t *acc = uintN_ws_alloc (ws, n);
+  uint64_t *sel = uintN_ws_alloc (ws, n);
+  uintN_t *b = uintN_ws_alloc_N (ws);
+
+  // table[i] = base^i R (mod m)
+  uintN_mod_ws (base, &ctx->m, b, ws);
+  uintp_copy (table, ctx->one.parts, n);
+  uintN_mont_mulp (ctx, table + n, b->parts, ctx->rr.parts, tp);
+  for (i = 2; i < (1u << w); i++)
+    uintN_mont_mulp (ctx, table + i * n, table + (i - 1) * n, table + n, tp);
+
+  uintp_copy (acc, ctx->one.parts, n);
+
+  // the same squarings and multiplications for every exponent below
+  // 2^bits, and every window reads the whole table: a zero window
+  // multiplies by table[0] = R
+  pos = (bits + w - 1) / w * w;
+  while (pos > 0)
+    {
+      if (pos < bits)
+	for (i = 0; i < w; i++)
+	  uintN_mont_sqrp (ctx, acc, acc, tp);
+      pos -= w;
+
+      d = get_bits (exp->parts, pos, w);
+      for (j = 0; j < (1u << w); j++)
+	{
+	  mask = -(((uint64_t) (j ^ d) - 1) >> 63);
+	  uintp_cselect (sel, table + j * n, sel, n, mask);
+	}
+      uintN_mont_mulp (ctx, acc, acc, sel, tp);
+    }
+
+  uintp_zero (b->parts, NUMBER_OF_PARTS);
+  uintp_copy (b->parts, acc, n);
+  uintN_mont_from (ctx, b, dest, ws);
+
+  uintN_wipe (tp, (uintN_ws_mark (ws) - mark) * sizeof(uint64_t));
+  uintN_ws_release (ws, mark);
+}
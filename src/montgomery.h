@@ -0,0 +1,125 @@
+/*
+ * montgomery.h
+ *
+ * Header file for Montgomery multiplication modulo an odd uintN_t.
+ *
+ * A context holds the constants for one modulus m of n significant limbs:
+ * R = 2^(64 n), -m^-1 mod 2^64, R mod m and R^2 mod m. Values in Montgomery
+ * form are a R mod m and always fit in n limbs, the remaining limbs of a
+ * uintN_t holding them are zero.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef MONTGOMERY_H_
+#define MONTGOMERY_H_
+
+#include <stddef.h>
+
+#include "uintN.h"
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+typedef struct
+{
+  uintN_t m;
+  uintN_t one;
+  uintN_t rr;
+  uint64_t minv;
+  size_t n;
+} uintN_mont_t;
+
+/**
+ * montgomery context init for the modulus m.
+ * returns false if m is even, Montgomery reduction needs an odd modulus.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+bool
+uintN_mont_init (uintN_mont_t *ctx, const uintN_t *m);
+
+/**
+ * montgomery reduction r = t R^-1 (mod m) of a 2n-limb t, t is destroyed.
+ * r may be equal to t.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_mont_redc (const uintN_mont_t *ctx, uint64_t *r, uint64_t *t);
+
+/**
+ * montgomery multiplication r = a b R^-1 (mod m) over n-limb spans.
+ * tp is scratch of 2n limbs, r may be equal to a or b.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_mont_mulp (const uintN_mont_t *ctx, uint64_t *r, const uint64_t *a,
+		 const uint64_t *b, uint64_t *tp);
+
+/**
+ * montgomery squaring r = a a R^-1 (mod m) over n-limb spans.
+ * tp is scratch of 2n limbs, r may be equal to a.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_mont_sqrp (const uintN_mont_t *ctx, uint64_t *r, const uint64_t *a,
+		 uint64_t *tp);
+
+/**
+ * montgomery multiplication c = a b R^-1 (mod m).
+ */
+void
+uintN_mont_mul (const uintN_mont_t *ctx, const uintN_t *a, const uintN_t *b,
+		uintN_t *c, uintN_ws_t *ws);
+
+/**
+ * montgomery convert c = a R (mod m), a must be less than m.
+ */
+void
+uintN_mont_to (const uintN_mont_t *ctx, const uintN_t *a, uintN_t *c,
+	       uintN_ws_t *ws);
+
+/**
+ * montgomery convert back c = a R^-1 (mod m).
+ */
+void
+uintN_mont_from (const uintN_mont_t *ctx, const uintN_t *a, uintN_t *c,
+		 uintN_ws_t *ws);
+
+/**
+ * montgomery modular exponentiation c ≡ b ^ exp (mod m), plain in and out.
+ * the implementation use the left-to-right fixed window method, the width
+ * per exponent length comes from the tuning profile.
+ *
+ * The running time of implemented algorithm is O(log exp) multiplications.
+ */
+void
+uintN_mont_modp (const uintN_mont_t *ctx, const uintN_t *base,
+		 const uintN_t *exp, uintN_t *c, uintN_ws_t *ws);
+
+/**
+ * montgomery modular exponentiation c ≡ b ^ exp (mod m) for a secret exp
+ * below 2^bits, bits is public (e.g. the bit length of m).
+ * the implementation use the fixed window method of uintN_mont_modp without
+ * its shortcuts: the sequence of squarings and multiplications depends on
+ * bits only and every window entry is read by scanning the whole table
+ * with masks, so neither the time nor the memory accesses depend on exp.
+ *
+ * The running time of implemented algorithm is O(bits) multiplications.
+ */
+void
+uintN_mont_modp_ct (const uintN_mont_t *ctx, const uintN_t *base,
+		    const uintN_t *exp, size_t bits, uintN_t *c,
+		    uintN_ws_t *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MONTGOMERY_H_ */
@@ -0,0 +1,520 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "ntt.h"
+#include "uintp.h"
+#include "workspace.h"
+#include "tune.h"
+
+typedef unsigned __int128 uint128_t;
+
+#define NTT_PRIMES 3
+
+/* largest transform, 2^55 divides p - 1 of every prime */
+#define NTT_MAX_LOG 55
+
+typedef struct
+{
+  uint64_t p;
+  uint64_t pinv; /* -p^-1 mod 2^64 */
+  uint64_t r1; /* 2^64 mod p */
+  uint64_t r2; /* 2^128 mod p */
+  uint64_t g; /* generator of the multiplicative group */
+} ntt_prime_t;
+
+/* in increasing order, Garner's step needs p0 < p1 < p2 */
+static ntt_prime_t primes[NTT_PRIMES] =
+  {
+    { 0x1b00000000000001, 0, 0, 0, 5 }, // 27 2^56 + 1
+    { 0x2280000000000001, 0, 0, 0, 5 }, // 69 2^55 + 1
+    { 0x3a00000000000001, 0, 0, 0, 3 } }; // 29 2^57 + 1
+
+/* Garner constants in Montgomery form */
+static uint64_t inv_p0; /* p0^-1 mod p1 */
+static uint64_t p0_p2; /* p0 mod p2 */
+static uint64_t inv_p0p1; /* (p0 p1)^-1 mod p2 */
+
+static pthread_once_t primes_once = PTHREAD_ONCE_INIT;
+
+static inline uint64_t
+mont_mul (uint64_t a, uint64_t b, const ntt_prime_t *q)
+{
+  uint128_t t = (uint128_t) a * b;
+  uint64_t m = (uint64_t) t * q->pinv;
+  uint64_t u;
+
+  // a b < p 2^64 keeps u below 2 p
+  u = (uint64_t) ((t + (uint128_t) m * q->p) >> 64);
+  return u >= q->p ? u - q->p : u;
+}
+
+static inline uint64_t
+add_mod (uint64_t a, uint64_t b, uint64_t p)
+{
+  a += b;
+  return a >= p ? a - p : a;
+}
+
+static inline uint64_t
+sub_mod (uint64_t a, uint64_t b, uint64_t p)
+{
+  return a >= b ? a - b : a + p - b;
+}
+
+static uint64_t
+mont_pow (uint64_t a, uint64_t e, const ntt_prime_t *q)
+{
+  uint64_t r = q->r1;
+
+  for (; e != 0; e >>= 1)
+    {
+      if (e & 1)
+	r = mont_mul (r, a, q);
+      a = mont_mul (a, a, q);
+    }
+  return r;
+}
+
+static void
+primes_init (void)
+{
+  unsigned int i, j;
+  ntt_prime_t *q;
+
+  for (i = 0; i < NTT_PRIMES; i++)
+    {
+      q = &primes[i];
+
+      // Newton iteration doubles the correct low bits of p^-1 each step
+      q->pinv = q->p;
+      for (j = 0; j < 6; j++)
+	q->pinv *= 2 - q->p * q->pinv;
+      q->pinv = -q->pinv;
+
+      q->r1 = (uint64_t) (((uint128_t) 1 << 64) % q->p);
+      q->r2 = (uint64_t) ((uint128_t) q->r1 * q->r1 % q->p);
+    }
+
+  q = &primes[1];
+  inv_p0 = mont_pow (mont_mul (primes[0].p, q->r2, q), q->p - 2, q);
+
+  q = &primes[2];
+  p0_p2 = mont_mul (primes[0].p, q->r2, q);
+  inv_p0p1 = mont_mul (p0_p2, mont_mul (primes[1].p, q->r2, q), q);
+  inv_p0p1 = mont_pow (inv_p0p1, q->p - 2, q);
+}
+
+/*
+ * w[k] = ω^k in Montgomery form for k < n / 2, ω a primitive n-th root of
+ * unity.
+ */
+static void
+roots (uint64_t *w, size_t n, const ntt_prime_t *q)
+{
+  size_t k;
+  uint64_t g, omega;
+
+  g = mont_mul (q->g, q->r2, q);
+  omega = mont_pow (g, (q->p - 1) / n, q);
+
+  w[0] = q->r1;
+  for (k = 1; k < n / 2; k++)
+    w[k] = mont_mul (w[k - 1], omega, q);
+}
+
+/*
+ * w[k] = ω^-k = -ω^(n/2 - k), turns the table of roots into the table for
+ * the inverse transform.
+ */
+static void
+roots_inverse (uint64_t *w, size_t n, const ntt_prime_t *q)
+{
+  size_t k, h = n / 2;
+  uint64_t t;
+
+  for (k = 1; 2 * k < h; k++)
+    {
+      t = w[k];
+      w[k] = q->p - w[h - k];
+      w[h - k] = q->p - t;
+    }
+  if (h > 1)
+    w[h / 2] = q->p - w[h / 2];
+}
+
+/*
+ * decimation in frequency, natural order in, bit-reversed order out.
+ */
+static void
+forward (uint64_t *x, size_t n, const uint64_t *w, const ntt_prime_t *q)
+{
+  size_t len, i, j, stride;
+  uint64_t u, v;
+
+  for (len = n / 2, stride = 1; len >= 1; len >>= 1, stride <<= 1)
+    for (i = 0; i < n; i += 2 * len)
+      for (j = 0; j < len; j++)
+	{
+	  u = x[i + j];
+	  v = x[i + j + len];
+	  x[i + j] = add_mod (u, v, q->p);
+	  x[i + j + len] = mont_mul (sub_mod (u, v, q->p), w[j * stride], q);
+	}
+}
+
+/*
+ * decimation in time, bit-reversed order in, natural order out, scaled by n.
+ */
+static void
+inverse (uint64_t *x, size_t n, const uint64_t *w, const ntt_prime_t *q)
+{
+  size_t len, i, j, stride;
+  uint64_t u, v;
+
+  for (len = 1, stride = n / 2; len < n; len <<= 1, stride >>= 1)
+    for (i = 0; i < n; i += 2 * len)
+      for (j = 0; j < len; j++)
+	{
+	  u = x[i + j];
+	  v = mont_mul (x[i + j + len], w[j * stride], q);
+	  x[i + j] = add_mod (u, v, q->p);
+	  x[i + j + len] = sub_mod (u, v, q->p);
+	}
+}
+
+static void
+load (uint64_t *x, size_t n, const uint64_t *a, size_t an, uint64_t p)
+{
+  size_t i;
+
+  for (i = 0; i < an; i++)
+    x[i] = a[i] % p;
+  memset (x + an, 0, (n - an) * sizeof(uint64_t));
+}
+
+/*
+ * the first rn coefficients of a b modulo q in fa, fb and w are scratch of
+ * n and n / 2 limbs.
+ */
+static void
+convolve (uint64_t *fa, uint64_t *fb, uint64_t *w, size_t n, size_t rn,
+	  const uint64_t *a, size_t an, const uint64_t *b, size_t bn,
+	  const ntt_prime_t *q)
+{
+  size_t i;
+  uint64_t scale;
+  bool square = a == b && an == bn;
+
+  roots (w, n, q);
+
+  load (fa, n, a, an, q->p);
+  forward (fa, n, w, q);
+  if (square)
+    for (i = 0; i < n; i++)
+      fa[i] = mont_mul (fa[i], fa[i], q);
+  else
+    {
+      load (fb, n, b, bn, q->p);
+      forward (fb, n, w, q);
+      for (i = 0; i < n; i++)
+	fa[i] = mont_mul (fa[i], fb[i], q);
+    }
+
+  roots_inverse (w, n, q);
+  inverse (fa, n, w, q);
+
+  // the pointwise products left a factor 2^-64 and the inverse a factor n,
+  // n^-1 = p - (p - 1) / n since n divides p - 1
+  scale = mont_mul (mont_mul (q->p - (q->p - 1) / n, q->r2, q), q->r2, q);
+  for (i = 0; i < rn; i++)
+    fa[i] = mont_mul (fa[i], scale, q);
+}
+
+/*
+ * Garner's CRT of the residues x0, x1, x2 of every coefficient, added up
+ * with the carries into rn limbs.
+ */
+static void
+reconstruct (uint64_t *r, size_t rn, const uint64_t *x0, const uint64_t *x1,
+	     const uint64_t *x2)
+{
+  const ntt_prime_t *q1 = &primes[1], *q2 = &primes[2];
+  uint128_t p0p1 = (uint128_t) primes[0].p * q1->p, t;
+  uint64_t v1, v2, s0, s1, s2, c0, c1;
+  size_t i;
+
+  for (i = 0, c0 = c1 = 0; i < rn; i++)
+    {
+      // x = x0 + p0 v1 + p0 p1 v2 with v1 < p1 and v2 < p2
+      v1 = mont_mul (sub_mod (x1[i], x0[i], q1->p), inv_p0, q1);
+      v2 = add_mod (x0[i], mont_mul (v1, p0_p2, q2), q2->p);
+      v2 = mont_mul (sub_mod (x2[i], v2, q2->p), inv_p0p1, q2);
+
+      t = (uint128_t) x0[i] + (uint128_t) primes[0].p * v1;
+      s0 = (uint64_t) t;
+      s1 = (uint64_t) (t >> 64);
+      t = (uint128_t) (uint64_t) p0p1 * v2;
+      s0 += (uint64_t) t;
+      t = (t >> 64) + (s0 < (uint64_t) t) + s1
+	  + (uint128_t) (uint64_t) (p0p1 >> 64) * v2;
+      s1 = (uint64_t) t;
+      s2 = (uint64_t) (t >> 64);
+
+      // plus the carry of the lower coefficients
+      t = (uint128_t) s0 + c0;
+      r[i] = (uint64_t) t;
+      t = (t >> 64) + s1 + c1;
+      c0 = (uint64_t) t;
+      c1 = (uint64_t) (t >> 64) + s2;
+    }
+  assert(c0 == 0 && c1 == 0);
+}
+
+static size_t
+transform_size (size_t an, size_t bn)
+{
+  size_t n = 1;
+
+  while (n < an + bn)
+    n <<= 1;
+  return n;
+}
+
+size_t
+uintp_mul_ntt_scratch (size_t an, size_t bn)
+{
+  size_t n = transform_size (an, bn);
+
+  return 2 * (an + bn) + 2 * n + n / 2;
+}
+
+void
+uintp_mul_ntt (uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b,
+	       size_t bn, uint64_t *tp)
+{
+  assert(r != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(tp != NULL);
+  assert(an > 0 && bn > 0);
+
+  size_t n, rn = an + bn;
+  uint64_t *x0, *x1, *fa, *fb, *w;
+
+  pthread_once (&primes_once, primes_init);
+
+  n = transform_size (an, bn);
+  assert(n >> NTT_MAX_LOG <= 1);
+
+  x0 = tp;
+  x1 = x0 + rn;
+  fa = x1 + rn;
+  fb = fa + n;
+  w = fb + n;
+
+  convolve (fa, fb, w, n, rn, a, an, b, bn, &primes[0]);
+  memcpy (x0, fa, rn * sizeof(uint64_t));
+  convolve (fa, fb, w, n, rn, a, an, b, bn, &primes[1]);
+  memcpy (x1, fa, rn * sizeof(uint64_t));
+  convolve (fa, fb, w, n, rn, a, an, b, bn, &primes[2]);
+
+  reconstruct (r, rn, x0, x1, fa);
+}
+
+/*
+ * x = B^n + x' with a x < B^2n <= a (x + 2) for a normalized n-limb a,
+ * x has n + 1 limbs. Brent and Zimmermann, Modern Computer Arithmetic,
+ * algorithm 3.5: the reciprocal of the top half, one Newton step on the
+ * full operand, Knuth's division below threshold limbs.
+ */
+static bool
+reciprocal (uint64_t *x, const uint64_t *a, size_t n, size_t threshold)
+{
+  size_t l, h, tn, un;
+  uint64_t *t, *u;
+  bool ok;
+
+  if (n < threshold)
+    {
+      // ceil(B^2n / a) - 1 = floor((B^2n - 1) / a)
+      t = malloc ((2 * n + UINTP_DIVREM_SCRATCH(2 * n, n)) * sizeof(uint64_t));
+      if (t == NULL)
+	return false;
+      memset (t, 0xff, 2 * n * sizeof(uint64_t));
+      uintp_divrem (x, NULL, t, 2 * n, a, n, t + 2 * n);
+      free (t);
+      return true;
+    }
+
+  l = (n - 1) / 2;
+  h = n - l;
+
+  // x_h = B^h + x_h' for the top h limbs, kept in the top of x
+  if (!reciprocal (x + l, a + l, h, threshold))
+    return false;
+
+  t = malloc ((2 * (n + h + 1) + h + 1) * sizeof(uint64_t));
+  if (t == NULL)
+    return false;
+  u = t + n + h + 1;
+
+  // t = a x_h, brought below B^(n + h)
+  ok = uintp_mul_large (t, a, n, x + l, h + 1);
+  while (ok && t[n + h] != 0)
+    {
+      uintp_sub_1 (x + l, x + l, h + 1, 1);
+      uintp_sub_1 (t + n, t + n, h + 1, uintp_sub_n (t, t, a, n));
+    }
+
+  if (ok)
+    {
+      // t = B^(n + h) - t, the error of x_h, and u = floor(t / B^l) x_h
+      for (tn = 0; tn < n + h; tn++)
+	t[tn] = ~t[tn];
+      uintp_add_1 (t, t, n + h, 1);
+      tn = uintp_normalize (t + l, n + h - l);
+
+      if (tn == 0)
+	uintp_zero (x, l);
+      else
+	{
+	  ok = uintp_mul_large (u, t + l, tn, x + l, h + 1);
+	  un = tn + h + 1;
+
+	  // x = x_h B^l + floor(u / B^(2h - l))
+	  uintp_zero (x, l);
+	  if (ok && un > 2 * h - l)
+	    {
+	      un = uintp_normalize (u + 2 * h - l, un - (2 * h - l));
+	      assert(un <= n + 1);
+	      uintp_add_1 (x + un, x + un, n + 1 - un,
+			   uintp_add_n (x, x, u + 2 * h - l, un));
+	    }
+	}
+    }
+
+  free (t);
+  return ok;
+}
+
+bool
+uintp_divrem_large (uint64_t *q, uint64_t *r, const uint64_t *a, size_t an,
+		    const uint64_t *d, size_t dn)
+{
+  assert(a != NULL);
+  assert(d != NULL);
+  assert(dn > 0);
+  assert(an >= dn);
+  assert(d[dn - 1] != 0);
+
+  uintN_tune_t tune;
+  size_t n = dn, blocks, j;
+  unsigned int s;
+  uint64_t *tp, *dd, *aa, *x, *w, *p, *qd, *qq;
+
+  // the quadratic division wins while the quotient or the divisor is short
+  uintN_tune_get (&tune);
+  if (min(dn, an - dn + 1) < tune.ntt_divrem)
+    {
+      tp = malloc (UINTP_DIVREM_SCRATCH(an, dn) * sizeof(uint64_t));
+      if (tp == NULL)
+	return false;
+      uintp_divrem (q, r, a, an, d, dn, tp);
+      free (tp);
+      return true;
+    }
+
+  // the shifted numerator has an + 1 limbs, divided n limbs at a time
+  blocks = (an + n) / n;
+
+  tp = malloc ((n + 2 * blocks * n + (n + 1) + 2 * n + (2 * n + 2)
+      + (2 * n + 1)) * sizeof(uint64_t));
+  if (tp == NULL)
+    return false;
+  dd = tp;
+  aa = dd + n;
+  qq = aa + blocks * n;
+  x = qq + blocks * n;
+  w = x + n + 1;
+  p = w + 2 * n;
+  qd = p + 2 * n + 2;
+
+  // normalize so that the top bit of the divisor is set
+  s = __builtin_clzll (d[n - 1]);
+  uintp_lshift (dd, d, n, s);
+  aa[an] = uintp_lshift (aa, a, an, s);
+  uintp_zero (aa + an + 1, blocks * n - an - 1);
+
+  if (!reciprocal (x, dd, n, tune.ntt_divrem))
+    {
+      free (tp);
+      return false;
+    }
+
+  // w = rem B^n + block < dd B^n, its quotient fits one block
+  uintp_zero (w + n, n);
+  for (j = blocks; j > 0;)
+    {
+      j--;
+      uintp_copy (w, aa + j * n, n);
+
+      // Barrett estimate floor(floor(w / B^(n - 1)) x / B^(n + 1)), at most
+      // a few units short of the quotient
+      if (!uintp_mul_large (p, w + n - 1, n + 1, x, n + 1)
+	  || !uintp_mul_large (qd, p + n + 1, n + 1, dd, n))
+	{
+	  free (tp);
+	  return false;
+	}
+      uintp_sub_n (w, w, qd, 2 * n);
+
+      while (w[n] != 0 || uintp_cmp (w, dd, n) >= 0)
+	{
+	  w[n] -= uintp_sub_n (w, w, dd, n);
+	  uintp_add_1 (p + n + 1, p + n + 1, n + 1, 1);
+	}
+      uintp_copy (w + n, w, n);
+      uintp_copy (qq + j * n, p + n + 1, n);
+    }
+
+  if (q != NULL)
+    uintp_copy (q, qq, an - dn + 1);
+  if (r != NULL)
+    uintp_rshift (r, w + n, n, s);
+
+  free (tp);
+  return true;
+}
+
+bool
+uintp_mul_large (uint64_t *r, const uint64_t *a, size_t an,
+		 const uint64_t *b, size_t bn)
+{
+  assert(r != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+
+  uintN_tune_t tune;
+  size_t n;
+  uint64_t *tp;
+
+  uintN_tune_get (&tune);
+  if (min(an, bn) < tune.ntt_mul)
+    {
+      uintp_mul (r, a, an, b, bn);
+      return true;
+    }
+
+  n = uintp_mul_ntt_scratch (an, bn);
+  tp = malloc (n * sizeof(uint64_t));
+  if (tp == NULL)
+    return false;
+
+  uintp_mul_ntt (r, a, an, b, bn, tp);
+
+  uintN_wipe (tp, n * sizeof(uint64_t));
+  free (tp);
+  return true;
+}
@@ -0,0 +1,98 @@
+/*
+ * ntt.h
+ *
+ * Header file for multiplication of long limb arrays with the number
+ * theoretic transform.
+ *
+ * The operands are read as polynomials with one 64-bit limb per coefficient
+ * and their product is the cyclic convolution of length N, the next power of
+ * two at or above an + bn. The convolution is computed modulo three primes
+ * p = c 2^k + 1 just below 2^62, each with a radix-2 transform in Montgomery
+ * form, and put back together with Garner's CRT. The product of the primes
+ * is above 2^183.7, more than any coefficient N 2^128 of the convolution can
+ * reach for N up to 2^55, so the result is exact.
+ *
+ * The transform costs O(N log N) multiplications against O(an bn) for the
+ * schoolbook uintp_mul, uintp_mul_large switches between the two at the
+ * ntt_mul limbs of the tuning profile. uintp_divrem_large builds division of
+ * long operands on top of it with a Newton reciprocal.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef NTT_H_
+#define NTT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uintN.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* limbs of the shorter operand from which the transform beats uintp_mul,
+ * the default of ntt_mul in the tuning profile */
+#define UINTP_NTT_THRESHOLD 640
+
+/* limbs of divisor and quotient from which Newton division beats Knuth's,
+ * the default of ntt_divrem in the tuning profile */
+#define UINTP_NTT_DIVREM_THRESHOLD 6144
+
+/**
+ * uintp scratch limbs needed by uintp_mul_ntt for an an-limb and a bn-limb
+ * operand.
+ */
+size_t
+uintp_mul_ntt_scratch (size_t an, size_t bn);
+
+/**
+ * uintp full multiplication r = a * b with the number theoretic transform,
+ * r holds an + bn limbs. a equal to b with an equal to bn is a squaring and
+ * transforms only once.
+ * tp is scratch of uintp_mul_ntt_scratch(an, bn) limbs; r must not overlap
+ * a, b or tp.
+ *
+ * The running time of implemented algorithm is O(N log N), N = an + bn.
+ */
+void
+uintp_mul_ntt (uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b,
+	       size_t bn, uint64_t *tp);
+
+/**
+ * uintp full multiplication r = a * b of operands of any length, r holds
+ * an + bn limbs and must not overlap a or b.
+ * uses uintp_mul below ntt_mul limbs of the tuning profile and uintp_mul_ntt
+ * with allocated scratch above.
+ * returns false if the scratch could not be allocated.
+ *
+ * The running time of implemented algorithm is O(min(an bn, N log N)).
+ */
+bool
+uintp_mul_large (uint64_t *r, const uint64_t *a, size_t an,
+		 const uint64_t *b, size_t bn);
+
+/**
+ * uintp division a = q * d + r of operands of any length.
+ * q receives an - dn + 1 limbs (may be NULL), r receives dn limbs (may be
+ * NULL). The top limb of d must be non-zero and an >= dn; q and r must not
+ * overlap a or d.
+ * uses uintp_divrem while the divisor or the quotient is shorter than
+ * ntt_divrem limbs of the tuning profile, above that a Newton reciprocal of d and
+ * Barrett steps of dn limbs each, all on uintp_mul_large.
+ * returns false if the scratch could not be allocated.
+ *
+ * The running time of implemented algorithm is O(an / dn M(dn)), M(dn) the
+ * cost of a dn-limb multiplication.
+ */
+bool
+uintp_divrem_large (uint64_t *q, uint64_t *r, const uint64_t *a, size_t an,
+		    const uint64_t *d, size_t dn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NTT_H_ */
@@ -0,0 +1,455 @@
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "p256.h"
+#include "uintp.h"
+#include "workspace.h"
+
+#define WINDOW_BITS 4
+#define WINDOW_SIZE (1 << WINDOW_BITS)
+#define WINDOWS (256 / WINDOW_BITS)
+
+static const p256_fe_t P =
+  { 0xffffffffffffffff, 0x00000000ffffffff, 0x0000000000000000,
+      0xffffffff00000001 };
+
+static const p256_fe_t B =
+  { 0x3bce3c3e27d2604b, 0x651d06b0cc53b0f6, 0xb3ebbd55769886bc,
+      0x5ac635d8aa3a93e7 };
+
+const p256_affine_t P256_G =
+  {
+    { 0xf4a13945d898c296, 0x77037d812deb33a0, 0xf8bce6e563a440f2,
+	0x6b17d1f2e12c4247 },
+    { 0xcbb6406837bf51f5, 0x2bce33576b315ece, 0x8ee7eb4a7c0f9e16,
+	0x4fe342e2fe1a7f9b } };
+
+/*
+ * r = a if mask is all ones, r unchanged if mask is zero.
+ */
+static void
+fe_cmov (p256_fe_t r, const p256_fe_t a, uint64_t mask)
+{
+  uint16_t i;
+
+  for (i = 0; i < P256_PARTS; i++)
+    r[i] = (r[i] & ~mask) | (a[i] & mask);
+}
+
+/*
+ * all ones if a is zero, zero otherwise.
+ */
+static uint64_t
+fe_iszero_mask (const p256_fe_t a)
+{
+  uint64_t t = a[0] | a[1] | a[2] | a[3];
+
+  return ((t | -t) >> 63) - 1;
+}
+
+/*
+ * r = a - p if that does not borrow, carry being a bit above a.
+ */
+static void
+fe_final_sub (p256_fe_t r, const p256_fe_t a, uint64_t carry)
+{
+  p256_fe_t t;
+  uint64_t borrow;
+
+  borrow = uintp_sub_n (t, a, P, P256_PARTS);
+  uintp_copy (r, a, P256_PARTS);
+  fe_cmov (r, t, -(carry | (borrow ^ 1)));
+}
+
+void
+p256_fe_add (p256_fe_t r, const p256_fe_t a, const p256_fe_t b)
+{
+  p256_fe_t t;
+  uint64_t carry;
+
+  carry = uintp_add_n (t, a, b, P256_PARTS);
+  fe_final_sub (r, t, carry);
+}
+
+void
+p256_fe_sub (p256_fe_t r, const p256_fe_t a, const p256_fe_t b)
+{
+  p256_fe_t t;
+  uint64_t borrow;
+
+  borrow = uintp_sub_n (r, a, b, P256_PARTS);
+  uintp_add_n (t, r, P, P256_PARTS);
+  fe_cmov (r, t, -borrow);
+}
+
+/*
+ * r = t (mod p) for a 512-bit t, FIPS 186-4 D.2.3 on 32-bit words:
+ * r = t + 2 s1 + 2 s2 + s3 + s4 - d1 - d2 - d3 - d4.
+ */
+static void
+fe_reduce (p256_fe_t r, const uint64_t t[2 * P256_PARTS])
+{
+  int64_t c[16], w[8], carry;
+  uint16_t i, k;
+  p256_fe_t s;
+
+  for (i = 0; i < 2 * P256_PARTS; i++)
+    {
+      c[2 * i] = (uint32_t) t[i];
+      c[2 * i + 1] = t[i] >> 32;
+    }
+
+  w[0] = c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14];
+  w[1] = c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15];
+  w[2] = c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+  w[3] = c[3] + 2 * c[11] + 2 * c[12] + c[13] - c[15] - c[8] - c[9];
+  w[4] = c[4] + 2 * c[12] + 2 * c[13] + c[14] - c[9] - c[10];
+  w[5] = c[5] + 2 * c[13] + 2 * c[14] + c[15] - c[10] - c[11];
+  w[6] = c[6] + 2 * c[14] + 2 * c[15] + c[14] + c[13] - c[8] - c[9];
+  w[7] = c[7] + 2 * c[15] + c[15] + c[8] - c[10] - c[11] - c[12] - c[13];
+
+  // fold the word above 2^256 back with 2^256 ≡ 2^224 - 2^192 - 2^96 + 1,
+  // a fixed number of rounds so the running time does not depend on t
+  for (k = 0, carry = 0; k < 3; k++)
+    {
+      w[0] += carry;
+      w[3] -= carry;
+      w[6] -= carry;
+      w[7] += carry;
+
+      for (i = 0, carry = 0; i < 8; i++)
+	{
+	  w[i] += carry;
+	  carry = w[i] >> 32;
+	  w[i] &= 0xffffffff;
+	}
+    }
+  assert(carry == 0);
+
+  for (i = 0; i < P256_PARTS; i++)
+    s[i] = (uint64_t) w[2 * i] | ((uint64_t) w[2 * i + 1] << 32);
+
+  fe_final_sub (r, s, 0);
+}
+
+void
+p256_fe_mul (p256_fe_t r, const p256_fe_t a, const p256_fe_t b)
+{
+  uint64_t t[2 * P256_PARTS];
+
+  uintp_mul (t, a, P256_PARTS, b, P256_PARTS);
+  fe_reduce (r, t);
+}
+
+void
+p256_fe_sqr (p256_fe_t r, const p256_fe_t a)
+{
+  p256_fe_mul (r, a, a);
+}
+
+void
+p256_fe_inv (p256_fe_t r, const p256_fe_t a)
+{
+  p256_fe_t e, x;
+  int16_t i;
+
+  // the exponent p - 2 is public, branching on its bits is fine
+  uintp_copy (e, P, P256_PARTS);
+  e[0] -= 2;
+
+  memset (x, 0, sizeof(x));
+  x[0] = 1;
+  for (i = 255; i >= 0; i--)
+    {
+      p256_fe_sqr (x, x);
+      if ((e[i / 64] >> (i % 64)) & 1)
+	p256_fe_mul (x, x, a);
+    }
+  uintp_copy (r, x, P256_PARTS);
+}
+
+static void
+point_set_infinity (p256_point_t *r)
+{
+  memset (r, 0, sizeof(*r));
+  r->x[0] = 1;
+  r->y[0] = 1;
+}
+
+static void
+point_cmov (p256_point_t *r, const p256_point_t *a, uint64_t mask)
+{
+  fe_cmov (r->x, a->x, mask);
+  fe_cmov (r->y, a->y, mask);
+  fe_cmov (r->z, a->z, mask);
+}
+
+// https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-3.html#doubling-dbl-2001-b
+void
+p256_point_double (p256_point_t *r, const p256_point_t *p)
+{
+  assert(r != NULL);
+  assert(p != NULL);
+
+  p256_fe_t delta, gamma, beta, alpha, t1, t2;
+
+  p256_fe_sqr (delta, p->z);
+  p256_fe_sqr (gamma, p->y);
+  p256_fe_mul (beta, p->x, gamma);
+
+  p256_fe_sub (t1, p->x, delta);
+  p256_fe_add (t2, p->x, delta);
+  p256_fe_mul (alpha, t1, t2);
+  p256_fe_add (t1, alpha, alpha);
+  p256_fe_add (alpha, alpha, t1);
+
+  // Z3 = (Y1 + Z1)^2 - gamma - delta, the last use of p since r may be p
+  p256_fe_add (t1, p->y, p->z);
+  p256_fe_sqr (t1, t1);
+  p256_fe_sub (t1, t1, gamma);
+  p256_fe_sub (r->z, t1, delta);
+
+  // X3 = alpha^2 - 8 beta
+  p256_fe_add (beta, beta, beta);
+  p256_fe_add (beta, beta, beta);
+  p256_fe_sqr (t1, alpha);
+  p256_fe_add (t2, beta, beta);
+  p256_fe_sub (r->x, t1, t2);
+
+  // Y3 = alpha (4 beta - X3) - 8 gamma^2
+  p256_fe_sub (t1, beta, r->x);
+  p256_fe_mul (t1, alpha, t1);
+  p256_fe_sqr (gamma, gamma);
+  p256_fe_add (gamma, gamma, gamma);
+  p256_fe_add (gamma, gamma, gamma);
+  p256_fe_add (gamma, gamma, gamma);
+  p256_fe_sub (r->y, t1, gamma);
+}
+
+// https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian-3.html#addition-add-2007-bl
+void
+p256_point_add (p256_point_t *r, const p256_point_t *p, const p256_point_t *q)
+{
+  assert(r != NULL);
+  assert(p != NULL);
+  assert(q != NULL);
+
+  p256_fe_t z1z1, z2z2, u1, u2, s1, s2, h, i, j, rr, v, t;
+  p256_point_t res;
+  uint64_t pinf, qinf;
+
+  pinf = fe_iszero_mask (p->z);
+  qinf = fe_iszero_mask (q->z);
+
+  p256_fe_sqr (z1z1, p->z);
+  p256_fe_sqr (z2z2, q->z);
+  p256_fe_mul (u1, p->x, z2z2);
+  p256_fe_mul (u2, q->x, z1z1);
+  p256_fe_mul (s1, p->y, q->z);
+  p256_fe_mul (s1, s1, z2z2);
+  p256_fe_mul (s2, q->y, p->z);
+  p256_fe_mul (s2, s2, z1z1);
+
+  p256_fe_sub (h, u2, u1);
+  p256_fe_sub (rr, s2, s1);
+
+  // p == q, only reachable with negligible probability from the scalar
+  // multiplications, so it may take a different path
+  if ((fe_iszero_mask (h) & fe_iszero_mask (rr) & ~pinf & ~qinf) != 0)
+    {
+      p256_point_double (r, p);
+      return;
+    }
+
+  p256_fe_add (i, h, h);
+  p256_fe_sqr (i, i);
+  p256_fe_mul (j, h, i);
+  p256_fe_add (rr, rr, rr);
+  p256_fe_mul (v, u1, i);
+
+  // X3 = r^2 - J - 2 V
+  p256_fe_sqr (res.x, rr);
+  p256_fe_sub (res.x, res.x, j);
+  p256_fe_sub (res.x, res.x, v);
+  p256_fe_sub (res.x, res.x, v);
+
+  // Y3 = r (V - X3) - 2 S1 J
+  p256_fe_sub (t, v, res.x);
+  p256_fe_mul (t, rr, t);
+  p256_fe_mul (s1, s1, j);
+  p256_fe_add (s1, s1, s1);
+  p256_fe_sub (res.y, t, s1);
+
+  // Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) H
+  p256_fe_add (t, p->z, q->z);
+  p256_fe_sqr (t, t);
+  p256_fe_sub (t, t, z1z1);
+  p256_fe_sub (t, t, z2z2);
+  p256_fe_mul (res.z, t, h);
+
+  point_cmov (&res, q, pinf);
+  point_cmov (&res, p, qinf);
+  *r = res;
+}
+
+bool
+p256_point_to_affine (p256_affine_t *r, const p256_point_t *p)
+{
+  assert(r != NULL);
+  assert(p != NULL);
+
+  p256_fe_t zinv, zinv2;
+
+  if (fe_iszero_mask (p->z))
+    return false;
+
+  p256_fe_inv (zinv, p->z);
+  p256_fe_sqr (zinv2, zinv);
+  p256_fe_mul (r->x, p->x, zinv2);
+  p256_fe_mul (zinv2, zinv2, zinv);
+  p256_fe_mul (r->y, p->y, zinv2);
+
+  return true;
+}
+
+void
+p256_point_from_affine (p256_point_t *r, const p256_affine_t *p)
+{
+  assert(r != NULL);
+  assert(p != NULL);
+
+  uintp_copy (r->x, p->x, P256_PARTS);
+  uintp_copy (r->y, p->y, P256_PARTS);
+  memset (r->z, 0, sizeof(r->z));
+  r->z[0] = 1;
+}
+
+bool
+p256_is_on_curve (const p256_affine_t *p)
+{
+  assert(p != NULL);
+
+  p256_fe_t lhs, rhs, t;
+
+  if (uintp_cmp (p->x, P, P256_PARTS) >= 0
+      || uintp_cmp (p->y, P, P256_PARTS) >= 0)
+    return false;
+
+  p256_fe_sqr (lhs, p->y);
+
+  p256_fe_sqr (rhs, p->x);
+  p256_fe_mul (rhs, rhs, p->x);
+  p256_fe_add (t, p->x, p->x);
+  p256_fe_add (t, t, p->x);
+  p256_fe_sub (rhs, rhs, t);
+  p256_fe_add (rhs, rhs, B);
+
+  return uintp_cmp (lhs, rhs, P256_PARTS) == 0;
+}
+
+/*
+ * r = table[d] without an access pattern depending on d.
+ */
+static void
+lookup (const p256_point_t *table, unsigned int d, p256_point_t *r)
+{
+  unsigned int i;
+
+  memset (r, 0, sizeof(*r));
+  for (i = 0; i < WINDOW_SIZE; i++)
+    point_cmov (r, &table[i], -(((uint64_t) (i ^ d) - 1) >> 63));
+}
+
+static unsigned int
+window (const uintN_t *k, unsigned int i)
+{
+  return (k->parts[i * WINDOW_BITS / 64] >> (i * WINDOW_BITS % 64))
+      & (WINDOW_SIZE - 1);
+}
+
+bool
+p256_point_mul (p256_affine_t *r, const uintN_t *k, const p256_affine_t *p)
+{
+  assert(r != NULL);
+  assert(k != NULL);
+  assert(p != NULL);
+
+  p256_point_t table[WINDOW_SIZE], acc, t;
+  unsigned int i, j;
+  bool ok;
+
+  // table[i] = i p
+  point_set_infinity (&table[0]);
+  p256_point_from_affine (&table[1], p);
+  p256_point_double (&table[2], &table[1]);
+  for (i = 3; i < WINDOW_SIZE; i++)
+    p256_point_add (&table[i], &table[i - 1], &table[1]);
+
+  point_set_infinity (&acc);
+  for (i = WINDOWS; i > 0;)
+    {
+      i--;
+      for (j = 0; j < WINDOW_BITS; j++)
+	p256_point_double (&acc, &acc);
+      lookup (table, window (k, i), &t);
+      p256_point_add (&acc, &acc, &t);
+    }
+
+  ok = p256_point_to_affine (r, &acc);
+
+  uintN_wipe (table, sizeof(table));
+  uintN_wipe (&acc, sizeof(acc));
+  uintN_wipe (&t, sizeof(t));
+
+  return ok;
+}
+
+/* base_table[i][j] = j 16^i G */
+static p256_point_t base_table[WINDOWS][WINDOW_SIZE];
+static pthread_once_t base_once = PTHREAD_ONCE_INIT;
+
+static void
+base_table_init (void)
+{
+  p256_point_t b;
+  unsigned int i, j;
+
+  p256_point_from_affine (&b, &P256_G);
+  for (i = 0; i < WINDOWS; i++)
+    {
+      point_set_infinity (&base_table[i][0]);
+      base_table[i][1] = b;
+      p256_point_double (&base_table[i][2], &b);
+      for (j = 3; j < WINDOW_SIZE; j++)
+	p256_point_add (&base_table[i][j], &base_table[i][j - 1], &b);
+      p256_point_add (&b, &base_table[i][WINDOW_SIZE - 1], &b);
+    }
+}
+
+bool
+p256_point_mul_base (p256_affine_t *r, const uintN_t *k)
+{
+  assert(r != NULL);
+  assert(k != NULL);
+
+  p256_point_t acc, t;
+  unsigned int i;
+  bool ok;
+
+  pthread_once (&base_once, base_table_init);
+
+  point_set_infinity (&acc);
+  for (i = 0; i < WINDOWS; i++)
+    {
+      lookup (base_table[i], window (k, i), &t);
+      p256_point_add (&acc, &acc, &t);
+    }
+
+  ok = p256_point_to_affine (r, &acc);
+
+  uintN_wipe (&acc, sizeof(acc));
+  uintN_wipe (&t, sizeof(t));
+
+  return ok;
+}
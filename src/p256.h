@@ -0,0 +1,134 @@
+/*
+ * p256.h
+ *
+ * Header file for the NIST P-256 elliptic curve (FIPS 186-4, D.1.2.3).
+ *
+ * Field elements are 4 limbs of the uintN_t representation, least
+ * significant first, always fully reduced below p. Multiplication uses the
+ * special form of p = 2^256 - 2^224 + 2^192 + 2^96 - 1 and folds the
+ * 512-bit product back with a handful of word additions (FIPS 186-4, D.2.3)
+ * instead of a division or Montgomery step.
+ *
+ * Points are kept in Jacobian coordinates (X : Y : Z), the affine point
+ * being (X / Z^2, Y / Z^3). Scalar multiplication use a fixed 4-bit window
+ * with constant-time table lookups. Multiples of the generator go through a
+ * table of j 16^i G built once on first use, which removes all doublings.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef P256_H_
+#define P256_H_
+
+#include "uintN.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+#define P256_PARTS 4
+
+typedef uint64_t p256_fe_t[P256_PARTS];
+
+typedef struct
+{
+  p256_fe_t x;
+  p256_fe_t y;
+} p256_affine_t;
+
+typedef struct
+{
+  p256_fe_t x;
+  p256_fe_t y;
+  p256_fe_t z;
+} p256_point_t;
+
+/**
+ * field addition r = a + b (mod p).
+ */
+void
+p256_fe_add (p256_fe_t r, const p256_fe_t a, const p256_fe_t b);
+
+/**
+ * field subtraction r = a - b (mod p).
+ */
+void
+p256_fe_sub (p256_fe_t r, const p256_fe_t a, const p256_fe_t b);
+
+/**
+ * field multiplication r = a * b (mod p), with special-form reduction.
+ */
+void
+p256_fe_mul (p256_fe_t r, const p256_fe_t a, const p256_fe_t b);
+
+/**
+ * field squaring r = a ^ 2 (mod p).
+ */
+void
+p256_fe_sqr (p256_fe_t r, const p256_fe_t a);
+
+/**
+ * field inversion r = a ^ -1 (mod p) as a ^ (p - 2), in constant time.
+ * the inverse of zero is zero.
+ */
+void
+p256_fe_inv (p256_fe_t r, const p256_fe_t a);
+
+/**
+ * point doubling r = 2 p.
+ */
+void
+p256_point_double (p256_point_t *r, const p256_point_t *p);
+
+/**
+ * point addition r = p + q, either may be the point at infinity (Z = 0).
+ */
+void
+p256_point_add (p256_point_t *r, const p256_point_t *p, const p256_point_t *q);
+
+/**
+ * point conversion to affine coordinates.
+ * returns false for the point at infinity.
+ */
+bool
+p256_point_to_affine (p256_affine_t *r, const p256_point_t *p);
+
+/**
+ * point conversion from affine coordinates.
+ */
+void
+p256_point_from_affine (p256_point_t *r, const p256_affine_t *p);
+
+/**
+ * point check y^2 = x^3 - 3x + b with both coordinates below p.
+ */
+bool
+p256_is_on_curve (const p256_affine_t *p);
+
+/**
+ * scalar multiplication r = k p, the low 256 bits of k are used.
+ * the running time does not depend on k.
+ * returns false if the result is the point at infinity.
+ */
+bool
+p256_point_mul (p256_affine_t *r, const uintN_t *k, const p256_affine_t *p);
+
+/**
+ * scalar multiplication by the generator r = k G, using the precomputed
+ * table. the running time does not depend on k.
+ * returns false if the result is the point at infinity.
+ */
+bool
+p256_point_mul_base (p256_affine_t *r, const uintN_t *k);
+
+/**
+ * the generator G.
+ */
+extern const p256_affine_t P256_G;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* P256_H_ */
@@ -0,0 +1,321 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+#include "random.h"
+#include "uintp.h"
+#include "workspace.h"
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define QUARTERROUND(a, b, c, d) \
+  do \
+    { \
+      a += b; d ^= a; d = ROTL32(d, 16); \
+      c += d; b ^= c; b = ROTL32(b, 12); \
+      a += b; d ^= a; d = ROTL32(d, 8); \
+      c += d; b ^= c; b = ROTL32(b, 7); \
+    } \
+  while (0)
+
+/* bumped in the child after fork(), generators compare it to reseed */
+static unsigned int forks;
+static pthread_once_t forks_once = PTHREAD_ONCE_INIT;
+
+static void
+forks_child (void)
+{
+  forks++;
+}
+
+static void
+forks_register (void)
+{
+  pthread_atfork (NULL, NULL, forks_child);
+}
+
+static uint32_t
+load32 (const uint8_t *p)
+{
+  return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16
+      | (uint32_t) p[3] << 24;
+}
+
+static void
+store32 (uint8_t *p, uint32_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+/*
+ * one 64-byte ChaCha20 block for the key, a 64-bit block counter and a zero
+ * nonce.
+ */
+static void
+chacha20_block (const uint32_t *key, uint64_t counter, uint8_t *out)
+{
+  uint32_t s[16], x[16];
+  unsigned int i;
+
+  // "expand 32-byte k"
+  s[0] = 0x61707865;
+  s[1] = 0x3320646e;
+  s[2] = 0x79622d32;
+  s[3] = 0x6b206574;
+  memcpy (s + 4, key, 8 * sizeof(uint32_t));
+  s[12] = (uint32_t) counter;
+  s[13] = (uint32_t) (counter >> 32);
+  s[14] = 0;
+  s[15] = 0;
+
+  memcpy (x, s, sizeof(x));
+  for (i = 0; i < 10; i++)
+    {
+      QUARTERROUND(x[0], x[4], x[8], x[12]);
+      QUARTERROUND(x[1], x[5], x[9], x[13]);
+      QUARTERROUND(x[2], x[6], x[10], x[14]);
+      QUARTERROUND(x[3], x[7], x[11], x[15]);
+      QUARTERROUND(x[0], x[5], x[10], x[15]);
+      QUARTERROUND(x[1], x[6], x[11], x[12]);
+      QUARTERROUND(x[2], x[7], x[8], x[13]);
+      QUARTERROUND(x[3], x[4], x[9], x[14]);
+    }
+
+  for (i = 0; i < 16; i++)
+    store32 (out + 4 * i, x[i] + s[i]);
+
+  uintN_wipe (x, sizeof(x));
+  uintN_wipe (s, sizeof(s));
+}
+
+static bool
+get_seed (uint8_t *seed, size_t n)
+{
+  ssize_t ret;
+
+  while (n > 0)
+    {
+      ret = getrandom (seed, n, 0);
+      if (ret < 0 && errno == EINTR)
+	continue;
+      if (ret <= 0)
+	return false;
+      seed += ret;
+      n -= ret;
+    }
+  return true;
+}
+
+/*
+ * new key stream, the first 32 bytes become the next key and are wiped.
+ */
+static void
+refill (uintN_rng_t *rng)
+{
+  uint8_t fresh[32];
+  unsigned int i;
+
+  if (rng->reseed
+      && (rng->count >= UINTN_RNG_RESEED || rng->forks != forks))
+    {
+      if (!get_seed (fresh, sizeof(fresh)))
+	{
+	  printf ("failed to reseed the random generator\n");
+	  abort ();
+	}
+      for (i = 0; i < 8; i++)
+	rng->key[i] ^= load32 (fresh + 4 * i);
+      uintN_wipe (fresh, sizeof(fresh));
+
+      rng->count = 0;
+      rng->forks = forks;
+    }
+
+  for (i = 0; i < UINTN_RNG_BLOCKS; i++)
+    chacha20_block (rng->key, i, rng->buf + 64 * i);
+
+  for (i = 0; i < 8; i++)
+    rng->key[i] = load32 (rng->buf + 4 * i);
+  uintN_wipe (rng->buf, 32);
+  rng->pos = 32;
+}
+
+bool
+uintN_rng_init (uintN_rng_t *rng)
+{
+  assert(rng != NULL);
+
+  uint8_t seed[32];
+
+  pthread_once (&forks_once, forks_register);
+
+  if (!get_seed (seed, sizeof(seed)))
+    return false;
+
+  uintN_rng_seed (rng, seed);
+  uintN_wipe (seed, sizeof(seed));
+
+  rng->reseed = true;
+  rng->forks = forks;
+  return true;
+}
+
+void
+uintN_rng_seed (uintN_rng_t *rng, const uint8_t *seed)
+{
+  assert(rng != NULL);
+  assert(seed != NULL);
+
+  unsigned int i;
+
+  memset (rng, 0, sizeof(*rng));
+  for (i = 0; i < 8; i++)
+    rng->key[i] = load32 (seed + 4 * i);
+  rng->pos = sizeof(rng->buf);
+  rng->reseed = false;
+}
+
+void
+uintN_rng_zeroize (uintN_rng_t *rng)
+{
+  assert(rng != NULL);
+
+  uintN_wipe (rng, sizeof(*rng));
+}
+
+void
+uintN_rng_bytes (uintN_rng_t *rng, void *out, size_t n)
+{
+  assert(rng != NULL);
+  assert(out != NULL || n == 0);
+
+  uint8_t *p = out;
+  size_t k;
+
+  while (n > 0)
+    {
+      // the buffer of the parent must not be handed out again in a child
+      if (rng->pos == sizeof(rng->buf)
+	  || (rng->reseed && rng->forks != forks))
+	refill (rng);
+
+      k = min(n, sizeof(rng->buf) - rng->pos);
+      memcpy (p, rng->buf + rng->pos, k);
+      uintN_wipe (rng->buf + rng->pos, k);
+
+      rng->pos += k;
+      rng->count += k;
+      p += k;
+      n -= k;
+    }
+}
+
+static pthread_key_t thread_key;
+static pthread_once_t thread_once = PTHREAD_ONCE_INIT;
+static __thread uintN_rng_t thread_rng;
+
+static void
+thread_rng_destroy (void *rng)
+{
+  uintN_rng_zeroize (rng);
+}
+
+static void
+thread_key_create (void)
+{
+  pthread_key_create (&thread_key, thread_rng_destroy);
+}
+
+uintN_rng_t *
+uintN_rng_thread (void)
+{
+  if (thread_rng.reseed)
+    return &thread_rng;
+
+  pthread_once (&thread_once, thread_key_create);
+
+  if (!uintN_rng_init (&thread_rng))
+    {
+      printf ("failed to seed the thread random generator\n");
+      abort ();
+    }
+  pthread_setspecific (thread_key, &thread_rng);
+
+  return &thread_rng;
+}
+
+static size_t
+bit_length (const uint64_t *a, size_t n)
+{
+  n = uintp_normalize (a, n);
+  if (n == 0)
+    return 0;
+  return n * PART_SIZE_BITS - __builtin_clzll (a[n - 1]);
+}
+
+void
+uintN_random_bits_rng (uintN_t *r, size_t bits, uintN_rng_t *rng)
+{
+  assert(r != NULL);
+  assert(rng != NULL);
+  assert(bits <= NUMBER_OF_BITS);
+
+  size_t n = (bits + PART_SIZE_BITS - 1) / PART_SIZE_BITS;
+
+  uintN_rng_bytes (rng, r->parts, n * sizeof(uint64_t));
+  uintp_zero (r->parts + n, NUMBER_OF_PARTS - n);
+  if (bits % PART_SIZE_BITS != 0)
+    r->parts[n - 1] &= (1ull << (bits % PART_SIZE_BITS)) - 1;
+}
+
+void
+uintN_random_bits (uintN_t *r, size_t bits)
+{
+  uintN_random_bits_rng (r, bits, uintN_rng_thread ());
+}
+
+void
+uintN_random_fill_rng (uintN_t *r, size_t k, const uintN_t *m,
+		       uintN_rng_t *rng)
+{
+  assert(r != NULL || k == 0);
+  assert(m != NULL);
+  assert(rng != NULL);
+
+  size_t i, n, bits;
+
+  n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+  bits = bit_length (m->parts, n);
+  assert(bits > 0);
+
+  // rejection keeps the values uniform, each draw succeeds with p > 1/2
+  for (i = 0; i < k; i++)
+    do
+      uintN_random_bits_rng (&r[i], bits, rng);
+    while (uintp_cmp (r[i].parts, m->parts, n) >= 0);
+}
+
+void
+uintN_random_fill (uintN_t *r, size_t k, const uintN_t *m)
+{
+  uintN_random_fill_rng (r, k, m, uintN_rng_thread ());
+}
+
+void
+uintN_random_below_rng (uintN_t *r, const uintN_t *m, uintN_rng_t *rng)
+{
+  uintN_random_fill_rng (r, 1, m, rng);
+}
+
+void
+uintN_random_below (uintN_t *r, const uintN_t *m)
+{
+  uintN_random_fill_rng (r, 1, m, uintN_rng_thread ());
+}
@@ -0,0 +1,129 @@
+/*
+ * random.h
+ *
+ * Header file for the ChaCha20 random generator producing uintN values.
+ *
+ * The generator keeps a 256-bit ChaCha20 key and produces UINTN_RNG_BLOCKS
+ * blocks of key stream at a time. The first 32 bytes of every refill
+ * replace the key and the rest is handed out and wiped as it goes (fast key
+ * erasure), so a later state compromise does not reveal earlier output.
+ * The key is seeded from getrandom(), mixed with fresh getrandom() output
+ * every UINTN_RNG_RESEED bytes and reseeded in the child after a fork.
+ *
+ * Each thread has its own generator, the uintN_random_* functions use it
+ * and the _rng variants take an explicit one. Random values are written
+ * straight into the limbs, uintN_random_below draws bit_length(m) bits and
+ * retries until the value is below m, which is unbiased and needs less
+ * than two draws on average.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <stddef.h>
+
+#include "uintN.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* ChaCha20 blocks of 64 bytes generated per refill */
+#define UINTN_RNG_BLOCKS 8
+
+/* bytes handed out between two reseeds */
+#define UINTN_RNG_RESEED (1ul << 20)
+
+typedef struct
+{
+  uint32_t key[8];
+  uint8_t buf[64 * UINTN_RNG_BLOCKS];
+  size_t pos;
+  size_t count;
+  unsigned int forks;
+  bool reseed;
+} uintN_rng_t;
+
+/**
+ * rng init seeded from getrandom().
+ * returns false if the kernel has no randomness to give.
+ */
+bool
+uintN_rng_init (uintN_rng_t *rng);
+
+/**
+ * rng init from a fixed 32-byte seed, reproducible output for tests.
+ * the generator is never reseeded.
+ */
+void
+uintN_rng_seed (uintN_rng_t *rng, const uint8_t *seed);
+
+/**
+ * rng wipe the state.
+ */
+void
+uintN_rng_zeroize (uintN_rng_t *rng);
+
+/**
+ * rng n random bytes.
+ */
+void
+uintN_rng_bytes (uintN_rng_t *rng, void *out, size_t n);
+
+/**
+ * rng the generator of the calling thread, seeded on first use.
+ */
+uintN_rng_t *
+uintN_rng_thread (void);
+
+/**
+ * uintN random value of at most bits bits, uniform in [0, 2^bits).
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintN_random_bits (uintN_t *r, size_t bits);
+
+/**
+ * uintN random value of at most bits bits using the generator rng.
+ */
+void
+uintN_random_bits_rng (uintN_t *r, size_t bits, uintN_rng_t *rng);
+
+/**
+ * uintN random value uniform in [0, m), m must not be zero.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintN_random_below (uintN_t *r, const uintN_t *m);
+
+/**
+ * uintN random value uniform in [0, m) using the generator rng.
+ */
+void
+uintN_random_below_rng (uintN_t *r, const uintN_t *m, uintN_rng_t *rng);
+
+/**
+ * uintN fill k values uniform in [0, m), m must not be zero.
+ *
+ * The running time of implemented algorithm is O(k n).
+ */
+void
+uintN_random_fill (uintN_t *r, size_t k, const uintN_t *m);
+
+/**
+ * uintN fill k values uniform in [0, m) using the generator rng.
+ */
+void
+uintN_random_fill_rng (uintN_t *r, size_t k, const uintN_t *m,
+		       uintN_rng_t *rng);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RANDOM_H_ */
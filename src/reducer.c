@@ -0,0 +1,342 @@
+#include <assert.h>
+#include <string.h>
+
+#include "reducer.h"
+#include "uintp.h"
+#include "tune.h"
+
+static size_t
+bit_length (const uint64_t *a, size_t n)
+{
+  n = uintp_normalize (a, n);
+  if (n == 0)
+    return 0;
+  return n * PART_SIZE_BITS - __builtin_clzll (a[n - 1]);
+}
+
+/*
+ * non-adjacent form of d, digit +-(e + 1) stands for +-2^e.
+ * returns false if d has more than UINTN_SOLINAS_TERMS non-zero digits.
+ */
+static bool
+solinas_digits (uintN_reducer_t *red)
+{
+  uintN_t d;
+  size_t e;
+
+  uintN_set (&d, red->d.parts);
+  red->terms = 0;
+
+  for (e = 0; !uintN_iszero (&d); e++)
+    {
+      if (uintN_isodd (&d))
+	{
+	  if (red->terms == UINTN_SOLINAS_TERMS)
+	    return false;
+
+	  // digit is 2 - (d mod 4), so that d - digit is divisible by 4
+	  if ((d.parts[0] & 0x03) == 0x01)
+	    {
+	      red->digits[red->terms++] = e + 1;
+	      uintp_sub_1 (d.parts, d.parts, NUMBER_OF_PARTS, 1);
+	    }
+	  else
+	    {
+	      red->digits[red->terms++] = -(int16_t) (e + 1);
+	      uintp_add_1 (d.parts, d.parts, NUMBER_OF_PARTS, 1);
+	    }
+	}
+      uintp_rshift (d.parts, d.parts, NUMBER_OF_PARTS, 1);
+    }
+  return true;
+}
+
+bool
+uintN_reducer_init (uintN_reducer_t *red, const uintN_t *m)
+{
+  assert(red != NULL);
+  assert(m != NULL);
+  assert(!uintN_iszero (m));
+
+  size_t dk;
+
+  memset (red, 0, sizeof(*red));
+  uintN_set (&red->m, m->parts);
+  red->n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+  red->k = bit_length (m->parts, red->n);
+  red->form = UINTN_FORM_GENERIC;
+
+  // too short to gain anything over a single-limb division
+  if (red->n < 2)
+    return false;
+
+  // d = 2^k - m
+  uintp_zero (red->d.parts, NUMBER_OF_PARTS);
+  uintp_sub_n (red->d.parts, red->d.parts, m->parts, red->n);
+  if (red->k % PART_SIZE_BITS != 0)
+    red->d.parts[red->n - 1] &= (1ull << (red->k % PART_SIZE_BITS)) - 1;
+
+  // each folding pass must take off about half of a double-width product,
+  // and at least a limb of it for a short m
+  red->dn = uintp_normalize (red->d.parts, red->n);
+  dk = bit_length (red->d.parts, red->n);
+  if (2 * dk <= red->k + PART_SIZE_BITS && dk + PART_SIZE_BITS <= red->k)
+    {
+      if (red->dn <= 1)
+	red->form = UINTN_FORM_PSEUDO_MERSENNE;
+      else if (solinas_digits (red))
+	red->form = UINTN_FORM_SOLINAS;
+    }
+
+  if (red->form == UINTN_FORM_GENERIC && m->parts[red->n - 1] == ~0ull)
+    red->form = UINTN_FORM_TOP_ONES;
+
+  return red->form != UINTN_FORM_GENERIC;
+}
+
+bool
+uintN_reducer_maybe (const uintN_t *m)
+{
+  assert(m != NULL);
+
+  size_t n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+  unsigned int s;
+  uint64_t top;
+
+  if (n < 2)
+    return false;
+
+  // d = 2^k - m below 2^(k - 64) leaves ones in bits k - 1 to k - 64
+  s = __builtin_clzll (m->parts[n - 1]);
+  top = m->parts[n - 1] << s;
+  if (s != 0)
+    top |= m->parts[n - 2] >> (PART_SIZE_BITS - s);
+  return top == ~0ull;
+}
+
+/*
+ * t = hi d for the Solinas digits, t has tn limbs and wraps around while the
+ * negative digits are subtracted, the final value is non-negative.
+ * s is scratch of hn + 1 limbs.
+ */
+static void
+solinas_mul (const uintN_reducer_t *red, uint64_t *t, size_t tn,
+	     const uint64_t *hi, size_t hn, uint64_t *s)
+{
+  uint8_t i;
+  size_t e, off, sn;
+  uint64_t c;
+
+  uintp_zero (t, tn);
+  for (i = 0; i < red->terms; i++)
+    {
+      e = (red->digits[i] > 0 ? red->digits[i] : -red->digits[i]) - 1;
+      off = e / PART_SIZE_BITS;
+      sn = hn + 1;
+
+      s[hn] = uintp_lshift (s, hi, hn, e % PART_SIZE_BITS);
+
+      if (red->digits[i] > 0)
+	{
+	  c = uintp_add_n (t + off, t + off, s, sn);
+	  uintp_add_1 (t + off + sn, t + off + sn, tn - off - sn, c);
+	}
+      else
+	{
+	  c = uintp_sub_n (t + off, t + off, s, sn);
+	  uintp_sub_1 (t + off + sn, t + off + sn, tn - off - sn, c);
+	}
+    }
+}
+
+/*
+ * x = lo + hi d until x < 2^k, x has room for xn limbs.
+ */
+static void
+fold_bits (const uintN_reducer_t *red, uint64_t *x, size_t xn, uintN_ws_t *ws)
+{
+  size_t kl, kb, hn, tn, dn;
+  uint64_t c;
+
+  kl = red->k / PART_SIZE_BITS;
+  kb = red->k % PART_SIZE_BITS;
+  dn = red->dn + 1;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *hi = uintN_ws_alloc (ws, xn);
+  uint64_t *t = uintN_ws_alloc (ws, xn + dn + 1);
+  uint64_t *s = uintN_ws_alloc (ws, xn + 1);
+
+  while (bit_length (x, xn) > red->k)
+    {
+      xn = uintp_normalize (x, xn);
+
+      // hi = x >> k, lo = x mod 2^k
+      hn = xn - kl;
+      uintp_rshift (hi, x + kl, hn, kb);
+      hn = uintp_normalize (hi, hn);
+      if (kb != 0)
+	{
+	  x[kl] &= (1ull << kb) - 1;
+	  uintp_zero (x + kl + 1, xn - kl - 1);
+	}
+      else
+	uintp_zero (x + kl, xn - kl);
+
+      // hi d < x, so the sum fits where x was
+      if (red->form == UINTN_FORM_PSEUDO_MERSENNE)
+	{
+	  c = uintp_addmul_1 (x, hi, hn, red->d.parts[0]);
+	  uintp_add_1 (x + hn, x + hn, xn - hn, c);
+	  continue;
+	}
+
+      tn = hn + dn + 1;
+      solinas_mul (red, t, tn, hi, hn, s);
+      tn = uintp_normalize (t, tn);
+
+      assert(tn <= xn);
+      if (uintp_add_n (x, x, t, tn))
+	uintp_add_1 (x + tn, x + tn, xn - tn, 1);
+    }
+
+  uintN_ws_release (ws, mark);
+}
+
+/*
+ * x = x (mod 2^k) folding one limb at a time, for the top ones form.
+ */
+static void
+fold_limbs (const uintN_reducer_t *red, uint64_t *x, size_t xn)
+{
+  size_t j, n, dn;
+  uint64_t q, c;
+
+  n = red->n;
+  dn = red->dn;
+
+  for (xn = uintp_normalize (x, xn); xn > n; xn = uintp_normalize (x, xn))
+    for (j = xn - 1; j >= n; j--)
+      {
+	// x[j] 2^(64 j) ≡ x[j] d 2^(64 (j - n))
+	q = x[j];
+	x[j] = 0;
+	c = uintp_addmul_1 (x + j - n, red->d.parts, dn, q);
+	uintp_add_1 (x + j - n + dn, x + j - n + dn, xn - (j - n + dn), c);
+
+	// the carry out of x[j - 1] comes back as a single bit
+	while (x[j] != 0)
+	  {
+	    x[j] = 0;
+	    c = uintp_add_n (x + j - n, x + j - n, red->d.parts, dn);
+	    uintp_add_1 (x + j - n + dn, x + j - n + dn, xn - (j - n + dn), c);
+	  }
+      }
+}
+
+void
+uintN_reducer_reduce (const uintN_reducer_t *red, uint64_t *r,
+		      const uint64_t *t, size_t tn, uintN_ws_t *ws)
+{
+  assert(red != NULL);
+  assert(red->form != UINTN_FORM_GENERIC);
+  assert(r != NULL);
+  assert(t != NULL);
+  assert(ws != NULL);
+
+  size_t xn, n;
+
+  n = red->n;
+  xn = max(tn, n) + 1;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *x = uintN_ws_alloc (ws, xn);
+
+  uintp_copy (x, t, tn);
+  uintp_zero (x + tn, xn - tn);
+
+  if (red->form == UINTN_FORM_TOP_ONES)
+    fold_limbs (red, x, xn);
+  else
+    fold_bits (red, x, xn, ws);
+
+  // x < 2^k < 2 m
+  if (uintp_normalize (x + n, xn - n) != 0
+      || uintp_cmp (x, red->m.parts, n) >= 0)
+    uintp_sub_n (x, x, red->m.parts, n);
+  uintp_copy (r, x, n);
+
+  uintN_ws_release (ws, mark);
+}
+
+static unsigned int
+get_bits (const uint64_t *a, size_t pos, unsigned int w)
+{
+  size_t i = pos / PART_SIZE_BITS, s = pos % PART_SIZE_BITS;
+  uint64_t v = a[i] >> s;
+
+  if (s + w > PART_SIZE_BITS && i + 1 < NUMBER_OF_PARTS)
+    v |= a[i + 1] << (PART_SIZE_BITS - s);
+  return v & ((1u << w) - 1);
+}
+
+/*
+ * r = a b (mod m) for n-limb a and b, tp is scratch of 2n limbs.
+ */
+static void
+mulred (const uintN_reducer_t *red, uint64_t *r, const uint64_t *a,
+	const uint64_t *b, uint64_t *tp, uintN_ws_t *ws)
+{
+  uintp_mul (tp, a, red->n, b, red->n);
+  uintN_reducer_reduce (red, r, tp, 2 * red->n, ws);
+}
+
+void
+uintN_reducer_modp (const uintN_reducer_t *red, const uintN_t *base,
+		    const uintN_t *exp, uintN_t *dest, uintN_ws_t *ws)
+{
+  assert(red != NULL);
+  assert(base != NULL);
+  assert(exp != NULL);
+  assert(dest != NULL);
+  assert(ws != NULL);
+
+  size_t bits, pos, n, i;
+  unsigned int w, d;
+
+  n = red->n;
+  bits = bit_length (exp->parts, NUMBER_OF_PARTS);
+  w = uintN_tune_window (bits);
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, 2 * n);
+  uint64_t *table = uintN_ws_alloc (ws, (1u << w) * n);
+  uint64_t *acc = uintN_ws_alloc (ws, n);
+
+  // table[i] = base^i (mod m)
+  uintp_zero (table, n);
+  table[0] = 1;
+  uintN_reducer_reduce (red, table + n, base->parts, NUMBER_OF_PARTS, ws);
+  for (i = 2; i < (1u << w); i++)
+    mulred (red, table + i * n, table + (i - 1) * n, table + n, tp, ws);
+
+  uintp_copy (acc, table, n);
+
+  pos = (bits + w - 1) / w * w;
+  while (pos > 0)
+    {
+      if (pos < bits)
+	for (i = 0; i < w; i++)
+	  mulred (red, acc, acc, acc, tp, ws);
+      pos -= w;
+
+      d = get_bits (exp->parts, pos, w);
+      if (d != 0)
+	mulred (red, acc, acc, table + d * n, tp, ws);
+    }
+
+  uintp_copy (dest->parts, acc, n);
+  uintp_zero (dest->parts + n, NUMBER_OF_PARTS - n);
+
+  uintN_ws_release (ws, mark);
+}
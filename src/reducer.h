@@ -0,0 +1,104 @@
+/*
+ * reducer.h
+ *
+ * Header file for reduction modulo special-form moduli.
+ *
+ * A modulus of k bits is written m = 2^k - d. When d is small or sparse the
+ * part of x above 2^k can be folded back as x = hi 2^k + lo ≡ lo + hi d,
+ * which is a few linear passes instead of a division:
+ *
+ *   pseudo-Mersenne  d fits in one limb, hi d is one uintp_mul_1.
+ *   Solinas          d has few non-zero digits in non-adjacent form and
+ *                    about k/2 bits at most, hi d is a handful of shifted
+ *                    additions/subtractions.
+ *   top ones         the top limb of m is all ones (the RFC 3526/7919
+ *                    groups), each limb above m folds back with one
+ *                    uintp_addmul_1 and no quotient estimation.
+ *
+ * The form is detected when a modulus is first used and remembered in the
+ * modulus cache (see modcache.h), uintN_mod, uintN_modp and the modarith
+ * routines consult it before falling back to the generic division. Odd moduli keep the
+ * Montgomery exponentiation unless the one-limb folding is faster.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef REDUCER_H_
+#define REDUCER_H_
+
+#include <stddef.h>
+
+#include "uintN.h"
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+#define UINTN_FORM_GENERIC 0
+#define UINTN_FORM_PSEUDO_MERSENNE 1
+#define UINTN_FORM_SOLINAS 2
+#define UINTN_FORM_TOP_ONES 3
+
+/* maximum number of non-zero digits of d for the Solinas form */
+#define UINTN_SOLINAS_TERMS 8
+
+/* size from which pseudo-Mersenne folding beats Montgomery in uintN_modp */
+#define UINTN_REDUCER_MONT_PARTS 8
+
+typedef struct
+{
+  uintN_t m;
+  uintN_t d;
+  size_t n;
+  size_t k;
+  size_t dn;
+  uint8_t form;
+  uint8_t terms;
+  int16_t digits[UINTN_SOLINAS_TERMS];
+} uintN_reducer_t;
+
+/**
+ * reducer init, detects the form of m.
+ * returns false if m has no special form (form is then UINTN_FORM_GENERIC).
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+bool
+uintN_reducer_init (uintN_reducer_t *red, const uintN_t *m);
+
+/**
+ * reducer quick check of m, false if the 64 bits below the top of m are not
+ * all ones: every special form has them, so uintN_reducer_init would find
+ * none.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+bool
+uintN_reducer_maybe (const uintN_t *m);
+
+/**
+ * reducer r = t (mod m) for a tn-limb t, r receives the n limbs of m.
+ * red must have a special form, r may be equal to t.
+ *
+ * The running time of implemented algorithm is O(tn) per folding pass.
+ */
+void
+uintN_reducer_reduce (const uintN_reducer_t *red, uint64_t *r,
+		      const uint64_t *t, size_t tn, uintN_ws_t *ws);
+
+/**
+ * reducer modular exponentiation c ≡ b ^ exp (mod m).
+ * the implementation use the left-to-right fixed window method, the width
+ * per exponent length comes from the tuning profile.
+ */
+void
+uintN_reducer_modp (const uintN_reducer_t *red, const uintN_t *base,
+		    const uintN_t *exp, uintN_t *c, uintN_ws_t *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REDUCER_H_ */
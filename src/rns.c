@@ -0,0 +1,640 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "rns.h"
+#include "uintp.h"
+#include "tune.h"
+
+typedef unsigned __int128 uint128_t;
+
+#define MAX_K UINTN_RNS_MAX_CHANNELS
+
+/* limbs of a uintN_rns_t in the workspace */
+#define RNS_PARTS ((sizeof(uintN_rns_t) + PART_SIZE_BYTES - 1) / PART_SIZE_BYTES)
+
+/* widest window whose table of uintN_rns_t still fits the workspace */
+#define WINDOW_MAX 4
+
+typedef struct
+{
+  uint64_t w;
+  uint64_t s; /* floor(w 2^64 / p), Shoup's precomputed quotient */
+} shoup_t;
+
+typedef struct
+{
+  uint64_t p;
+  uint64_t pinv; /* -p^-1 mod 2^64 */
+} channel_t;
+
+/*
+ * M_i = M / m_i and M'_j = M' / m'_j.
+ */
+struct uintN_rns_tab
+{
+  channel_t ch[2][MAX_K]; /* primes of B and B' */
+
+  // x y -> q in B, extended to B' and 2^64
+  shoup_t q[MAX_K]; /* -2^64 m^-1 M_i^-1 mod m_i */
+  shoup_t ext1[MAX_K][MAX_K]; /* [i][j] M_i mod m'_j */
+  uint64_t ext1r[MAX_K]; /* M_i mod 2^64 */
+
+  // (x y + q m) / M in B' and 2^64
+  shoup_t rm[MAX_K]; /* 2^64 M^-1 mod m'_j */
+  shoup_t mm[MAX_K]; /* m M^-1 mod m'_j */
+  uint64_t minv; /* M^-1 mod 2^64 */
+
+  // exact extension from B' and 2^64 to B
+  shoup_t xi[MAX_K]; /* M'_j^-1 mod m'_j */
+  shoup_t ext2[MAX_K][MAX_K]; /* [j][i] M'_j mod m_i */
+  uint64_t ext2r[MAX_K]; /* M'_j mod 2^64 */
+  uint64_t mpinv; /* M'^-1 mod 2^64 */
+  shoup_t mp[MAX_K]; /* M' mod m_i */
+
+  // conversions
+  shoup_t pw[2][MAX_K][NUMBER_OF_PARTS + 1]; /* 2^(64 l) mod p */
+  uint64_t mpj[MAX_K][MAX_K]; /* M'_j in limbs */
+  uint64_t mpl[MAX_K + 1]; /* M' in limbs */
+  uintN_rns_t rr; /* M^2 mod m */
+  uintN_rns_t km; /* (k + 1) m */
+};
+
+/* the largest primes below 2^62 in decreasing order */
+static uint64_t primes[2 * MAX_K];
+static pthread_once_t primes_once = PTHREAD_ONCE_INIT;
+
+static inline uint64_t
+mul_mod (uint64_t a, uint64_t b, uint64_t p)
+{
+  return (uint64_t) ((uint128_t) a * b % p);
+}
+
+static uint64_t
+pow_mod (uint64_t a, uint64_t e, uint64_t p)
+{
+  uint64_t r = 1;
+
+  for (; e != 0; e >>= 1)
+    {
+      if (e & 1)
+	r = mul_mod (r, a, p);
+      a = mul_mod (a, a, p);
+    }
+  return r;
+}
+
+/*
+ * Miller-Rabin with the first twelve prime bases, deterministic below 2^64.
+ */
+static bool
+is_prime (uint64_t n)
+{
+  static const uint64_t bases[] =
+    { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+  uint64_t d, x;
+  unsigned int s, i, j;
+
+  for (i = 0; i < sizeof(bases) / sizeof(bases[0]); i++)
+    if (n % bases[i] == 0)
+      return n == bases[i];
+
+  for (d = n - 1, s = 0; (d & 1) == 0; d >>= 1)
+    s++;
+
+  for (i = 0; i < sizeof(bases) / sizeof(bases[0]); i++)
+    {
+      x = pow_mod (bases[i], d, n);
+      if (x == 1 || x == n - 1)
+	continue;
+      for (j = 1; j < s && x != n - 1; j++)
+	x = mul_mod (x, x, n);
+      if (x != n - 1)
+	return false;
+    }
+  return true;
+}
+
+static void
+primes_init (void)
+{
+  uint64_t c = (1ull << 62) - 1;
+  size_t i;
+
+  for (i = 0; i < 2 * MAX_K; c -= 2)
+    if (is_prime (c))
+      primes[i++] = c;
+}
+
+static uint64_t
+inv_mod (uint64_t a, uint64_t p)
+{
+  return pow_mod (a % p, p - 2, p);
+}
+
+/*
+ * a^-1 mod 2^64 for odd a, Newton iteration doubles the correct low bits.
+ */
+static uint64_t
+inv_2_64 (uint64_t a)
+{
+  uint64_t x = a;
+  unsigned int i;
+
+  for (i = 0; i < 6; i++)
+    x *= 2 - a * x;
+  return x;
+}
+
+static shoup_t
+shoup (uint64_t w, uint64_t p)
+{
+  shoup_t c =
+    { w, (uint64_t) (((uint128_t) w << 64) / p) };
+
+  return c;
+}
+
+/*
+ * a c.w mod p for any 64-bit a with two multiplications.
+ */
+static inline uint64_t
+shoup_mul (uint64_t a, shoup_t c, uint64_t p)
+{
+  uint64_t q = (uint64_t) (((uint128_t) a * c.s) >> 64);
+  uint64_t r = a * c.w - q * p;
+
+  return r >= p ? r - p : r;
+}
+
+/*
+ * a b 2^-64 mod p for a, b < p.
+ */
+static inline uint64_t
+mont_mul (uint64_t a, uint64_t b, const channel_t *c)
+{
+  uint128_t t = (uint128_t) a * b;
+  uint64_t m = (uint64_t) t * c->pinv;
+  uint64_t u;
+
+  u = (uint64_t) ((t + (uint128_t) m * c->p) >> 64);
+  return u >= c->p ? u - c->p : u;
+}
+
+static inline uint64_t
+add_mod (uint64_t a, uint64_t b, uint64_t p)
+{
+  a += b;
+  return a >= p ? a - p : a;
+}
+
+static size_t
+bit_length (const uint64_t *a, size_t n)
+{
+  n = uintp_normalize (a, n);
+  if (n == 0)
+    return 0;
+  return n * PART_SIZE_BITS - __builtin_clzll (a[n - 1]);
+}
+
+/*
+ * residues of the n-limb a < M'.
+ */
+static void
+residues (const uintN_rns_ctx_t *ctx, const uint64_t *a, size_t n,
+	  uintN_rns_t *c)
+{
+  const uintN_rns_tab_t *tab = ctx->tab;
+  size_t i, l;
+  uint64_t p, s, t;
+
+  for (i = 0; i < ctx->k; i++)
+    {
+      p = tab->ch[0][i].p;
+      for (l = 0, s = 0; l < n; l++)
+	s = add_mod (s, shoup_mul (a[l], tab->pw[0][i][l], p), p);
+      c->a[i] = s;
+
+      p = tab->ch[1][i].p;
+      for (l = 0, t = 0; l < n; l++)
+	t = add_mod (t, shoup_mul (a[l], tab->pw[1][i][l], p), p);
+      c->b[i] = t;
+    }
+  c->r = n > 0 ? a[0] : 0;
+}
+
+/*
+ * channels per basis for an nbits modulus, M > 2^(62 k - 1) must exceed
+ * 4 (k + 1)^2 m.
+ */
+static size_t
+channels (size_t nbits)
+{
+  size_t k, lg;
+
+  for (k = 1;; k++)
+    {
+      for (lg = 0; (1ull << lg) < k + 1; lg++)
+	;
+      if (62 * k >= nbits + 3 + 2 * lg)
+	return k;
+    }
+}
+
+bool
+uintN_rns_init (uintN_rns_ctx_t *ctx, const uintN_t *m)
+{
+  assert(ctx != NULL);
+  assert(m != NULL);
+
+  uintN_rns_tab_t *tab;
+  size_t n, k, i, j, l;
+  uint64_t p, v, w, pm;
+  channel_t *c;
+
+  memset (ctx, 0, sizeof(*ctx));
+
+  n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+  if (n == 0 || (n == 1 && m->parts[0] == 1))
+    return false;
+
+  k = channels (bit_length (m->parts, n));
+  assert(k <= MAX_K);
+
+  pthread_once (&primes_once, primes_init);
+
+  tab = calloc (1, sizeof(*tab));
+  if (tab == NULL)
+    return false;
+
+  uintN_set (&ctx->m, m->parts);
+  ctx->n = n;
+  ctx->k = k;
+  ctx->tab = tab;
+
+  for (i = 0; i < k; i++)
+    for (j = 0; j < 2; j++)
+      {
+	c = &tab->ch[j][i];
+	c->p = primes[j * k + i];
+	c->pinv = -inv_2_64 (c->p);
+	if (uintp_divrem_1 (NULL, m->parts, n, c->p) == 0)
+	  {
+	    uintN_rns_free (ctx);
+	    return false;
+	  }
+	for (l = 0, v = 1; l <= NUMBER_OF_PARTS; l++)
+	  {
+	    tab->pw[j][i][l] = shoup (v, c->p);
+	    v = mul_mod (v, (uint64_t) (((uint128_t) 1 << 64) % c->p), c->p);
+	  }
+      }
+
+  // first extension: q_i = x y (-2^64 m^-1 M_i^-1), sum of q_i M_i
+  tab->minv = 1;
+  for (i = 0; i < k; i++)
+    {
+      p = tab->ch[0][i].p;
+      tab->minv *= p;
+
+      // M_i mod m_i and mod every prime of B' and 2^64
+      for (l = 0, v = 1; l < k; l++)
+	if (l != i)
+	  v = mul_mod (v, tab->ch[0][l].p, p);
+      w = mul_mod (((uint128_t) 1 << 64) % p, inv_mod (v, p), p);
+      w = mul_mod (w, p - inv_mod (uintp_divrem_1 (NULL, m->parts, n, p), p),
+		   p);
+      tab->q[i] = shoup (w, p);
+
+      for (j = 0; j < k; j++)
+	{
+	  pm = tab->ch[1][j].p;
+	  for (l = 0, v = 1; l < k; l++)
+	    if (l != i)
+	      v = mul_mod (v, tab->ch[0][l].p, pm);
+	  tab->ext1[i][j] = shoup (v, pm);
+	}
+      for (l = 0, v = 1; l < k; l++)
+	if (l != i)
+	  v *= tab->ch[0][l].p;
+      tab->ext1r[i] = v;
+    }
+  tab->minv = inv_2_64 (tab->minv);
+
+  // r = (x y + q m) / M in B'
+  for (j = 0; j < k; j++)
+    {
+      pm = tab->ch[1][j].p;
+      for (l = 0, v = 1; l < k; l++)
+	v = mul_mod (v, tab->ch[0][l].p, pm);
+      v = inv_mod (v, pm);
+      tab->rm[j] = shoup (mul_mod (((uint128_t) 1 << 64) % pm, v, pm), pm);
+      tab->mm[j] = shoup (
+	  mul_mod (uintp_divrem_1 (NULL, m->parts, n, pm), v, pm), pm);
+    }
+
+  // second extension: xi_j = r_j M'_j^-1, sum of xi_j M'_j less beta M'
+  tab->mpinv = 1;
+  tab->mpl[0] = 1;
+  for (j = 0; j < k; j++)
+    {
+      pm = tab->ch[1][j].p;
+      tab->mpinv *= pm;
+      tab->mpl[j + 1] = uintp_mul_1 (tab->mpl, tab->mpl, j + 1, pm);
+
+      for (l = 0, v = 1; l < k; l++)
+	if (l != j)
+	  v = mul_mod (v, tab->ch[1][l].p, pm);
+      tab->xi[j] = shoup (inv_mod (v, pm), pm);
+
+      for (i = 0; i < k; i++)
+	{
+	  p = tab->ch[0][i].p;
+	  for (l = 0, v = 1; l < k; l++)
+	    if (l != j)
+	      v = mul_mod (v, tab->ch[1][l].p, p);
+	  tab->ext2[j][i] = shoup (v, p);
+	}
+
+      tab->mpj[j][0] = 1;
+      for (l = 0, i = 1; l < k; l++)
+	if (l != j)
+	  {
+	    tab->mpj[j][i] = uintp_mul_1 (tab->mpj[j], tab->mpj[j], i,
+					  tab->ch[1][l].p);
+	    i++;
+	  }
+      for (l = 0, v = 1; l < k; l++)
+	if (l != j)
+	  v *= tab->ch[1][l].p;
+      tab->ext2r[j] = v;
+    }
+  tab->mpinv = inv_2_64 (tab->mpinv);
+
+  for (i = 0; i < k; i++)
+    {
+      p = tab->ch[0][i].p;
+      for (l = 0, v = 1; l < k; l++)
+	v = mul_mod (v, tab->ch[1][l].p, p);
+      tab->mp[i] = shoup (v, p);
+    }
+
+  uintN_ws_t *ws = uintN_ws_thread ();
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *t = uintN_ws_alloc (ws, max(k + 1, 2 * n));
+  uint64_t *r = uintN_ws_alloc (ws, n);
+  uint64_t *tp = uintN_ws_alloc (ws,
+				 UINTP_DIVREM_SCRATCH(max(k + 1, 2 * n), n));
+
+  // M^2 mod m, the product of B has k + 1 >= n limbs
+  t[0] = 1;
+  for (i = 0; i < k; i++)
+    t[i + 1] = uintp_mul_1 (t, t, i + 1, tab->ch[0][i].p);
+  uintp_divrem (NULL, r, t, k + 1, m->parts, n, tp);
+  uintp_sqr (t, r, n);
+  uintp_divrem (NULL, r, t, 2 * n, m->parts, n, tp);
+  residues (ctx, r, n, &tab->rr);
+
+  // (k + 1) m
+  uintp_zero (t, n + 1);
+  t[n] = uintp_mul_1 (t, m->parts, n, k + 1);
+  residues (ctx, t, n + 1, &tab->km);
+
+  uintN_ws_release (ws, mark);
+
+  return true;
+}
+
+void
+uintN_rns_free (uintN_rns_ctx_t *ctx)
+{
+  assert(ctx != NULL);
+
+  free (ctx->tab);
+  ctx->tab = NULL;
+}
+
+void
+uintN_rns_mul (const uintN_rns_ctx_t *ctx, const uintN_rns_t *a,
+	       const uintN_rns_t *b, uintN_rns_t *c)
+{
+  assert(ctx != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(c != NULL);
+
+  const uintN_rns_tab_t *tab = ctx->tab;
+  size_t k = ctx->k, i, j;
+  uint64_t xi[MAX_K], qb[MAX_K], rb[MAX_K], qr, rr, beta, s, p;
+
+  // q = -a b m^-1 mod M in B, as xi_i = q_i M_i^-1
+  for (i = 0; i < k; i++)
+    xi[i] = shoup_mul (mont_mul (a->a[i], b->a[i], &tab->ch[0][i]), tab->q[i],
+		       tab->ch[0][i].p);
+
+  // q + alpha M in B' and 2^64 for some alpha < k
+  memset (qb, 0, k * sizeof(uint64_t));
+  for (i = 0, qr = 0; i < k; i++)
+    {
+      for (j = 0; j < k; j++)
+	qb[j] = add_mod (qb[j], shoup_mul (xi[i], tab->ext1[i][j],
+					   tab->ch[1][j].p),
+			 tab->ch[1][j].p);
+      qr += xi[i] * tab->ext1r[i];
+    }
+
+  // r = (a b + q m) / M, exact in B' and 2^64
+  for (j = 0; j < k; j++)
+    {
+      p = tab->ch[1][j].p;
+      rb[j] = add_mod (
+	  shoup_mul (mont_mul (a->b[j], b->b[j], &tab->ch[1][j]), tab->rm[j],
+		     p),
+	  shoup_mul (qb[j], tab->mm[j], p), p);
+      c->b[j] = rb[j];
+      xi[j] = shoup_mul (rb[j], tab->xi[j], p);
+    }
+  rr = (a->r * b->r + qr * ctx->m.parts[0]) * tab->minv;
+
+  // r < M' is the sum of xi_j M'_j less beta M', beta from the 2^64 channel
+  for (j = 0, s = 0; j < k; j++)
+    s += xi[j] * tab->ext2r[j];
+  beta = (s - rr) * tab->mpinv;
+
+  for (i = 0; i < k; i++)
+    {
+      p = tab->ch[0][i].p;
+      for (j = 0, s = 0; j < k; j++)
+	s = add_mod (s, shoup_mul (xi[j], tab->ext2[j][i], p), p);
+      s = add_mod (s, p - shoup_mul (beta, tab->mp[i], p), p);
+      c->a[i] = s;
+    }
+  c->r = rr;
+}
+
+void
+uintN_rns_add (const uintN_rns_ctx_t *ctx, const uintN_rns_t *a,
+	       const uintN_rns_t *b, uintN_rns_t *c)
+{
+  assert(ctx != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(c != NULL);
+
+  const uintN_rns_tab_t *tab = ctx->tab;
+  size_t i;
+
+  for (i = 0; i < ctx->k; i++)
+    {
+      c->a[i] = add_mod (a->a[i], b->a[i], tab->ch[0][i].p);
+      c->b[i] = add_mod (a->b[i], b->b[i], tab->ch[1][i].p);
+    }
+  c->r = a->r + b->r;
+}
+
+void
+uintN_rns_sub (const uintN_rns_ctx_t *ctx, const uintN_rns_t *a,
+	       const uintN_rns_t *b, uintN_rns_t *c)
+{
+  assert(ctx != NULL);
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(c != NULL);
+
+  const uintN_rns_tab_t *tab = ctx->tab;
+  uint64_t p;
+  size_t i;
+
+  // a + (k + 1) m - b stays positive and below 2 (k + 1) m
+  for (i = 0; i < ctx->k; i++)
+    {
+      p = tab->ch[0][i].p;
+      c->a[i] = add_mod (add_mod (a->a[i], tab->km.a[i], p), p - b->a[i], p);
+      p = tab->ch[1][i].p;
+      c->b[i] = add_mod (add_mod (a->b[i], tab->km.b[i], p), p - b->b[i], p);
+    }
+  c->r = a->r + tab->km.r - b->r;
+}
+
+void
+uintN_rns_to (const uintN_rns_ctx_t *ctx, const uintN_t *a, uintN_rns_t *c,
+	      uintN_ws_t *ws)
+{
+  assert(ctx != NULL);
+  assert(a != NULL);
+  assert(c != NULL);
+  assert(ws != NULL);
+
+  size_t mark = uintN_ws_mark (ws);
+  uintN_t *t = uintN_ws_alloc_N (ws);
+
+  uintN_mod_ws (a, &ctx->m, t, ws);
+  residues (ctx, t->parts, ctx->n, c);
+  uintN_rns_mul (ctx, c, &ctx->tab->rr, c);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_rns_from (const uintN_rns_ctx_t *ctx, const uintN_rns_t *a, uintN_t *c,
+		uintN_ws_t *ws)
+{
+  assert(ctx != NULL);
+  assert(a != NULL);
+  assert(c != NULL);
+  assert(ws != NULL);
+
+  const uintN_rns_tab_t *tab = ctx->tab;
+  size_t k = ctx->k, n = ctx->n, j;
+  uint64_t xi, s, beta;
+  uintN_rns_t one;
+
+  size_t mark = uintN_ws_mark (ws);
+  uintN_rns_t *y = (uintN_rns_t *) uintN_ws_alloc (ws, RNS_PARTS);
+  uint64_t *t = uintN_ws_alloc (ws, k + 1);
+  uint64_t *tp = uintN_ws_alloc (ws, UINTP_DIVREM_SCRATCH(k + 1, n));
+
+  // y = a M^-1 below (k + 1) m
+  for (j = 0; j < k; j++)
+    one.a[j] = one.b[j] = 1;
+  one.r = 1;
+  uintN_rns_mul (ctx, a, &one, y);
+
+  // y = sum of xi_j M'_j less beta M', then reduced
+  uintp_zero (t, k + 1);
+  for (j = 0, s = 0; j < k; j++)
+    {
+      xi = shoup_mul (y->b[j], tab->xi[j], tab->ch[1][j].p);
+      t[k] += uintp_addmul_1 (t, tab->mpj[j], k, xi);
+      s += xi * tab->ext2r[j];
+    }
+  beta = (s - y->r) * tab->mpinv;
+  uintp_submul_1 (t, tab->mpl, k + 1, beta);
+
+  uintN_zeroize (c);
+  uintp_divrem (NULL, c->parts, t, k + 1, ctx->m.parts, n, tp);
+
+  uintN_ws_release (ws, mark);
+}
+
+static unsigned int
+get_bits (const uint64_t *a, size_t pos, unsigned int w)
+{
+  size_t i = pos / PART_SIZE_BITS, s = pos % PART_SIZE_BITS;
+  uint64_t v = a[i] >> s;
+
+  if (s + w > PART_SIZE_BITS && i + 1 < NUMBER_OF_PARTS)
+    v |= a[i + 1] << (PART_SIZE_BITS - s);
+  return v & ((1u << w) - 1);
+}
+
+void
+uintN_rns_modp (const uintN_rns_ctx_t *ctx, const uintN_t *base,
+		const uintN_t *exp, uintN_t *dest, uintN_ws_t *ws)
+{
+  assert(ctx != NULL);
+  assert(base != NULL);
+  assert(exp != NULL);
+  assert(dest != NULL);
+  assert(ws != NULL);
+
+  size_t bits, pos, i;
+  unsigned int w, d;
+  uintN_t one =
+    { 1 };
+
+  bits = bit_length (exp->parts, NUMBER_OF_PARTS);
+  w = min(uintN_tune_window (bits), WINDOW_MAX);
+
+  size_t mark = uintN_ws_mark (ws);
+  uintN_rns_t *table = (uintN_rns_t *) uintN_ws_alloc (ws,
+						       (1u << w) * RNS_PARTS);
+  uintN_rns_t *acc = (uintN_rns_t *) uintN_ws_alloc (ws, RNS_PARTS);
+
+  // table[i] = base^i M (mod m)
+  uintN_rns_to (ctx, &one, &table[0], ws);
+  uintN_rns_to (ctx, base, &table[1], ws);
+  for (i = 2; i < (1u << w); i++)
+    uintN_rns_mul (ctx, &table[i - 1], &table[1], &table[i]);
+
+  *acc = table[0];
+
+  // left-to-right, the top window may be shorter than w
+  pos = (bits + w - 1) / w * w;
+  while (pos > 0)
+    {
+      if (pos < bits)
+	for (i = 0; i < w; i++)
+	  uintN_rns_mul (ctx, acc, acc, acc);
+      pos -= w;
+
+      d = get_bits (exp->parts, pos, w);
+      if (d != 0)
+	uintN_rns_mul (ctx, acc, &table[d], acc);
+    }
+
+  uintN_rns_from (ctx, acc, dest, ws);
+
+  uintN_ws_release (ws, mark);
+}
@@ -0,0 +1,145 @@
+/*
+ * rns.h
+ *
+ * Header file for modular arithmetic in a residue number system.
+ *
+ * A number x is held as its residues modulo two bases of primes just below
+ * 2^62, B = {m_1, ..., m_k} and B' = {m'_1, ..., m'_k} of products M and M',
+ * and modulo 2^64. Addition and multiplication work on every residue on its
+ * own, without carries between them: every step is a loop over
+ * independent words and no channel waits for another.
+ *
+ * Multiplication modulo m is Montgomery's in RNS with R = M. The quotient
+ * q = -x y m^-1 is known in B only and is extended to B' approximately,
+ * which adds a multiple of M the reduction tolerates. The result
+ * r = (x y + q m) / M is computed in B' and 2^64 and extended back to B
+ * exactly with the residue modulo 2^64 (Shenoy and Kumaresan). Every base
+ * extension costs k^2 multiplications by constants of two word products
+ * each, with k slightly above n a product takes about twice the word
+ * products of uintN_mont_mulp. What it gains is independence: all k
+ * channels of a step can run at once on vector units or separate cores.
+ *
+ * Values are kept in Montgomery form x M (mod m) and are only bounded by
+ * (k + 1) m, uintN_rns_from reduces them completely. k is chosen so that
+ * M > 4 (k + 1)^2 m, which keeps the bound through uintN_rns_mul.
+ *
+ * m may be even, it only has to be coprime to the primes of the bases.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef RNS_H_
+#define RNS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uintN.h"
+#include "workspace.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* channels per basis for a NUMBER_OF_BITS modulus, with room for the bound */
+#define UINTN_RNS_MAX_CHANNELS (NUMBER_OF_BITS / 60 + 2)
+
+typedef struct
+{
+  uint64_t a[UINTN_RNS_MAX_CHANNELS]; /* residues modulo the primes of B */
+  uint64_t b[UINTN_RNS_MAX_CHANNELS]; /* residues modulo the primes of B' */
+  uint64_t r; /* residue modulo 2^64 */
+} uintN_rns_t;
+
+typedef struct uintN_rns_tab uintN_rns_tab_t;
+
+typedef struct
+{
+  uintN_t m;
+  size_t n; /* limbs of m */
+  size_t k; /* channels per basis */
+  uintN_rns_tab_t *tab; /* primes and CRT constants */
+} uintN_rns_ctx_t;
+
+/**
+ * rns init for modulus m, the bases and the constants of the base
+ * extensions and conversions.
+ * returns false if m is below 2, shares a factor with a prime of the bases
+ * or the constants could not be allocated.
+ *
+ * The running time of implemented algorithm is O(k^3 + n^2).
+ */
+bool
+uintN_rns_init (uintN_rns_ctx_t *ctx, const uintN_t *m);
+
+/**
+ * rns free the constants of ctx.
+ */
+void
+uintN_rns_free (uintN_rns_ctx_t *ctx);
+
+/**
+ * rns conversion c = a M (mod m), a may be any uintN_t.
+ *
+ * The running time of implemented algorithm is O(nk + k^2).
+ */
+void
+uintN_rns_to (const uintN_rns_ctx_t *ctx, const uintN_t *a, uintN_rns_t *c,
+	      uintN_ws_t *ws);
+
+/**
+ * rns conversion c = a M^-1 (mod m), fully reduced.
+ *
+ * The running time of implemented algorithm is O(k^2 + nk).
+ */
+void
+uintN_rns_from (const uintN_rns_ctx_t *ctx, const uintN_rns_t *a, uintN_t *c,
+		uintN_ws_t *ws);
+
+/**
+ * rns Montgomery multiplication c = a b M^-1 (mod m) with two base
+ * extensions. c may be equal to a or b.
+ *
+ * The running time of implemented algorithm is O(k^2).
+ */
+void
+uintN_rns_mul (const uintN_rns_ctx_t *ctx, const uintN_rns_t *a,
+	       const uintN_rns_t *b, uintN_rns_t *c);
+
+/**
+ * rns addition c = a + b (mod m) channel by channel. a and b must come from
+ * uintN_rns_to or uintN_rns_mul, and c is only good as an operand of
+ * uintN_rns_mul.
+ *
+ * The running time of implemented algorithm is O(k).
+ */
+void
+uintN_rns_add (const uintN_rns_ctx_t *ctx, const uintN_rns_t *a,
+	       const uintN_rns_t *b, uintN_rns_t *c);
+
+/**
+ * rns subtraction c = a - b (mod m) channel by channel, with the same
+ * restrictions as uintN_rns_add.
+ *
+ * The running time of implemented algorithm is O(k).
+ */
+void
+uintN_rns_sub (const uintN_rns_ctx_t *ctx, const uintN_rns_t *a,
+	       const uintN_rns_t *b, uintN_rns_t *c);
+
+/**
+ * rns modular exponentiation c ≡ b ^ exp (mod m), plain in and out.
+ * the implementation use the left-to-right fixed window method.
+ *
+ * The running time of implemented algorithm is O(log exp) multiplications.
+ */
+void
+uintN_rns_modp (const uintN_rns_ctx_t *ctx, const uintN_t *base,
+		const uintN_t *exp, uintN_t *dest, uintN_ws_t *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RNS_H_ */
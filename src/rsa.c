@@ -0,0 +1,343 @@
+#include <assert.h>
+#include <string.h>
+
+#include "rsa.h"
+#include "uintp.h"
+#include "random.h"
+#include "modarith.h"
+
+/* odd powers b, b^3, .., b^(2^w - 1) of the sliding window */
+#define WINDOW_MAX 3
+#define TABLE_SIZE (1u << (WINDOW_MAX - 1))
+
+/* scratch of one public operation, in limbs */
+#define SCRATCH(n) ((2 + TABLE_SIZE + 2) * (n))
+
+static unsigned int
+window_size (uint64_t e)
+{
+  // short chains gain nothing from the table
+  if (e >> 20 == 0)
+    return 1;
+  return WINDOW_MAX;
+}
+
+bool
+rsa_pub_init (rsa_pub_t *pub, const uintN_t *n, uint64_t e)
+{
+  assert(pub != NULL);
+  assert(n != NULL);
+
+  memset (pub, 0, sizeof(*pub));
+
+  if (e < 3 || (e & 0x01) == 0)
+    return false;
+  if (!uintN_mont_init (&pub->mont, n))
+    return false;
+
+  pub->e = e;
+  return true;
+}
+
+/*
+ * r = m ^ e (mod n) for an n-limb m < n, sp is SCRATCH(n) limbs.
+ * the left-to-right sliding window over the single limb e, 65537 takes
+ * 16 squarings and one multiplication.
+ */
+static void
+public_op (const rsa_pub_t *pub, uint64_t *r, const uint64_t *m, uint64_t *sp)
+{
+  const uintN_mont_t *ctx = &pub->mont;
+  size_t n, len, k;
+  unsigned int w;
+  uint64_t d;
+  int i, j;
+
+  n = ctx->n;
+  w = window_size (pub->e);
+
+  uint64_t *tp = sp;
+  uint64_t *table = tp + 2 * n;
+  uint64_t *acc = table + TABLE_SIZE * n;
+  uint64_t *b2 = acc + n;
+
+  // table[k] = m^(2k + 1) R (mod n)
+  uintN_mont_mulp (ctx, table, m, ctx->rr.parts, tp);
+  if (w > 1)
+    {
+      uintN_mont_sqrp (ctx, b2, table, tp);
+      for (k = 1; k < (1u << (w - 1)); k++)
+	uintN_mont_mulp (ctx, table + k * n, table + (k - 1) * n, b2, tp);
+    }
+
+  // the top bit of e is set, the first window seeds acc
+  i = PART_SIZE_BITS - 1 - __builtin_clzll (pub->e);
+  j = i - (int) w + 1 < 0 ? 0 : i - (int) w + 1;
+  while (((pub->e >> j) & 0x01) == 0)
+    j++;
+  d = (pub->e >> j) & ((1ull << (i - j + 1)) - 1);
+  uintp_copy (acc, table + (d >> 1) * n, n);
+
+  for (i = j - 1; i >= 0; i = j - 1)
+    {
+      if (((pub->e >> i) & 0x01) == 0)
+	{
+	  uintN_mont_sqrp (ctx, acc, acc, tp);
+	  j = i;
+	  continue;
+	}
+
+      // window [j, i] of at most w bits ending in a set bit
+      j = i - (int) w + 1 < 0 ? 0 : i - (int) w + 1;
+      while (((pub->e >> j) & 0x01) == 0)
+	j++;
+      len = i - j + 1;
+      d = (pub->e >> j) & ((1ull << len) - 1);
+
+      while (len-- > 0)
+	uintN_mont_sqrp (ctx, acc, acc, tp);
+      uintN_mont_mulp (ctx, acc, acc, table + (d >> 1) * n, tp);
+    }
+
+  // out of Montgomery form
+  uintp_copy (tp, acc, n);
+  uintp_zero (tp + n, n);
+  uintN_mont_redc (ctx, r, tp);
+}
+
+bool
+rsa_public (const rsa_pub_t *pub, const uintN_t *m, uintN_t *c,
+	    uintN_ws_t *ws)
+{
+  assert(pub != NULL);
+  assert(m != NULL);
+  assert(c != NULL);
+  assert(ws != NULL);
+
+  size_t n = pub->mont.n;
+
+  if (!uintN_isless (m, &pub->mont.m))
+    return false;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *sp = uintN_ws_alloc (ws, SCRATCH(n));
+
+  public_op (pub, c->parts, m->parts, sp);
+  uintp_zero (c->parts + n, NUMBER_OF_PARTS - n);
+
+  uintN_ws_release (ws, mark);
+  return true;
+}
+
+/*
+ * sig ^ e == em with the scratch of one public operation.
+ */
+static bool
+verify (const rsa_pub_t *pub, const uintN_t *sig, const uintN_t *em,
+	uint64_t *r, uint64_t *sp)
+{
+  size_t n = pub->mont.n;
+
+  if (!uintN_isless (sig, &pub->mont.m))
+    return false;
+  if (uintp_normalize (em->parts, NUMBER_OF_PARTS) > n)
+    return false;
+
+  public_op (pub, r, sig->parts, sp);
+  return uintp_cmp (r, em->parts, n) == 0;
+}
+
+bool
+rsa_verify (const rsa_pub_t *pub, const uintN_t *sig, const uintN_t *em,
+	    uintN_ws_t *ws)
+{
+  assert(pub != NULL);
+  assert(sig != NULL);
+  assert(em != NULL);
+  assert(ws != NULL);
+
+  bool ok;
+  size_t n = pub->mont.n;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *r = uintN_ws_alloc (ws, n);
+  uint64_t *sp = uintN_ws_alloc (ws, SCRATCH(n));
+
+  ok = verify (pub, sig, em, r, sp);
+
+  uintN_ws_release (ws, mark);
+  return ok;
+}
+
+size_t
+rsa_verify_batch (const rsa_pub_t *pub, const uintN_t *const *sig,
+		  const uintN_t *const *em, size_t k, bool *ok,
+		  uintN_ws_t *ws)
+{
+  assert(pub != NULL);
+  assert(sig != NULL || k == 0);
+  assert(em != NULL || k == 0);
+  assert(ws != NULL);
+
+  size_t i, valid;
+  bool v;
+  size_t n = pub->mont.n;
+
+  // one key, one scratch area for the whole batch
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *r = uintN_ws_alloc (ws, n);
+  uint64_t *sp = uintN_ws_alloc (ws, SCRATCH(n));
+
+  for (i = 0, valid = 0; i < k; i++)
+    {
+      v = verify (pub, sig[i], em[i], r, sp);
+      if (ok != NULL)
+	ok[i] = v;
+      valid += v;
+    }
+
+  uintN_ws_release (ws, mark);
+  return valid;
+}
+
+/*
+ * new blinding pair vf = r^e R, vi = r^-1 R (mod n) for a random r.
+ * uintN_modinv runs in constant time for the odd n, so r is inverted
+ * directly.
+ */
+static bool
+refresh (rsa_blind_t *b, uintN_ws_t *ws)
+{
+  const uintN_mont_t *ctx = &b->pub->mont;
+  unsigned int tries;
+  bool ok = false;
+  uintN_t r, t;
+
+  for (tries = 0; tries < 16 && !ok; tries++)
+    {
+      uintN_random_below (&r, &ctx->m);
+      if (uintN_iszero (&r) || !uintN_modinv (&r, &ctx->m, &t))
+	continue;
+
+      uintN_mont_to (ctx, &t, &b->vi, ws);
+
+      rsa_public (b->pub, &r, &r, ws);
+      uintN_mont_to (ctx, &r, &b->vf, ws);
+
+      b->uses = 0;
+      ok = true;
+    }
+
+  uintN_zeroize (&r);
+  uintN_zeroize (&t);
+  return ok;
+}
+
+bool
+rsa_blind_init (rsa_blind_t *b, const rsa_pub_t *pub, unsigned int limit)
+{
+  assert(b != NULL);
+  assert(pub != NULL);
+
+  memset (b, 0, sizeof(*b));
+  b->pub = pub;
+  b->limit = limit != 0 ? limit : RSA_BLIND_USES;
+  pthread_mutex_init (&b->lock, NULL);
+
+  if (!refresh (b, uintN_ws_thread ()))
+    {
+      rsa_blind_free (b);
+      return false;
+    }
+  return true;
+}
+
+void
+rsa_blind_free (rsa_blind_t *b)
+{
+  assert(b != NULL);
+
+  pthread_mutex_destroy (&b->lock);
+  uintN_wipe (b, sizeof(*b));
+}
+
+void
+rsa_blind (rsa_blind_t *b, const uintN_t *c, uintN_t *blinded,
+	   uintN_t *unblind, uintN_ws_t *ws)
+{
+  assert(b != NULL);
+  assert(c != NULL);
+  assert(blinded != NULL);
+  assert(unblind != NULL);
+  assert(ws != NULL);
+
+  const uintN_mont_t *ctx = &b->pub->mont;
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, 2 * ctx->n);
+
+  pthread_mutex_lock (&b->lock);
+
+  // a failed refresh keeps squaring the old pair
+  if (b->uses >= b->limit)
+    refresh (b, ws);
+
+  // c r^e R R^-1 and r^-1 R for the caller
+  uintN_mont_mul (ctx, c, &b->vf, blinded, ws);
+  uintN_set (unblind, b->vi.parts);
+
+  // (r^e, r^-1) -> (r^2e, r^-2)
+  uintN_mont_sqrp (ctx, b->vf.parts, b->vf.parts, tp);
+  uintN_mont_sqrp (ctx, b->vi.parts, b->vi.parts, tp);
+  b->uses++;
+
+  pthread_mutex_unlock (&b->lock);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+rsa_unblind (const rsa_blind_t *b, const uintN_t *m, uintN_t *unblind,
+	     uintN_t *out, uintN_ws_t *ws)
+{
+  assert(b != NULL);
+  assert(m != NULL);
+  assert(unblind != NULL);
+  assert(out != NULL);
+
+  uintN_mont_mul (&b->pub->mont, m, unblind, out, ws);
+  uintN_zeroize (unblind);
+}
+
+bool
+rsa_private (const rsa_pub_t *pub, const uintN_t *d, rsa_blind_t *b,
+	     const uintN_t *c, uintN_t *m, uintN_ws_t *ws)
+{
+  assert(pub != NULL);
+  assert(d != NULL);
+  assert(c != NULL);
+  assert(m != NULL);
+  assert(ws != NULL);
+  assert(b == NULL || b->pub == pub);
+
+  uintN_t t, f;
+  size_t bits;
+
+  if (!uintN_isless (c, &pub->mont.m))
+    return false;
+
+  // blinding hides the base, the exponent needs the constant-time ladder
+  bits = pub->mont.n * PART_SIZE_BITS;
+  if (b == NULL)
+    {
+      uintN_mont_modp_ct (&pub->mont, c, d, bits, m, ws);
+      return true;
+    }
+
+  rsa_blind (b, c, &t, &f, ws);
+  uintN_mont_modp_ct (&pub->mont, &t, d, bits, &t, ws);
+  rsa_unblind (b, &t, &f, m, ws);
+
+  uintN_zeroize (&t);
+  return true;
+}
@@ -0,0 +1,154 @@
+/*
+ * rsa.h
+ *
+ * Header file for the RSA public-key operation c = m ^ e (mod n).
+ *
+ * Public exponents are short, almost always e = 65537 = 2^16 + 1. Instead of
+ * the generic windowed exponentiation over a full uintN_t exponent the key
+ * keeps e in one limb and runs a fixed addition chain on it: 16 squarings
+ * and one multiplication for 65537, a left-to-right binary chain for other
+ * exponents of up to 20 bits and a 3-bit sliding window for longer ones.
+ *
+ * The Montgomery context of n is set up once per key, so verifying many
+ * signatures against the same key pays for R^2 mod n only once.
+ *
+ * Private-key operations are blinded: c is multiplied by r^e before the
+ * exponentiation with d and the result by r^-1 after it, so the timing of
+ * the exponentiation does not depend on c. A blinding context keeps the
+ * pair (r^e, r^-1) per key and moves to (r^2e, r^-2) by squaring both after
+ * each use, a fresh r with its inverse and r^e is only drawn every
+ * RSA_BLIND_USES operations.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef RSA_H_
+#define RSA_H_
+
+#include <stddef.h>
+#include <pthread.h>
+
+#include "uintN.h"
+#include "workspace.h"
+#include "montgomery.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* the usual public exponent 2^16 + 1 */
+#define RSA_F4 0x10001
+
+/* blinding operations between two fresh blinding factors */
+#define RSA_BLIND_USES 32
+
+typedef struct
+{
+  uintN_mont_t mont;
+  uint64_t e;
+} rsa_pub_t;
+
+typedef struct
+{
+  const rsa_pub_t *pub;
+  uintN_t vf;
+  uintN_t vi;
+  unsigned int uses;
+  unsigned int limit;
+  pthread_mutex_t lock;
+} rsa_blind_t;
+
+/**
+ * rsa public key init for the modulus n and the exponent e.
+ * returns false if n is even or e is even or less than 3.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+bool
+rsa_pub_init (rsa_pub_t *pub, const uintN_t *n, uint64_t e);
+
+/**
+ * rsa public operation c = m ^ e (mod n), encryption or signature recovery.
+ * returns false if m is not less than n.
+ *
+ * The running time of implemented algorithm is O(log e) multiplications.
+ */
+bool
+rsa_public (const rsa_pub_t *pub, const uintN_t *m, uintN_t *c,
+	    uintN_ws_t *ws);
+
+/**
+ * rsa verify sig ^ e ≡ em (mod n) for the encoded message em.
+ * returns false if the signature does not match or is not less than n.
+ *
+ * The running time of implemented algorithm is O(log e) multiplications.
+ */
+bool
+rsa_verify (const rsa_pub_t *pub, const uintN_t *sig, const uintN_t *em,
+	    uintN_ws_t *ws);
+
+/**
+ * rsa verify k signatures against one key, ok[i] receives the result of
+ * sig[i] and may be NULL. returns the number of valid signatures.
+ *
+ * The running time of implemented algorithm is O(k log e) multiplications.
+ */
+size_t
+rsa_verify_batch (const rsa_pub_t *pub, const uintN_t *const *sig,
+		  const uintN_t *const *em, size_t k, bool *ok,
+		  uintN_ws_t *ws);
+
+/**
+ * rsa blinding context init for the key pub, a fresh factor is drawn every
+ * limit uses (0 for RSA_BLIND_USES). pub must outlive the context.
+ * returns false if no invertible blinding factor could be found.
+ *
+ * The running time of implemented algorithm is O(n^2) plus one inversion.
+ */
+bool
+rsa_blind_init (rsa_blind_t *b, const rsa_pub_t *pub, unsigned int limit);
+
+/**
+ * rsa blinding context wipe.
+ */
+void
+rsa_blind_free (rsa_blind_t *b);
+
+/**
+ * rsa blind c' = c r^e (mod n), unblind receives the matching factor for
+ * rsa_unblind. the context moves on to the next factor pair, safe to call
+ * from several threads.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+rsa_blind (rsa_blind_t *b, const uintN_t *c, uintN_t *blinded,
+	   uintN_t *unblind, uintN_ws_t *ws);
+
+/**
+ * rsa unblind m = m' r^-1 (mod n) with the factor returned by rsa_blind.
+ * the factor is wiped.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+rsa_unblind (const rsa_blind_t *b, const uintN_t *m, uintN_t *unblind,
+	     uintN_t *out, uintN_ws_t *ws);
+
+/**
+ * rsa private operation m = c ^ d (mod n), blinded with b (may be NULL).
+ * d goes through uintN_mont_modp_ct, the time does not depend on it.
+ * returns false if c is not less than n.
+ *
+ * The running time of implemented algorithm is O(log n) multiplications.
+ */
+bool
+rsa_private (const rsa_pub_t *pub, const uintN_t *d, rsa_blind_t *b,
+	     const uintN_t *c, uintN_t *m, uintN_ws_t *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RSA_H_ */
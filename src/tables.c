@@ -0,0 +1,472 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tables.h"
+
+#define MAGIC "uintNtbl"
+
+/* read back in another byte order this is no longer the same number */
+#define ORDER 0x0102030405060708ull
+
+/* records start on a cache line */
+#define ALIGN 64
+#define ALIGN_UP(x) (((x) + ALIGN - 1) & ~(size_t) (ALIGN - 1))
+
+typedef struct
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t bits;
+  uint64_t order;
+  uint64_t size;
+  uint32_t count;
+  uint32_t reserved;
+  uint64_t checksum; /* of header and directory, with this field 0 */
+  uint8_t pad[16];
+} header_t;
+
+typedef struct
+{
+  char name[UINTN_TABLES_NAME];
+  uint32_t kind;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t length;
+  uint64_t checksum;
+} dirent_t;
+
+typedef struct
+{
+  uintN_t m;
+  uintN_t one;
+  uintN_t rr;
+  uint64_t minv;
+  uint64_t n;
+} mont_rec_t;
+
+/* followed by the comb table at FB_TABLE */
+typedef struct
+{
+  mont_rec_t mont;
+  uintN_t g;
+  uint64_t ebits;
+  uint64_t a;
+  uint64_t b;
+  uint64_t teeth;
+  uint64_t blocks;
+} fb_rec_t;
+
+#define FB_TABLE ALIGN_UP(sizeof(fb_rec_t))
+
+/*
+ * checksum h continued over the len bytes at p, len a multiple of 8.
+ * a multiply and xorshift per word, fast enough to check tables of several
+ * megabytes at startup.
+ */
+static uint64_t
+checksum (uint64_t h, const void *p, size_t len)
+{
+  const uint64_t *w = p;
+  size_t i;
+
+  for (i = 0; i < len / sizeof(uint64_t); i++)
+    {
+      h = (h ^ w[i]) * 0x9e3779b97f4a7c15ull;
+      h ^= h >> 32;
+    }
+  return h;
+}
+
+static void
+mont_rec (mont_rec_t *r, const uintN_mont_t *ctx)
+{
+  memset (r, 0, sizeof(*r));
+  uintN_set (&r->m, ctx->m.parts);
+  uintN_set (&r->one, ctx->one.parts);
+  uintN_set (&r->rr, ctx->rr.parts);
+  r->minv = ctx->minv;
+  r->n = ctx->n;
+}
+
+static bool
+mont_load (uintN_mont_t *ctx, const mont_rec_t *r)
+{
+  if (r->n == 0 || r->n > NUMBER_OF_PARTS || (r->m.parts[0] & 0x01) == 0)
+    return false;
+
+  memset (ctx, 0, sizeof(*ctx));
+  uintN_set (&ctx->m, r->m.parts);
+  uintN_set (&ctx->one, r->one.parts);
+  uintN_set (&ctx->rr, r->rr.parts);
+  ctx->minv = r->minv;
+  ctx->n = r->n;
+  return true;
+}
+
+static void
+fb_rec (fb_rec_t *r, const uintN_fb_t *fb)
+{
+  memset (r, 0, sizeof(*r));
+  mont_rec (&r->mont, &fb->mont);
+  uintN_set (&r->g, fb->g.parts);
+  r->ebits = fb->ebits;
+  r->a = fb->a;
+  r->b = fb->b;
+  r->teeth = fb->teeth;
+  r->blocks = fb->blocks;
+}
+
+/*
+ * length of the record of rec in the file.
+ */
+static size_t
+rec_length (const uintN_tables_rec_t *rec)
+{
+  if (rec->mont != NULL)
+    return sizeof(mont_rec_t);
+  return FB_TABLE + UINTN_FB_TABLE_SIZE(rec->fb) * sizeof(uint64_t);
+}
+
+static bool
+write_all (FILE *f, const void *p, size_t len)
+{
+  return len == 0 || fwrite (p, len, 1, f) == 1;
+}
+
+static bool
+write_pad (FILE *f, size_t len)
+{
+  static const uint8_t zero[ALIGN];
+
+  return write_all (f, zero, len);
+}
+
+/*
+ * the records of recs after header and directory.
+ */
+static bool
+write_records (FILE *f, const uintN_tables_rec_t *recs, size_t k)
+{
+  mont_rec_t mr;
+  fb_rec_t fr;
+  size_t i, len;
+
+  for (i = 0; i < k; i++)
+    {
+      len = rec_length (&recs[i]);
+      if (recs[i].mont != NULL)
+	{
+	  mont_rec (&mr, recs[i].mont);
+	  if (!write_all (f, &mr, sizeof(mr)))
+	    return false;
+	}
+      else
+	{
+	  fb_rec (&fr, recs[i].fb);
+	  if (!write_all (f, &fr, sizeof(fr))
+	      || !write_pad (f, FB_TABLE - sizeof(fr))
+	      || !write_all (f, recs[i].fb->table, len - FB_TABLE))
+	    return false;
+	}
+      if (!write_pad (f, ALIGN_UP(len) - len))
+	return false;
+    }
+  return true;
+}
+
+bool
+uintN_tables_save (const char *path, const uintN_tables_rec_t *recs,
+		   size_t k)
+{
+  assert(path != NULL);
+  assert(recs != NULL || k == 0);
+
+  header_t h;
+  dirent_t *dir;
+  mont_rec_t mr;
+  fb_rec_t fr;
+  static const uint8_t zero[FB_TABLE];
+  size_t i, j, off, len;
+  uint64_t sum;
+  char *tmp;
+  FILE *f;
+  bool ok;
+  int fd, err;
+
+  for (i = 0; i < k; i++)
+    {
+      assert((recs[i].mont == NULL) != (recs[i].fb == NULL));
+      if (recs[i].name == NULL || strlen (recs[i].name) >= UINTN_TABLES_NAME)
+	{
+	  errno = EINVAL;
+	  return false;
+	}
+      for (j = 0; j < i; j++)
+	if (strcmp (recs[i].name, recs[j].name) == 0)
+	  {
+	    errno = EINVAL;
+	    return false;
+	  }
+    }
+
+  dir = calloc (max(k, 1), sizeof(dirent_t));
+  tmp = malloc (strlen (path) + 8);
+  if (dir == NULL || tmp == NULL)
+    {
+      free (dir);
+      free (tmp);
+      errno = ENOMEM;
+      return false;
+    }
+
+  // lay out the records and checksum them from memory
+  off = sizeof(header_t) + k * sizeof(dirent_t);
+  for (i = 0; i < k; i++)
+    {
+      len = rec_length (&recs[i]);
+      strcpy (dir[i].name, recs[i].name);
+      dir[i].offset = off;
+      dir[i].length = len;
+      if (recs[i].mont != NULL)
+	{
+	  dir[i].kind = UINTN_TABLES_MONT;
+	  mont_rec (&mr, recs[i].mont);
+	  dir[i].checksum = checksum (len, &mr, sizeof(mr));
+	}
+      else
+	{
+	  dir[i].kind = UINTN_TABLES_FB;
+	  fb_rec (&fr, recs[i].fb);
+	  sum = checksum (len, &fr, sizeof(fr));
+	  sum = checksum (sum, zero, FB_TABLE - sizeof(fr));
+	  dir[i].checksum = checksum (sum, recs[i].fb->table, len - FB_TABLE);
+	}
+      off += ALIGN_UP(len);
+    }
+
+  memset (&h, 0, sizeof(h));
+  memcpy (h.magic, MAGIC, sizeof(h.magic));
+  h.version = UINTN_TABLES_VERSION;
+  h.bits = NUMBER_OF_BITS;
+  h.order = ORDER;
+  h.size = off;
+  h.count = k;
+  h.checksum = checksum (checksum (0, &h, sizeof(h)), dir,
+			 k * sizeof(dirent_t));
+
+  // a temporary file in the same directory, renamed over path when complete.
+  // mkstemp creates it 0600, it is opened up to 0644 for workers running as
+  // other users
+  sprintf (tmp, "%s.XXXXXX", path);
+  fd = mkstemp (tmp);
+  f = fd < 0 ? NULL : fdopen (fd, "wb");
+  if (f == NULL)
+    {
+      err = errno;
+      if (fd >= 0)
+	{
+	  close (fd);
+	  unlink (tmp);
+	}
+      free (dir);
+      free (tmp);
+      errno = err;
+      return false;
+    }
+
+  ok = write_all (f, &h, sizeof(h))
+      && write_all (f, dir, k * sizeof(dirent_t))
+      && write_records (f, recs, k) && fflush (f) == 0 && fsync (fd) == 0
+      && fchmod (fd, 0644) == 0;
+  err = errno;
+  ok = (fclose (f) == 0) && ok;
+  if (ok && rename (tmp, path) != 0)
+    {
+      err = errno;
+      ok = false;
+    }
+  if (!ok)
+    unlink (tmp);
+
+  free (dir);
+  free (tmp);
+  if (!ok)
+    errno = err;
+  return ok;
+}
+
+bool
+uintN_tables_open (uintN_tables_t *t, const char *path)
+{
+  assert(t != NULL);
+  assert(path != NULL);
+
+  header_t h;
+  const dirent_t *dir;
+  struct stat st;
+  void *map;
+  uint32_t i;
+  int fd;
+
+  memset (t, 0, sizeof(*t));
+
+  fd = open (path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  if (fstat (fd, &st) != 0)
+    {
+      close (fd);
+      return false;
+    }
+  if ((size_t) st.st_size < sizeof(header_t))
+    {
+      close (fd);
+      errno = EINVAL;
+      return false;
+    }
+
+  // shared, so every process mapping the file uses the same pages
+  map = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  memcpy (&h, map, sizeof(h));
+  dir = (const dirent_t *) ((const uint8_t *) map + sizeof(header_t));
+
+  if (memcmp (h.magic, MAGIC, sizeof(h.magic)) != 0
+      || h.version != UINTN_TABLES_VERSION || h.bits != NUMBER_OF_BITS
+      || h.order != ORDER || h.size != (uint64_t) st.st_size
+      || h.count > (h.size - sizeof(header_t)) / sizeof(dirent_t))
+    {
+      munmap (map, st.st_size);
+      errno = EINVAL;
+      return false;
+    }
+
+  uint64_t sum = h.checksum;
+  h.checksum = 0;
+  if (checksum (checksum (0, &h, sizeof(h)), dir, h.count * sizeof(dirent_t))
+      != sum)
+    {
+      munmap (map, st.st_size);
+      errno = EINVAL;
+      return false;
+    }
+
+  for (i = 0; i < h.count; i++)
+    if (dir[i].offset % ALIGN != 0 || dir[i].length % sizeof(uint64_t) != 0
+	|| dir[i].offset > h.size || dir[i].length > h.size - dir[i].offset
+	|| dir[i].name[UINTN_TABLES_NAME - 1] != '\0')
+      {
+	munmap (map, st.st_size);
+	errno = EINVAL;
+	return false;
+      }
+
+  t->map = map;
+  t->size = st.st_size;
+  t->count = h.count;
+  return true;
+}
+
+void
+uintN_tables_close (uintN_tables_t *t)
+{
+  assert(t != NULL);
+
+  if (t->map != NULL)
+    munmap ((void *) t->map, t->size);
+  memset (t, 0, sizeof(*t));
+}
+
+/*
+ * record name of the given kind whose contents match its checksum, or
+ * NULL.
+ */
+static const dirent_t *
+lookup (const uintN_tables_t *t, const char *name, uint32_t kind)
+{
+  const dirent_t *dir;
+  uint32_t i;
+
+  if (t->map == NULL)
+    return NULL;
+
+  dir = (const dirent_t *) (t->map + sizeof(header_t));
+  for (i = 0; i < t->count; i++)
+    if (strcmp (dir[i].name, name) == 0)
+      {
+	if (dir[i].kind != kind
+	    || checksum (dir[i].length, t->map + dir[i].offset, dir[i].length)
+		!= dir[i].checksum)
+	  return NULL;
+	return &dir[i];
+      }
+  return NULL;
+}
+
+bool
+uintN_tables_mont (const uintN_tables_t *t, const char *name,
+		   uintN_mont_t *ctx)
+{
+  assert(t != NULL);
+  assert(name != NULL);
+  assert(ctx != NULL);
+
+  const dirent_t *d;
+
+  d = lookup (t, name, UINTN_TABLES_MONT);
+  if (d == NULL || d->length != sizeof(mont_rec_t))
+    return false;
+  return mont_load (ctx, (const mont_rec_t *) (t->map + d->offset));
+}
+
+bool
+uintN_tables_fb (const uintN_tables_t *t, const char *name, uintN_fb_t *fb)
+{
+  assert(t != NULL);
+  assert(name != NULL);
+  assert(fb != NULL);
+
+  const dirent_t *d;
+  const fb_rec_t *r;
+
+  d = lookup (t, name, UINTN_TABLES_FB);
+  if (d == NULL || d->length < FB_TABLE)
+    return false;
+  r = (const fb_rec_t *) (t->map + d->offset);
+
+  memset (fb, 0, sizeof(*fb));
+  if (r->teeth == 0 || r->teeth >= 16 || r->blocks == 0 || r->blocks > 0xff
+      || r->ebits == 0 || r->ebits > NUMBER_OF_BITS
+      || !mont_load (&fb->mont, &r->mont))
+    return false;
+
+  // the comb shape as uintN_fb_init derives it
+  fb->teeth = r->teeth;
+  fb->blocks = r->blocks;
+  if (r->a != (r->ebits + r->teeth - 1) / r->teeth
+      || r->b != (r->a + r->blocks - 1) / r->blocks
+      || r->blocks != (r->a + r->b - 1) / r->b
+      || d->length != FB_TABLE + UINTN_FB_TABLE_SIZE(fb) * sizeof(uint64_t))
+    {
+      memset (fb, 0, sizeof(*fb));
+      return false;
+    }
+
+  uintN_set (&fb->g, r->g.parts);
+  fb->ebits = r->ebits;
+  fb->a = r->a;
+  fb->b = r->b;
+  fb->table = (uint64_t *) (t->map + d->offset + FB_TABLE);
+  fb->mapped = true;
+  return true;
+}
@@ -0,0 +1,126 @@
+/*
+ * tables.h
+ *
+ * Header file for precomputed tables persisted to disk and mapped at
+ * startup.
+ *
+ * Fixed-base comb tables and Montgomery contexts of long-lived moduli are
+ * written once into a table file and every process then maps the file
+ * read-only instead of building them again. The comb tables are used in
+ * place, so the page cache holds a single physical copy however many
+ * processes map the file, and a process only pages in the tables it uses.
+ *
+ * The file is a header, a directory of named records and the records
+ * themselves, each 64-byte aligned:
+ *
+ *   header     magic, format version, NUMBER_OF_BITS and the byte order of
+ *              the writer, the record count, the file size and a checksum of
+ *              header and directory.
+ *   directory  per record its name, kind, offset, length and a checksum of
+ *              its contents.
+ *
+ * The limbs are stored in host order and a file only loads on a host and
+ * build with the same NUMBER_OF_BITS. uintN_tables_open checks the header
+ * and directory, a record is checked against its checksum when it is
+ * looked up. The checksums catch truncated and damaged files, they are not
+ * a MAC: the file must be as trusted as the binary.
+ *
+ * Files are written to a temporary name and renamed into place, a process
+ * opening the path sees either the old or the new file.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef TABLES_H_
+#define TABLES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "uintN.h"
+#include "montgomery.h"
+#include "fixedbase.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* format version, bumped on every incompatible change */
+#define UINTN_TABLES_VERSION 1
+
+/* longest record name including the terminating zero */
+#define UINTN_TABLES_NAME 32
+
+#define UINTN_TABLES_MONT 1
+#define UINTN_TABLES_FB 2
+
+typedef struct
+{
+  const char *name;
+  const uintN_mont_t *mont; /* one of mont and fb is set */
+  const uintN_fb_t *fb;
+} uintN_tables_rec_t;
+
+typedef struct
+{
+  const uint8_t *map;
+  size_t size;
+  uint32_t count;
+} uintN_tables_t;
+
+/**
+ * tables write the k records to a new table file at path, replacing an
+ * existing one atomically, readable by all (mode 0644). names must be unique.
+ * returns false with errno set if the file could not be written.
+ *
+ * The running time of implemented algorithm is O(size of the tables).
+ */
+bool
+uintN_tables_save (const char *path, const uintN_tables_rec_t *recs,
+		   size_t k);
+
+/**
+ * tables map the table file at path read-only.
+ * returns false with errno set if it could not be mapped, EINVAL if it is
+ * not a table file of this version, NUMBER_OF_BITS and byte order or its
+ * header does not match its checksum.
+ *
+ * The running time of implemented algorithm is O(number of records).
+ */
+bool
+uintN_tables_open (uintN_tables_t *t, const char *path);
+
+/**
+ * tables unmap, tables handed out by uintN_tables_fb become invalid.
+ */
+void
+uintN_tables_close (uintN_tables_t *t);
+
+/**
+ * tables Montgomery context named name, copied into ctx.
+ * returns false if there is no such record or it is damaged.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+bool
+uintN_tables_mont (const uintN_tables_t *t, const char *name,
+		   uintN_mont_t *ctx);
+
+/**
+ * tables fixed-base context named name, its comb table points into the
+ * mapping and stays valid until uintN_tables_close. uintN_fb_free on it
+ * leaves the table alone.
+ * returns false if there is no such record or it is damaged.
+ *
+ * The running time of implemented algorithm is O(size of the table) for
+ * the checksum.
+ */
+bool
+uintN_tables_fb (const uintN_tables_t *t, const char *name, uintN_fb_t *fb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TABLES_H_ */
@@ -0,0 +1,627 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#include "tune.h"
+#include "uintp.h"
+#include "ntt.h"
+#include "montgomery.h"
+#include "random.h"
+#include "workspace.h"
+
+#define MAGIC "uintN-tune"
+
+/* a timing is the best of ROUNDS rounds of at least ROUND_NS each */
+#define ROUNDS 3
+#define ROUND_NS 1000000ull
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+/* candidate crossovers in limbs and exponent lengths in bits, ascending */
+static const size_t mul_sizes[] =
+  { 128, 192, 256, 384, 512, 640, 768, 1024, 1536, 2048 };
+static const size_t divrem_sizes[] =
+  { 1024, 1536, 2048, 3072, 4096, 6144, 8192 };
+static const size_t exp_bits[] =
+  { 8, 16, 32, 64, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072,
+      4096, 6144, 8192 };
+
+static uintN_tune_t active;
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool
+valid (const uintN_tune_t *t)
+{
+  return t->ntt_mul >= 1 && t->ntt_divrem >= UINTN_TUNE_DIVREM_MIN
+      && t->window[1] == 0;
+}
+
+static void
+load_env (void)
+{
+  uintN_tune_t t;
+  const char *path;
+
+  uintN_tune_defaults (&active);
+  path = getenv (UINTN_TUNE_ENV);
+  if (path != NULL && *path != '\0' && uintN_tune_load (path, &t))
+    active = t;
+}
+
+void
+uintN_tune_defaults (uintN_tune_t *t)
+{
+  assert(t != NULL);
+
+  unsigned int w;
+
+  t->ntt_mul = UINTP_NTT_THRESHOLD;
+  t->ntt_divrem = UINTP_NTT_DIVREM_THRESHOLD;
+  for (w = 0; w <= UINTN_TUNE_WINDOW_MAX; w++)
+    t->window[w] = UINTN_TUNE_NEVER;
+  t->window[1] = 0;
+  t->window[3] = 32;
+  t->window[4] = 256;
+  t->window[5] = 768;
+}
+
+void
+uintN_tune_get (uintN_tune_t *t)
+{
+  assert(t != NULL);
+
+  unsigned int w;
+
+  pthread_once (&once, load_env);
+  t->ntt_mul = __atomic_load_n (&active.ntt_mul, __ATOMIC_RELAXED);
+  t->ntt_divrem = __atomic_load_n (&active.ntt_divrem, __ATOMIC_RELAXED);
+  for (w = 0; w <= UINTN_TUNE_WINDOW_MAX; w++)
+    t->window[w] = __atomic_load_n (&active.window[w], __ATOMIC_RELAXED);
+}
+
+bool
+uintN_tune_set (const uintN_tune_t *t)
+{
+  assert(t != NULL);
+
+  unsigned int w;
+
+  if (!valid (t))
+    return false;
+
+  pthread_once (&once, load_env);
+  pthread_mutex_lock (&lock);
+  __atomic_store_n (&active.ntt_mul, t->ntt_mul, __ATOMIC_RELAXED);
+  __atomic_store_n (&active.ntt_divrem, t->ntt_divrem, __ATOMIC_RELAXED);
+  for (w = 0; w <= UINTN_TUNE_WINDOW_MAX; w++)
+    __atomic_store_n (&active.window[w], t->window[w], __ATOMIC_RELAXED);
+  pthread_mutex_unlock (&lock);
+
+  return true;
+}
+
+unsigned int
+uintN_tune_window (size_t bits)
+{
+  unsigned int w, best = 1;
+
+  pthread_once (&once, load_env);
+  for (w = 2; w <= UINTN_TUNE_WINDOW_MAX; w++)
+    if (__atomic_load_n (&active.window[w], __ATOMIC_RELAXED) <= bits)
+      best = w;
+  return best;
+}
+
+static uint64_t
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/*
+ * ns per call of fn, the best of ROUNDS rounds. The round grows until it
+ * takes ROUND_NS, which also warms caches and branch predictors.
+ */
+static double
+bench (void
+(*fn) (void *), void *arg)
+{
+  uint64_t start, t, best;
+  unsigned long reps = 1, i;
+  unsigned int round;
+
+  for (;;)
+    {
+      start = now_ns ();
+      for (i = 0; i < reps; i++)
+	fn (arg);
+      best = now_ns () - start;
+      if (best >= ROUND_NS)
+	break;
+      reps *= 2;
+    }
+
+  for (round = 0; round < ROUNDS; round++)
+    {
+      start = now_ns ();
+      for (i = 0; i < reps; i++)
+	fn (arg);
+      t = now_ns () - start;
+      best = min(best, t);
+    }
+
+  return (double) best / reps;
+}
+
+typedef struct
+{
+  uint64_t *q, *r, *tp;
+  const uint64_t *a, *b;
+  size_t an, bn;
+  bool failed;
+} op_t;
+
+static void
+mul_school (void *arg)
+{
+  op_t *op = arg;
+
+  uintp_mul (op->r, op->a, op->an, op->b, op->bn);
+}
+
+static void
+mul_ntt (void *arg)
+{
+  op_t *op = arg;
+
+  uintp_mul_ntt (op->r, op->a, op->an, op->b, op->bn, op->tp);
+}
+
+static void
+divrem_knuth (void *arg)
+{
+  op_t *op = arg;
+
+  uintp_divrem (op->q, op->r, op->a, op->an, op->b, op->bn, op->tp);
+}
+
+static void
+divrem_newton (void *arg)
+{
+  op_t *op = arg;
+
+  if (!uintp_divrem_large (op->q, op->r, op->a, op->an, op->b, op->bn))
+    op->failed = true;
+}
+
+/*
+ * t->ntt_mul, the smallest candidate from which the transform wins at every
+ * larger candidate.
+ */
+static bool
+tune_mul (uintN_tune_t *t, FILE *log)
+{
+  size_t n = mul_sizes[COUNT(mul_sizes) - 1], i;
+  double school, ntt;
+  uint64_t *p;
+  op_t op;
+
+  p = malloc ((4 * n + uintp_mul_ntt_scratch (n, n)) * sizeof(uint64_t));
+  if (p == NULL)
+    return false;
+
+  memset (&op, 0, sizeof(op));
+  op.a = p;
+  op.b = p + n;
+  op.r = p + 2 * n;
+  op.tp = p + 4 * n;
+  uintN_rng_bytes (uintN_rng_thread (), p, 2 * n * sizeof(uint64_t));
+
+  t->ntt_mul = 2 * n;
+  for (i = COUNT(mul_sizes); i-- > 0;)
+    {
+      op.an = op.bn = mul_sizes[i];
+      school = bench (mul_school, &op);
+      ntt = bench (mul_ntt, &op);
+      if (log != NULL)
+	fprintf (log, "mul    %5zu limbs  schoolbook %12.0f ns  ntt    %12.0f ns\n",
+		 op.an, school, ntt);
+      if (ntt >= school)
+	break;
+      t->ntt_mul = op.an;
+    }
+
+  free (p);
+  return true;
+}
+
+/*
+ * t->ntt_divrem, the smallest candidate from which Newton division of 2c by
+ * c limbs wins at every larger candidate c. The trial profile puts the
+ * threshold at c, so the reciprocal takes one Newton step over Knuth's
+ * division of c / 2 limbs.
+ */
+static bool
+tune_divrem (uintN_tune_t *t, uintN_tune_t *trial, FILE *log)
+{
+  size_t n = divrem_sizes[COUNT(divrem_sizes) - 1], i;
+  double knuth, newton;
+  uint64_t *p;
+  op_t op;
+
+  p = malloc ((2 * n + n + (n + 1) + n + UINTP_DIVREM_SCRATCH(2 * n, n))
+      * sizeof(uint64_t));
+  if (p == NULL)
+    return false;
+
+  memset (&op, 0, sizeof(op));
+  op.a = p;
+  op.b = p + 2 * n;
+  op.q = p + 3 * n;
+  op.r = p + 4 * n + 1;
+  op.tp = p + 5 * n + 1;
+  uintN_rng_bytes (uintN_rng_thread (), p, 3 * n * sizeof(uint64_t));
+
+  t->ntt_divrem = 2 * n;
+  trial->ntt_mul = t->ntt_mul;
+  for (i = COUNT(divrem_sizes); i-- > 0 && !op.failed;)
+    {
+      op.bn = divrem_sizes[i];
+      op.an = 2 * op.bn;
+      p[2 * n + op.bn - 1] |= 1ull << 63;
+
+      trial->ntt_divrem = op.bn;
+      uintN_tune_set (trial);
+      knuth = bench (divrem_knuth, &op);
+      newton = bench (divrem_newton, &op);
+      if (log != NULL)
+	fprintf (log, "divrem %5zu limbs  knuth      %12.0f ns  newton %12.0f ns\n",
+		 op.bn, knuth, newton);
+      if (newton >= knuth)
+	break;
+      t->ntt_divrem = op.bn;
+    }
+
+  free (p);
+  return !op.failed;
+}
+
+typedef struct
+{
+  const uintN_mont_t *ctx;
+  const uintN_t *base;
+  const uintN_t *exp;
+  uintN_t *dest;
+  uintN_ws_t *ws;
+} modp_t;
+
+static void
+modp (void *arg)
+{
+  modp_t *op = arg;
+
+  uintN_mont_modp (op->ctx, op->base, op->exp, op->dest, op->ws);
+}
+
+/*
+ * t->window, the fastest width per candidate exponent length under a
+ * full-width modulus. The widths are made non-decreasing in the length
+ * against noise, a width then starts at the first length it won.
+ */
+static bool
+tune_window (uintN_tune_t *t, uintN_tune_t *trial, FILE *log)
+{
+  uintN_rng_t *rng = uintN_rng_thread ();
+  uintN_mont_t ctx;
+  uintN_t m, base, exp, dest;
+  size_t i, bits;
+  unsigned int w, best, prev = 1;
+  double ns, best_ns;
+  modp_t op =
+    { &ctx, &base, &exp, &dest, uintN_ws_thread () };
+
+  uintN_rng_bytes (rng, m.parts, NUMBER_OF_BYTES);
+  m.parts[0] |= 1;
+  m.parts[NUMBER_OF_PARTS - 1] |= 1ull << 63;
+  if (!uintN_mont_init (&ctx, &m))
+    return false;
+  uintN_rng_bytes (rng, base.parts, NUMBER_OF_BYTES);
+
+  for (w = 0; w <= UINTN_TUNE_WINDOW_MAX; w++)
+    t->window[w] = UINTN_TUNE_NEVER;
+  t->window[1] = 0;
+
+  for (i = 0; i < COUNT(exp_bits) && exp_bits[i] <= NUMBER_OF_BITS; i++)
+    {
+      bits = exp_bits[i];
+      // a random exponent of exactly bits bits
+      uintp_zero (exp.parts, NUMBER_OF_PARTS);
+      uintN_rng_bytes (rng, exp.parts, (bits + 7) / 8);
+      exp.parts[(bits - 1) / PART_SIZE_BITS] &= UINT64_MAX
+	  >> (PART_SIZE_BITS - 1 - (bits - 1) % PART_SIZE_BITS);
+      exp.parts[(bits - 1) / PART_SIZE_BITS] |= 1ull
+	  << ((bits - 1) % PART_SIZE_BITS);
+
+      best = 1;
+      best_ns = 0;
+      for (w = 1; w <= UINTN_TUNE_WINDOW_MAX; w++)
+	{
+	  trial->window[w] = 0;
+	  uintN_tune_set (trial);
+	  ns = bench (modp, &op);
+	  trial->window[w] = UINTN_TUNE_NEVER;
+	  trial->window[1] = 0;
+	  if (log != NULL)
+	    fprintf (log, "modp   %5zu bits   window %u   %12.0f ns\n", bits, w,
+		     ns);
+	  if (w == 1 || ns < best_ns)
+	    {
+	      best = w;
+	      best_ns = ns;
+	    }
+	}
+
+      best = max(best, prev);
+      if (best != prev || i == 0)
+	t->window[best] = i == 0 ? 0 : bits;
+      prev = best;
+    }
+
+  return true;
+}
+
+bool
+uintN_tune_run (uintN_tune_t *t, FILE *log)
+{
+  assert(t != NULL);
+
+  uintN_tune_t saved, trial;
+  unsigned int w;
+  bool ok;
+
+  uintN_tune_get (&saved);
+  uintN_tune_defaults (t);
+
+  // the trial profiles force one candidate at a time
+  trial = saved;
+  for (w = 2; w <= UINTN_TUNE_WINDOW_MAX; w++)
+    trial.window[w] = UINTN_TUNE_NEVER;
+
+  ok = tune_mul (t, log) && tune_divrem (t, &trial, log)
+      && tune_window (t, &trial, log);
+
+  uintN_tune_set (&saved);
+  return ok;
+}
+
+/*
+ * name of the processor from /proc/cpuinfo, false if there is none.
+ */
+static bool
+cpu_name (char *name, size_t size)
+{
+  char line[256], *s;
+  FILE *f;
+  bool found = false;
+
+  f = fopen ("/proc/cpuinfo", "r");
+  if (f == NULL)
+    return false;
+  while (!found && fgets (line, sizeof(line), f) != NULL)
+    if (strncmp (line, "model name", 10) == 0
+	&& (s = strchr (line, ':')) != NULL)
+      {
+	s += strspn (s + 1, " \t") + 1;
+	s[strcspn (s, "\n")] = '\0';
+	snprintf (name, size, "%s", s);
+	found = true;
+      }
+  fclose (f);
+  return found;
+}
+
+static void
+write_profile (FILE *f, const uintN_tune_t *t)
+{
+  char cpu[128];
+  unsigned int w;
+
+  if (cpu_name (cpu, sizeof(cpu)))
+    fprintf (f, "# %s\n", cpu);
+  fprintf (f, "%s %d\n", MAGIC, UINTN_TUNE_VERSION);
+  fprintf (f, "ntt_mul %zu\n", t->ntt_mul);
+  fprintf (f, "ntt_divrem %zu\n", t->ntt_divrem);
+  for (w = 1; w <= UINTN_TUNE_WINDOW_MAX; w++)
+    if (t->window[w] != UINTN_TUNE_NEVER)
+      fprintf (f, "window %u %zu\n", w, t->window[w]);
+}
+
+bool
+uintN_tune_save (const char *path, const uintN_tune_t *t)
+{
+  assert(path != NULL);
+  assert(t != NULL);
+
+  char *tmp;
+  FILE *f;
+  bool ok;
+  int fd, err;
+
+  if (!valid (t))
+    {
+      errno = EINVAL;
+      return false;
+    }
+
+  tmp = malloc (strlen (path) + 8);
+  if (tmp == NULL)
+    {
+      errno = ENOMEM;
+      return false;
+    }
+
+  // a temporary file in the same directory, renamed over path when complete,
+  // 0644 rather than the 0600 of mkstemp since every process using the
+  // library reads it
+  sprintf (tmp, "%s.XXXXXX", path);
+  fd = mkstemp (tmp);
+  f = fd < 0 ? NULL : fdopen (fd, "w");
+  if (f == NULL)
+    {
+      err = errno;
+      if (fd >= 0)
+	{
+	  close (fd);
+	  unlink (tmp);
+	}
+      free (tmp);
+      errno = err;
+      return false;
+    }
+
+  write_profile (f, t);
+  ok = !ferror (f) && fflush (f) == 0 && fsync (fd) == 0
+      && fchmod (fd, 0644) == 0;
+  err = errno;
+  ok = (fclose (f) == 0) && ok;
+  if (ok && rename (tmp, path) != 0)
+    {
+      err = errno;
+      ok = false;
+    }
+  if (!ok)
+    unlink (tmp);
+
+  free (tmp);
+  if (!ok)
+    errno = err;
+  return ok;
+}
+
+bool
+uintN_tune_load (const char *path, uintN_tune_t *t)
+{
+  assert(path != NULL);
+  assert(t != NULL);
+
+  uintN_tune_t p;
+  char line[256], *s, c;
+  unsigned int version, w, i;
+  bool header = false, windows = false, ok = true;
+  size_t v;
+  FILE *f;
+
+  f = fopen (path, "r");
+  if (f == NULL)
+    return false;
+
+  uintN_tune_defaults (&p);
+  while (ok && fgets (line, sizeof(line), f) != NULL)
+    {
+      if (strchr (line, '\n') == NULL && !feof (f))
+	{
+	  ok = false;
+	  break;
+	}
+      s = line + strspn (line, " \t");
+      if (*s == '#' || *s == '\n' || *s == '\0')
+	continue;
+
+      if (!header)
+	{
+	  ok = sscanf (s, MAGIC " %u %c", &version, &c) == 1
+	      && version == UINTN_TUNE_VERSION;
+	  header = true;
+	}
+      else if (sscanf (s, "ntt_mul %zu %c", &v, &c) == 1)
+	p.ntt_mul = v;
+      else if (sscanf (s, "ntt_divrem %zu %c", &v, &c) == 1)
+	p.ntt_divrem = v;
+      else if (sscanf (s, "window %u %zu %c", &w, &v, &c) == 2 && w >= 1
+	  && w <= UINTN_TUNE_WINDOW_MAX)
+	{
+	  // the window lines replace the default widths as a whole
+	  if (!windows)
+	    {
+	      for (i = 2; i <= UINTN_TUNE_WINDOW_MAX; i++)
+		p.window[i] = UINTN_TUNE_NEVER;
+	      windows = true;
+	    }
+	  p.window[w] = v;
+	}
+      else
+	ok = false;
+    }
+
+  if (ferror (f))
+    {
+      fclose (f);
+      errno = EIO;
+      return false;
+    }
+  fclose (f);
+
+  if (!ok || !header || !valid (&p))
+    {
+      errno = EINVAL;
+      return false;
+    }
+
+  *t = p;
+  return true;
+}
+
+static void
+usage (FILE *f, const char *name)
+{
+  fprintf (f, "usage: %s [profile]\n"
+	   "times the kernels on this machine and writes the tuning profile,\n"
+	   "to standard output without a path. Load it with %s=profile.\n",
+	   name, UINTN_TUNE_ENV);
+}
+
+int
+uintN_tune_main (int argc, char **argv, FILE *out)
+{
+  assert(argv != NULL);
+  assert(out != NULL);
+
+  uintN_tune_t t;
+
+  if (argc > 2 || (argc == 2 && argv[1][0] == '-'))
+    {
+      usage (argc == 2 && strcmp (argv[1], "-h") == 0 ? out : stderr,
+	     argv[0]);
+      return argc == 2 && strcmp (argv[1], "-h") == 0 ?
+	  EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+  if (!uintN_tune_run (&t, stderr))
+    {
+      fprintf (stderr, "%s: out of memory\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  if (argc == 1)
+    {
+      write_profile (out, &t);
+      return EXIT_SUCCESS;
+    }
+
+  if (!uintN_tune_save (argv[1], &t))
+    {
+      fprintf (stderr, "%s: %s: %s\n", argv[0], argv[1], strerror (errno));
+      return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
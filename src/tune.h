@@ -0,0 +1,143 @@
+/*
+ * tune.h
+ *
+ * Header file for the tuning profile, the machine-dependent thresholds of
+ * the library and their autotuner.
+ *
+ * The profile holds the crossovers that depend on the processor rather than
+ * on the numbers:
+ *
+ *   ntt_mul     limbs of the shorter operand from which uintp_mul_large uses
+ *               the number theoretic transform instead of uintp_mul.
+ *   ntt_divrem  limbs of divisor and quotient from which uintp_divrem_large
+ *               uses a Newton reciprocal instead of Knuth's division.
+ *   window      per window width w, the exponent length in bits from which
+ *               uintN_mont_modp and uintN_reducer_modp use a fixed window of
+ *               w bits.
+ *
+ * The defaults are the thresholds measured on the development machine.
+ * uintN_tune_run times the candidates on the current machine and returns a
+ * profile, uintN_tune_save writes it to a file. The library loads the
+ * profile named by the environment variable UINTN_TUNE_PROFILE the first
+ * time a threshold is needed; a missing or unreadable profile leaves the
+ * defaults in place.
+ *
+ * The profile is a text file of one setting per line, '#' starts a comment:
+ *
+ *   uintN-tune 1
+ *   ntt_mul 640
+ *   ntt_divrem 6144
+ *   window 1 0
+ *   window 3 32
+ *
+ * Window widths without a line are not used.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef TUNE_H_
+#define TUNE_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "uintN.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* format version, bumped on every incompatible change */
+#define UINTN_TUNE_VERSION 1
+
+/* environment variable naming the profile loaded at startup */
+#define UINTN_TUNE_ENV "UINTN_TUNE_PROFILE"
+
+/* widest exponentiation window, its 2^w table must fit the workspace */
+#define UINTN_TUNE_WINDOW_MAX 5
+
+/* smallest ntt_divrem, the Newton reciprocal recurses on half the limbs */
+#define UINTN_TUNE_DIVREM_MIN 16
+
+/* a window width that is never used */
+#define UINTN_TUNE_NEVER ((size_t) -1)
+
+typedef struct
+{
+  size_t ntt_mul;
+  size_t ntt_divrem;
+  size_t window[UINTN_TUNE_WINDOW_MAX + 1]; /* window[1] is 0, [0] unused */
+} uintN_tune_t;
+
+/**
+ * tune default profile.
+ */
+void
+uintN_tune_defaults (uintN_tune_t *t);
+
+/**
+ * tune copy of the profile in use, loaded from UINTN_TUNE_PROFILE on the
+ * first call.
+ */
+void
+uintN_tune_get (uintN_tune_t *t);
+
+/**
+ * tune make t the profile in use. Operations already running may still see
+ * the old thresholds, a mix of the two gives correct results.
+ * returns false if t is not a valid profile.
+ */
+bool
+uintN_tune_set (const uintN_tune_t *t);
+
+/**
+ * tune window width for an exponent of bits bits under the profile in use.
+ *
+ * The running time of implemented algorithm is O(1).
+ */
+unsigned int
+uintN_tune_window (size_t bits);
+
+/**
+ * tune time the candidate kernels on this machine and pick the thresholds
+ * into t, the measurements are written to log unless it is NULL.
+ * The trial profiles are made the profile in use while they are timed and
+ * the previous one is restored when done, it should run while nothing else
+ * uses the library.
+ * returns false if the scratch could not be allocated.
+ *
+ * The running time of implemented algorithm is about a second.
+ */
+bool
+uintN_tune_run (uintN_tune_t *t, FILE *log);
+
+/**
+ * tune write t to a new profile at path, replacing an existing one
+ * atomically, readable by all (mode 0644).
+ * returns false with errno set if the file could not be written.
+ */
+bool
+uintN_tune_save (const char *path, const uintN_tune_t *t);
+
+/**
+ * tune read the profile at path into t.
+ * returns false with errno set if it could not be read, EINVAL if it is not
+ * a valid profile of this version.
+ */
+bool
+uintN_tune_load (const char *path, uintN_tune_t *t);
+
+/**
+ * tune command line driver, tunes this machine and writes the profile to
+ * the path in argv or to out.
+ * returns the process exit status.
+ */
+int
+uintN_tune_main (int argc, char **argv, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TUNE_H_ */
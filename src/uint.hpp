@@ -0,0 +1,700 @@
+/*
+ * uint.hpp
+ *
+ * C++ front end for fixed-width unsigned integers on top of the limb
+ * kernels.
+ *
+ * uint_t<Bits> is a value type of Bits / 64 limbs, least significant first,
+ * with the usual arithmetic and comparison operators. It is trivially
+ * copyable, so passing and returning by value costs a copy of the limbs and
+ * nothing else, and converts to and from uintN_t for the C API.
+ *
+ * Products are expression templates: a * b yields a lazy product, a * b + c
+ * a lazy multiply-add. Assigned to a uint_t they are truncated to Bits like
+ * any other product, taken % m they are computed at double width and reduced
+ * once, so (a * b + c) % m costs one multiplication and one division with no
+ * temporaries in between. The lazy objects refer to their operands, they are
+ * meant to be consumed in the same expression and not stored with auto.
+ *
+ * Everything is constexpr. Evaluated at runtime the operators call the
+ * uintp kernels, evaluated at compile time they fall back to plain loops, so
+ * constant moduli and the Montgomery constants of mont_t can be folded into
+ * the binary:
+ *
+ *   constexpr auto p = uint_t<256>::from_hex ("ffffffff00000001...");
+ *   constexpr mont_t<256> ctx (p);
+ *
+ * Needs C++20 for std::is_constant_evaluated.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef UINT_HPP_
+#define UINT_HPP_
+
+#if __cplusplus < 202002L
+#error "uint.hpp needs C++20"
+#endif
+
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "uintN.h"
+#include "uintp.h"
+
+namespace uintn
+{
+
+namespace detail
+{
+
+typedef unsigned __int128 uint128_t;
+
+/*
+ * constexpr counterparts of the uintp kernels, every routine picks the
+ * kernel at runtime and the loop while constant evaluated.
+ */
+
+constexpr uint64_t
+add_n (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+{
+  if (!std::is_constant_evaluated ())
+    return uintp_add_n (r, a, b, n);
+
+  uint64_t c = 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      uint128_t t = (uint128_t) a[i] + b[i] + c;
+      r[i] = (uint64_t) t;
+      c = (uint64_t) (t >> 64);
+    }
+  return c;
+}
+
+constexpr uint64_t
+sub_n (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+{
+  if (!std::is_constant_evaluated ())
+    return uintp_sub_n (r, a, b, n);
+
+  uint64_t c = 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      uint128_t t = (uint128_t) a[i] - b[i] - c;
+      r[i] = (uint64_t) t;
+      c = (uint64_t) (t >> 64) & 0x01;
+    }
+  return c;
+}
+
+constexpr int
+cmp (const uint64_t *a, const uint64_t *b, size_t n)
+{
+  if (!std::is_constant_evaluated ())
+    return uintp_cmp (a, b, n);
+
+  while (n-- > 0)
+    if (a[n] != b[n])
+      return a[n] > b[n] ? 1 : -1;
+  return 0;
+}
+
+/*
+ * r = a if mask is all ones, r = b if mask is zero, without a branch.
+ */
+constexpr void
+cselect (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n,
+	 uint64_t mask)
+{
+  if (!std::is_constant_evaluated ())
+    return uintp_cselect (r, a, b, n, mask);
+
+  for (size_t i = 0; i < n; i++)
+    r[i] = b[i] ^ ((a[i] ^ b[i]) & mask);
+}
+
+constexpr size_t
+normalize (const uint64_t *a, size_t n)
+{
+  while (n > 0 && a[n - 1] == 0)
+    n--;
+  return n;
+}
+
+/*
+ * r = a * b, r holds an + bn limbs and must not overlap a or b.
+ */
+constexpr void
+mul (uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b,
+     size_t bn)
+{
+  for (size_t i = 0; i < an + bn; i++)
+    r[i] = 0;
+  an = normalize (a, an);
+  bn = normalize (b, bn);
+  if (an == 0 || bn == 0)
+    return;
+
+  if (!std::is_constant_evaluated ())
+    {
+      if (a == b && an == bn)
+	uintp_sqr (r, a, an);
+      else
+	uintp_mul (r, a, an, b, bn);
+      return;
+    }
+
+  for (size_t i = 0; i < an; i++)
+    {
+      uint64_t c = 0;
+      for (size_t j = 0; j < bn; j++)
+	{
+	  uint128_t t = (uint128_t) a[i] * b[j] + r[i + j] + c;
+	  r[i + j] = (uint64_t) t;
+	  c = (uint64_t) (t >> 64);
+	}
+      r[i + bn] = c;
+    }
+}
+
+/*
+ * q = a / d if Q and r = a % d if R for an AN-limb a and a DN-limb d != 0, q
+ * holds AN limbs and r DN limbs. neither may overlap a or d.
+ */
+template<size_t AN, size_t DN, bool Q, bool R>
+  constexpr void
+  divrem (uint64_t *q, uint64_t *r, const uint64_t *a, const uint64_t *d)
+  {
+    size_t an = normalize (a, AN), dn = normalize (d, DN);
+    assert(dn > 0);
+
+    if constexpr (Q)
+      for (size_t i = 0; i < AN; i++)
+	q[i] = 0;
+    if constexpr (R)
+      for (size_t i = 0; i < DN; i++)
+	r[i] = an < dn && i < an ? a[i] : 0;
+    if (an < dn)
+      return;
+
+    if (!std::is_constant_evaluated ())
+      {
+	uint64_t tp[UINTP_DIVREM_SCRATCH(AN, DN)];
+	uintp_divrem (Q ? q : NULL, R ? r : NULL, a, an, d, dn, tp);
+	return;
+      }
+
+    // one bit at a time, rem stays below 2 d
+    uint64_t rem[DN + 1] = { }, dd[DN + 1] = { };
+    for (size_t i = 0; i < dn; i++)
+      dd[i] = d[i];
+
+    for (size_t i = an * 64; i-- > 0;)
+      {
+	for (size_t j = DN; j > 0; j--)
+	  rem[j] = (rem[j] << 1) | (rem[j - 1] >> 63);
+	rem[0] = (rem[0] << 1) | ((a[i / 64] >> (i % 64)) & 0x01);
+	if (cmp (rem, dd, DN + 1) >= 0)
+	  {
+	    sub_n (rem, rem, dd, DN + 1);
+	    if constexpr (Q)
+	      q[i / 64] |= 1ull << (i % 64);
+	  }
+      }
+    if constexpr (R)
+      for (size_t i = 0; i < DN; i++)
+	r[i] = rem[i];
+  }
+
+/*
+ * r = a % d as divrem.
+ */
+template<size_t AN, size_t DN>
+  constexpr void
+  mod (uint64_t *r, const uint64_t *a, const uint64_t *d)
+  {
+    divrem<AN, DN, false, true> (r, r, a, d);
+  }
+
+} // namespace detail
+
+template<size_t Bits>
+  class uint_t
+  {
+    static_assert(Bits > 0 && Bits % 64 == 0, "Bits must be whole limbs");
+
+  public:
+    static constexpr size_t limbs = Bits / 64;
+
+    uint64_t parts[limbs] = { };
+
+    class product;
+    class muladd;
+
+    constexpr
+    uint_t () = default;
+
+    constexpr
+    uint_t (uint64_t v)
+    {
+      parts[0] = v;
+    }
+
+    /**
+     * uint_t from the low limbs of a uintN_t, zero extended if Bits is
+     * larger.
+     */
+    explicit constexpr
+    uint_t (const uintN_t &a)
+    {
+      for (size_t i = 0; i < limbs && i < NUMBER_OF_PARTS; i++)
+	parts[i] = a.parts[i];
+    }
+
+    /**
+     * uint_t to a uintN_t for the C API, truncated to NUMBER_OF_BITS.
+     */
+    constexpr uintN_t
+    to_uintN () const
+    {
+      uintN_t r = { };
+      for (size_t i = 0; i < limbs && i < NUMBER_OF_PARTS; i++)
+	r.parts[i] = parts[i];
+      return r;
+    }
+
+    /**
+     * uint_t from hex digits, an optional 0x prefix and ' separators are
+     * skipped. the value must fit in Bits.
+     */
+    static constexpr uint_t
+    from_hex (std::string_view s)
+    {
+      uint_t r;
+      size_t bit = 0;
+
+      if (s.size () >= 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+	s.remove_prefix (2);
+
+      for (size_t i = s.size (); i-- > 0;)
+	{
+	  char ch = s[i];
+	  uint64_t v;
+
+	  if (ch == '\'')
+	    continue;
+	  if (ch >= '0' && ch <= '9')
+	    v = ch - '0';
+	  else if (ch >= 'a' && ch <= 'f')
+	    v = ch - 'a' + 10;
+	  else if (ch >= 'A' && ch <= 'F')
+	    v = ch - 'A' + 10;
+	  else
+	    {
+	      assert(!"not a hex digit");
+	      continue;
+	    }
+
+	  if (bit >= Bits)
+	    {
+	      assert(v == 0);
+	      continue;
+	    }
+	  r.parts[bit / 64] |= v << (bit % 64);
+	  bit += 4;
+	}
+      return r;
+    }
+
+    constexpr bool
+    iszero () const
+    {
+      return detail::normalize (parts, limbs) == 0;
+    }
+
+    constexpr bool
+    isodd () const
+    {
+      return parts[0] & 0x01;
+    }
+
+    /**
+     * number of significant bits, 0 for zero.
+     */
+    constexpr size_t
+    bits () const
+    {
+      size_t n = detail::normalize (parts, limbs);
+      return n == 0 ? 0 : 64 * n - __builtin_clzll (parts[n - 1]);
+    }
+
+    constexpr bool
+    bit (size_t i) const
+    {
+      return (parts[i / 64] >> (i % 64)) & 0x01;
+    }
+
+    friend constexpr bool
+    operator== (const uint_t &a, const uint_t &b) = default;
+
+    friend constexpr std::strong_ordering
+    operator<=> (const uint_t &a, const uint_t &b)
+    {
+      return detail::cmp (a.parts, b.parts, limbs) <=> 0;
+    }
+
+    friend constexpr uint_t
+    operator+ (const uint_t &a, const uint_t &b)
+    {
+      uint_t r;
+      detail::add_n (r.parts, a.parts, b.parts, limbs);
+      return r;
+    }
+
+    friend constexpr uint_t
+    operator- (const uint_t &a, const uint_t &b)
+    {
+      uint_t r;
+      detail::sub_n (r.parts, a.parts, b.parts, limbs);
+      return r;
+    }
+
+    friend constexpr product
+    operator* (const uint_t &a, const uint_t &b)
+    {
+      return product (a, b);
+    }
+
+    friend constexpr uint_t
+    operator/ (const uint_t &a, const uint_t &b)
+    {
+      uint_t q;
+      detail::divrem<limbs, limbs, true, false> (q.parts, q.parts, a.parts,
+						 b.parts);
+      return q;
+    }
+
+    friend constexpr uint_t
+    operator% (const uint_t &a, const uint_t &b)
+    {
+      uint_t r;
+      detail::mod<limbs, limbs> (r.parts, a.parts, b.parts);
+      return r;
+    }
+
+    friend constexpr uint_t
+    operator<< (const uint_t &a, size_t cnt)
+    {
+      uint_t r;
+      size_t w = cnt / 64, s = cnt % 64;
+
+      for (size_t i = limbs; i-- > w;)
+	{
+	  r.parts[i] = a.parts[i - w] << s;
+	  if (s != 0 && i > w)
+	    r.parts[i] |= a.parts[i - w - 1] >> (64 - s);
+	}
+      return r;
+    }
+
+    friend constexpr uint_t
+    operator>> (const uint_t &a, size_t cnt)
+    {
+      uint_t r;
+      size_t w = cnt / 64, s = cnt % 64;
+
+      for (size_t i = 0; i + w < limbs; i++)
+	{
+	  r.parts[i] = a.parts[i + w] >> s;
+	  if (s != 0 && i + w + 1 < limbs)
+	    r.parts[i] |= a.parts[i + w + 1] << (64 - s);
+	}
+      return r;
+    }
+
+    constexpr uint_t &
+    operator+= (const uint_t &b)
+    {
+      detail::add_n (parts, parts, b.parts, limbs);
+      return *this;
+    }
+
+    constexpr uint_t &
+    operator-= (const uint_t &b)
+    {
+      detail::sub_n (parts, parts, b.parts, limbs);
+      return *this;
+    }
+
+    constexpr uint_t &
+    operator*= (const uint_t &b)
+    {
+      return *this = *this * b;
+    }
+
+    constexpr uint_t &
+    operator/= (const uint_t &b)
+    {
+      return *this = *this / b;
+    }
+
+    constexpr uint_t &
+    operator%= (const uint_t &b)
+    {
+      return *this = *this % b;
+    }
+
+    constexpr uint_t &
+    operator<<= (size_t cnt)
+    {
+      return *this = *this << cnt;
+    }
+
+    constexpr uint_t &
+    operator>>= (size_t cnt)
+    {
+      return *this = *this >> cnt;
+    }
+  };
+
+/**
+ * lazy a * b, truncated to Bits when converted, reduced at double width
+ * when taken modulo.
+ */
+template<size_t Bits>
+  class uint_t<Bits>::product
+  {
+  public:
+    constexpr
+    product (const uint_t &a, const uint_t &b) :
+	a (a), b (b)
+    {
+    }
+
+    /**
+     * full product in 2 limbs + 1, the top limb is zero and left for the
+     * carry of a sum.
+     */
+    constexpr void
+    wide (uint64_t *r) const
+    {
+      detail::mul (r, a.parts, limbs, b.parts, limbs);
+      r[2 * limbs] = 0;
+    }
+
+    constexpr
+    operator uint_t () const
+    {
+      uint_t r;
+      if (std::is_constant_evaluated ())
+	{
+	  uint64_t t[2 * limbs + 1];
+	  wide (t);
+	  for (size_t i = 0; i < limbs; i++)
+	    r.parts[i] = t[i];
+	}
+      else
+	uintp_mullo_n (r.parts, a.parts, b.parts, limbs);
+      return r;
+    }
+
+    friend constexpr muladd
+    operator+ (const product &p, const uint_t &c)
+    {
+      return muladd (p, c);
+    }
+
+    friend constexpr muladd
+    operator+ (const uint_t &c, const product &p)
+    {
+      return muladd (p, c);
+    }
+
+    friend constexpr uint_t
+    operator% (const product &p, const uint_t &m)
+    {
+      uint64_t t[2 * limbs + 1];
+      uint_t r;
+
+      p.wide (t);
+      detail::mod<2 * limbs + 1, limbs> (r.parts, t, m.parts);
+      return r;
+    }
+
+  private:
+    const uint_t &a;
+    const uint_t &b;
+  };
+
+/**
+ * lazy a * b + c, truncated to Bits when converted, reduced at double width
+ * when taken modulo.
+ */
+template<size_t Bits>
+  class uint_t<Bits>::muladd
+  {
+  public:
+    constexpr
+    muladd (const product &p, const uint_t &c) :
+	p (p), c (c)
+    {
+    }
+
+    constexpr
+    operator uint_t () const
+    {
+      return uint_t (p) + c;
+    }
+
+    friend constexpr uint_t
+    operator% (const muladd &e, const uint_t &m)
+    {
+      uint64_t t[2 * limbs + 1], c[2 * limbs + 1] = { };
+      uint_t r;
+
+      e.p.wide (t);
+      for (size_t i = 0; i < limbs; i++)
+	c[i] = e.c.parts[i];
+      detail::add_n (t, t, c, 2 * limbs + 1);
+      detail::mod<2 * limbs + 1, limbs> (r.parts, t, m.parts);
+      return r;
+    }
+
+  private:
+    product p;
+    const uint_t &c;
+  };
+
+/**
+ * Montgomery multiplication modulo an odd m < 2^Bits with R = 2^Bits. The
+ * constructor computes -m^-1 mod 2^64, R mod m and R^2 mod m, constexpr for
+ * a constant m. Multiplication is the CIOS loop over a fixed number of
+ * limbs, which the compiler unrolls.
+ */
+template<size_t Bits>
+  class mont_t
+  {
+  public:
+    typedef uint_t<Bits> value_type;
+    static constexpr size_t limbs = value_type::limbs;
+
+    explicit constexpr
+    mont_t (const value_type &m) :
+	m (m)
+    {
+      assert(m.isodd ());
+
+      // m is its own inverse mod 8, every Newton step doubles the bits
+      uint64_t w = m.parts[0];
+      for (int i = 0; i < 5; i++)
+	w *= 2 - m.parts[0] * w;
+      minv = -w;
+
+      // R mod m = (R - m) mod m, R^2 mod m from 2^(2 Bits)
+      one = (value_type () - m) % m;
+      uint64_t t[2 * limbs + 1] = { };
+      t[2 * limbs] = 1;
+      detail::mod<2 * limbs + 1, limbs> (rr.parts, t, m.parts);
+    }
+
+    constexpr const value_type &
+    modulus () const
+    {
+      return m;
+    }
+
+    /**
+     * a b R^-1 (mod m) for a, b < m.
+     */
+    constexpr value_type
+    mul (const value_type &a, const value_type &b) const
+    {
+      uint64_t t[limbs + 2] = { };
+      value_type r;
+
+      for (size_t i = 0; i < limbs; i++)
+	{
+	  detail::uint128_t c = 0;
+	  for (size_t j = 0; j < limbs; j++)
+	    {
+	      c += (detail::uint128_t) a.parts[j] * b.parts[i] + t[j];
+	      t[j] = (uint64_t) c;
+	      c >>= 64;
+	    }
+	  c += t[limbs];
+	  t[limbs] = (uint64_t) c;
+	  t[limbs + 1] = (uint64_t) (c >> 64);
+
+	  uint64_t q = t[0] * minv;
+	  c = (detail::uint128_t) q * m.parts[0] + t[0];
+	  c >>= 64;
+	  for (size_t j = 1; j < limbs; j++)
+	    {
+	      c += (detail::uint128_t) q * m.parts[j] + t[j];
+	      t[j - 1] = (uint64_t) c;
+	      c >>= 64;
+	    }
+	  c += t[limbs];
+	  t[limbs - 1] = (uint64_t) c;
+	  t[limbs] = t[limbs + 1] + (uint64_t) (c >> 64);
+	}
+
+      // t < 2m, the difference is kept unless it borrowed past the carry
+      // limb, selected with a mask as in uintN_mont_redc
+      value_type s;
+      uint64_t borrow = detail::sub_n (s.parts, t, m.parts, limbs);
+      detail::cselect (r.parts, s.parts, t, limbs,
+		       -(t[limbs] | (borrow ^ 1)));
+      return r;
+    }
+
+    /**
+     * a R (mod m) for a < m.
+     */
+    constexpr value_type
+    to (const value_type &a) const
+    {
+      return mul (a, rr);
+    }
+
+    /**
+     * a R^-1 (mod m).
+     */
+    constexpr value_type
+    from (const value_type &a) const
+    {
+      return mul (a, value_type (1));
+    }
+
+    /**
+     * b^e (mod m) for b < m, plain in and out. left-to-right binary, the
+     * running time depends on e.
+     */
+    constexpr value_type
+    pow (const value_type &b, const value_type &e) const
+    {
+      value_type x = to (b), r = one;
+
+      for (size_t i = e.bits (); i-- > 0;)
+	{
+	  r = mul (r, r);
+	  if (e.bit (i))
+	    r = mul (r, x);
+	}
+      return from (r);
+    }
+
+  private:
+    value_type m;
+    value_type one;
+    value_type rr;
+    uint64_t minv = 0;
+  };
+
+} // namespace uintn
+
+#endif /* UINT_HPP_ */
@@ -5,9 +5,12 @@
 #include <inttypes.h>
 
 #include "uintN.h"
+#include "uintp.h"
+#include "workspace.h"
+#include "montgomery.h"
+#include "reducer.h"
+#include "modcache.h"
 
-const static uintN_t ZERO =
-  { 0 };
 const static uintN_t ONE =
   { 1 };
 
@@ -20,45 +23,31 @@ uintN_isequal (const uintN_t *a, const uintN_t *b)
   return memcmp (a->parts, b->parts, NUMBER_OF_BYTES) == 0;
 }
 
-static bool
-uintN_isgreater_n (const uintN_t *a, const uintN_t *b, const bool eq)
+int
+uintN_cmp (const uintN_t *a, const uintN_t *b)
 {
   assert(a != NULL);
   assert(b != NULL);
 
-  uint16_t i;
-  uint64_t ai, bi;
-  for (i = NUMBER_OF_PARTS; i > 0;)
-    {
-      ai = a->parts[--i];
-      bi = b->parts[i];
-
-      if (ai == bi)
-	continue;
-      else if (ai > bi)
-	return 1;
-      else
-	return 0;
-    }
-  return eq;
+  return uintp_cmp_ct (a->parts, b->parts, NUMBER_OF_PARTS);
 }
 
 bool
 uintN_isgreatoreq (const uintN_t *a, const uintN_t *b)
 {
-  return uintN_isgreater_n (a, b, 1);
+  return uintN_cmp (a, b) >= 0;
 }
 
 bool
 uintN_isgreat (const uintN_t *a, const uintN_t *b)
 {
-  return uintN_isgreater_n (a, b, 0);
+  return uintN_cmp (a, b) > 0;
 }
 
 bool
 uintN_isless (const uintN_t *a, const uintN_t *b)
 {
-  return uintN_isgreat (a, b) == 0;
+  return uintN_cmp (a, b) < 0;
 }
 
 bool
@@ -72,7 +61,9 @@ uintN_isodd (const uintN_t *bn)
 bool
 uintN_iseven (const uintN_t *bn)
 {
-  return uintN_isodd (bn) == 0;
+  assert(bn != NULL);
+
+  return (bn->parts[0] & 0x01) == 0;
 }
 
 bool
@@ -80,7 +71,7 @@ uintN_iszero (const uintN_t *bn)
 {
   assert(bn != NULL);
 
-  return memcmp (bn->parts, ZERO.parts, NUMBER_OF_BYTES) == 0;
+  return uintp_normalize (bn->parts, NUMBER_OF_PARTS) == 0;
 }
 
 bool
@@ -107,20 +98,22 @@ uintN_add (const uintN_t *a, const uintN_t *b, uintN_t *c)
   assert(b != NULL);
   assert(c != NULL);
 
-  uint16_t i;
-  uint64_t sum, carry;
-
-  for (i = 0, carry = 0; i < NUMBER_OF_PARTS; i++)
-    {
-      carry |= __builtin_uaddll_overflow (a->parts[i], carry, &sum);
-      carry |= __builtin_uaddll_overflow (sum, b->parts[i], &c->parts[i]);
-    }
+  uintp_add_n (c->parts, a->parts, b->parts, NUMBER_OF_PARTS);
 }
 
 void
 uintN_inc (uintN_t *bn)
 {
-  uintN_add (bn, &ONE, bn);
+  uintN_add_ui (bn, 1, bn);
+}
+
+void
+uintN_add_ui (const uintN_t *a, uint64_t b, uintN_t *c)
+{
+  assert(a != NULL);
+  assert(c != NULL);
+
+  uintp_add_1 (c->parts, a->parts, NUMBER_OF_PARTS, b);
 }
 
 void
@@ -130,147 +123,267 @@ uintN_sub (const uintN_t *a, const uintN_t *b, uintN_t *c)
   assert(b != NULL);
   assert(c != NULL);
 
-  uint16_t i;
-  uint64_t sum, carry;
-
-  for (i = 0, carry = 0; i < NUMBER_OF_PARTS; i++)
-    {
-      carry |= __builtin_usubll_overflow (a->parts[i], carry, &sum);
-      carry |= __builtin_usubll_overflow (sum, b->parts[i], &c->parts[i]);
-    }
+  uintp_sub_n (c->parts, a->parts, b->parts, NUMBER_OF_PARTS);
 }
 
 void
 uintN_dec (uintN_t *bn)
 {
-  uintN_sub (bn, &ONE, bn);
+  uintN_sub_ui (bn, 1, bn);
 }
 
-static void
-shift_and_add (const uintN_t *a, const uintN_t *b, uintN_t *dest)
+void
+uintN_sub_ui (const uintN_t *a, uint64_t b, uintN_t *c)
 {
-  // assert not needed.
+  assert(a != NULL);
+  assert(c != NULL);
 
-  // SENSITIVE -> zeroize after use
-  uintN_t _a;
-  uintN_t _b;
+  uintp_sub_1 (c->parts, a->parts, NUMBER_OF_PARTS, b);
+}
 
-  uintN_set (&_a, a->parts);
-  uintN_set (&_b, b->parts);
+void
+uintN_mul_ui (const uintN_t *a, uint64_t b, uintN_t *c)
+{
+  assert(a != NULL);
+  assert(c != NULL);
 
-  uintN_zeroize (dest);
+  size_t n = uintp_normalize (a->parts, NUMBER_OF_PARTS);
 
-  while (!uintN_iszero (&_a))
+  // only the significant limbs are multiplied, the carry lands above them
+  if (n < NUMBER_OF_PARTS)
     {
-      if (uintN_isodd (&_a))
-	uintN_add (&_b, dest, dest);
-
-      uintN_rshift (&_a, 1, &_a);
-      uintN_lshift (&_b, 1, &_b);
+      c->parts[n] = uintp_mul_1 (c->parts, a->parts, n, b);
+      uintp_zero (c->parts + n + 1, NUMBER_OF_PARTS - n - 1);
     }
+  else
+    uintp_mul_1 (c->parts, a->parts, n, b);
+}
+
+uint64_t
+uintN_divmod_ui (const uintN_t *a, uint64_t d, uintN_t *q)
+{
+  assert(a != NULL);
+  assert(d != 0);
+
+  size_t n = uintp_normalize (a->parts, NUMBER_OF_PARTS);
+  uint64_t rem;
+
+  rem = uintp_divrem_1 (q != NULL ? q->parts : NULL, a->parts, n, d);
+  if (q != NULL)
+    uintp_zero (q->parts + n, NUMBER_OF_PARTS - n);
+  return rem;
+}
+
+uint64_t
+uintN_mod_ui (const uintN_t *a, uint64_t d)
+{
+  return uintN_divmod_ui (a, d, NULL);
+}
+
+static void
+product_scanning (const uintN_t *a, const uintN_t *b, uintN_t *dest,
+		  uintN_ws_t *ws)
+{
+  // assert not needed.
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *c = uintN_ws_alloc (ws, NUMBER_OF_PARTS);
 
-  // zeroize
-  uintN_zeroize (&_a);
-  uintN_zeroize (&_b);
+  uintp_mullo_n (c, a->parts, b->parts, NUMBER_OF_PARTS);
+  uintp_copy (dest->parts, c, NUMBER_OF_PARTS);
+
+  uintN_ws_release (ws, mark);
 }
 
 void
-uintN_mul (const uintN_t *a, const uintN_t *b, uintN_t *dest)
+uintN_mul_ws (const uintN_t *a, const uintN_t *b, uintN_t *dest,
+	      uintN_ws_t *ws)
 {
   assert(a != NULL);
   assert(b != NULL);
   assert(dest != NULL);
+  assert(ws != NULL);
 
-  shift_and_add (a, b, dest);
+  product_scanning (a, b, dest, ws);
 }
 
 void
-uintN_gcd (const uintN_t *a, const uintN_t *b, uintN_t *c)
+uintN_mul (const uintN_t *a, const uintN_t *b, uintN_t *dest)
+{
+  uintN_mul_ws (a, b, dest, uintN_ws_thread ());
+}
+
+/*
+ * (a, b) = (min(a, b), |b - a|) in one subtraction. a > b about half the
+ * time on random data, too often to branch on: a borrow is turned into a
+ * mask that adds the difference back onto a and negates it in b.
+ */
+static void
+gcd_step (uint64_t *a, uint64_t *b, size_t n)
+{
+  size_t i;
+  uint64_t mask, c1, c2, d;
+
+  mask = -uintp_sub_n (b, b, a, n);
+  for (i = 0, c1 = 0, c2 = mask & 1; i < n; i++)
+    {
+      d = b[i];
+      c1 = __builtin_add_overflow (a[i], c1, &a[i]);
+      c1 |= __builtin_add_overflow (a[i], d & mask, &a[i]);
+      c2 = __builtin_add_overflow (d ^ mask, c2, &b[i]);
+    }
+}
+
+void
+uintN_gcd_ws (const uintN_t *a, const uintN_t *b, uintN_t *c, uintN_ws_t *ws)
 {
   assert(a != NULL);
   assert(b != NULL);
   assert(c != NULL);
+  assert(ws != NULL);
 
   if (uintN_iszero (a))
-    uintN_set (c, b->parts);
+    {
+      uintN_set (c, b->parts);
+      return;
+    }
   if (uintN_iszero (b))
-    uintN_set (c, a->parts);
-  if (uintN_isequal (a, c))
-    return;
-  else if (uintN_isequal (b, c))
-    return;
+    {
+      uintN_set (c, a->parts);
+      return;
+    }
 
-  // SENSITIVE -> zeroize after use
-  uintN_t _a;
-  uintN_t _b;
+  size_t mark = uintN_ws_mark (ws);
+  uintN_t *_a = uintN_ws_alloc_N (ws);
+  uintN_t *_b = uintN_ws_alloc_N (ws);
 
-  uintN_set (&_a, a->parts);
-  uintN_set (&_b, b->parts);
+  uintN_set (_a, a->parts);
+  uintN_set (_b, b->parts);
 
   uint16_t i;
-  for (i = 0; (uintN_iseven (&_a) && uintN_iseven (&_b)); ++i)
+  for (i = 0; (uintN_iseven (_a) && uintN_iseven (_b)); ++i)
     {
-      uintN_rshift (&_a, 1, &_a);
-      uintN_rshift (&_b, 1, &_b);
+      uintN_rshift (_a, 1, _a);
+      uintN_rshift (_b, 1, _b);
     }
 
-  while (!uintN_isodd (&_a))
-    uintN_rshift (&_a, 1, &_a);
+  while (!uintN_isodd (_a))
+    uintN_rshift (_a, 1, _a);
+
+  size_t n = NUMBER_OF_PARTS, nb;
+  unsigned int cnt;
 
   do
     {
-      while (!uintN_isodd (&_b))
-	uintN_rshift (&_b, 1, &_b);
+      // both only shrink, the limbs above the larger one stay zero
+      nb = uintp_normalize (_b->parts, n);
+      n = uintp_normalize (_a->parts, n);
+      n = n > nb ? n : nb;
+
+      while (!uintN_isodd (_b))
+	{
+	  cnt = _b->parts[0] ? __builtin_ctzll (_b->parts[0]) : 63;
+	  uintp_rshift (_b->parts, _b->parts, n, cnt);
+	}
 
-      if (uintN_isgreat (&_a, &_b))
-	uintN_swap (&_a, &_b);
-      uintN_sub (&_b, &_a, &_b);
+      gcd_step (_a->parts, _b->parts, n);
     }
-  while (!uintN_iszero (&_b));
-
-  uintN_lshift (&_a, i, c);
-
-  // zeroize
-  uintN_zeroize (&_a);
-  uintN_zeroize (&_b);
-}
-
-// https://en.wikipedia.org/wiki/Division_algorithm
-//if D = 0 then error(DivisionByZeroException) end
-//Q := 0                 -- initialize quotient and remainder to zero
-//R := 0
-//for i := n − 1 ... 0 do     -- where n is number of bits in N
-//  R := R << 1          -- left-shift R by 1 bit
-//  R(0) := N(i)         -- set the least-significant bit of R equal to bit i of the numerator
-//  if R ≥ D then
-//    R := R − D
-//    Q(i) := 1
-//  end
-//end
+  while (uintp_normalize (_b->parts, n) != 0);
+
+  uintN_lshift (_a, i, c);
+
+  uintN_ws_release (ws, mark);
+}
+
 void
-uintN_div (const uintN_t *a, const uintN_t *b, uintN_t *c)
+uintN_gcd (const uintN_t *a, const uintN_t *b, uintN_t *c)
+{
+  uintN_gcd_ws (a, b, c, uintN_ws_thread ());
+}
+
+static void
+divrem (const uintN_t *a, const uintN_t *b, uintN_t *q, uintN_t *r,
+	uintN_ws_t *ws)
+{
+  // assert not needed.
+
+  size_t an, bn;
+
+  an = uintp_normalize (a->parts, NUMBER_OF_PARTS);
+  bn = uintp_normalize (b->parts, NUMBER_OF_PARTS);
+  assert(bn > 0);
+
+  if (an < bn)
+    {
+      // a < b, q = 0 and r = a
+      if (r != NULL)
+	uintN_set (r, a->parts);
+      if (q != NULL)
+	uintN_zeroize (q);
+      return;
+    }
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *tp = uintN_ws_alloc (ws, UINTP_DIVREM_SCRATCH(an, bn));
+  uintN_t *_q = uintN_ws_alloc_N (ws);
+  uintN_t *_r = uintN_ws_alloc_N (ws);
+
+  uintp_zero (_q->parts + an - bn + 1, NUMBER_OF_PARTS - an + bn - 1);
+  uintp_zero (_r->parts + bn, NUMBER_OF_PARTS - bn);
+
+  uintp_divrem (_q->parts, _r->parts, a->parts, an, b->parts, bn, tp);
+
+  if (q != NULL)
+    uintN_set (q, _q->parts);
+  if (r != NULL)
+    uintN_set (r, _r->parts);
+
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_div_ws (const uintN_t *a, const uintN_t *b, uintN_t *c, uintN_ws_t *ws)
 {
   assert(a != NULL);
   assert(b != NULL);
   assert(c != NULL);
+  assert(ws != NULL);
 
-  uintN_zeroize (c);
-
-  uint16_t i;
-//  for (i = 0; i < NUMBER_OF_PARTS; i++)
+  divrem (a, b, c, NULL, ws);
+}
 
+void
+uintN_div (const uintN_t *a, const uintN_t *b, uintN_t *c)
+{
+  uintN_div_ws (a, b, c, uintN_ws_thread ());
 }
 
 void
-uintN_mod (const uintN_t *a, const uintN_t *b, uintN_t *c)
+uintN_mod_ws (const uintN_t *a, const uintN_t *b, uintN_t *c, uintN_ws_t *ws)
 {
   assert(a != NULL);
   assert(b != NULL);
   assert(c != NULL);
+  assert(ws != NULL);
 
-  uint16_t i;
-//  for (i = 0; i < NUMBER_OF_PARTS; i++)
+  uintN_reducer_t red;
 
+  // folding is meant for double-width products, wider a go to the division
+  if (!uintN_iszero (b) && uintN_modcache_reducer_peek (b, &red)
+      && uintp_normalize (a->parts, NUMBER_OF_PARTS) <= 2 * red.n)
+    {
+      uintN_reducer_reduce (&red, c->parts, a->parts, NUMBER_OF_PARTS, ws);
+      uintp_zero (c->parts + red.n, NUMBER_OF_PARTS - red.n);
+      return;
+    }
+
+  divrem (a, b, NULL, c, ws);
+}
+
+void
+uintN_mod (const uintN_t *a, const uintN_t *b, uintN_t *c)
+{
+  uintN_mod_ws (a, b, c, uintN_ws_thread ());
 }
 
 void
@@ -290,87 +403,141 @@ uintp_rotr (uint64_t *a, uint8_t n, uint64_t *c)
 }
 
 void
-uintN_pow (const uintN_t *x, const uintN_t *n, uintN_t *c)
+uintN_pow_ws (const uintN_t *x, const uintN_t *n, uintN_t *c, uintN_ws_t *ws)
 {
   assert(x != NULL);
   assert(n != NULL);
   assert(c != NULL);
+  assert(ws != NULL);
 
-  uintN_set (c, ONE.parts);
+  size_t mark = uintN_ws_mark (ws);
+  uintN_t *_x = uintN_ws_alloc_N (ws);
+  uintN_t *_y = uintN_ws_alloc_N (ws);
+  uintN_t *_n = uintN_ws_alloc_N (ws);
 
-  if (uintN_iszero (n))
-    return;
+  uintN_set (_x, x->parts);
+  uintN_set (_y, ONE.parts);
+  uintN_set (_n, n->parts);
 
-  // SENSITIVE -> zeroize after use
-  uintN_t _x;
-  uintN_t _y;
-  uintN_t _n;
+  while (!uintN_iszero (_n))
+    {
+      if (uintN_isodd (_n))
+	product_scanning (_x, _y, _y, ws);
+      uintN_rshift (_n, 1, _n);
+      if (!uintN_iszero (_n))
+	product_scanning (_x, _x, _x, ws);
+    }
 
-  uintN_set (&_x, x->parts);
-  uintN_set (&_y, ONE.parts);
-  uintN_set (&_n, n->parts);
+  uintN_set (c, _y->parts);
 
-  do
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_pow (const uintN_t *x, const uintN_t *n, uintN_t *c)
+{
+  uintN_pow_ws (x, n, c, uintN_ws_thread ());
+}
+
+/*
+ * c ≡ a * b (mod m) over the full double-width product.
+ */
+static void
+mulmod (const uintN_t *a, const uintN_t *b, const uintN_t *m, uintN_t *c,
+	uintN_ws_t *ws)
+{
+  // assert not needed.
+
+  size_t pn, mn;
+
+  mn = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+  assert(mn > 0);
+
+  size_t mark = uintN_ws_mark (ws);
+  uint64_t *p = uintN_ws_alloc (ws, 2 * NUMBER_OF_PARTS);
+
+  uintp_mul (p, a->parts, NUMBER_OF_PARTS, b->parts, NUMBER_OF_PARTS);
+  pn = uintp_normalize (p, 2 * NUMBER_OF_PARTS);
+
+  if (pn < mn)
     {
-      if (uintN_isodd (n))
-	{
-	  uintN_mul (&_x, &_y, &_y);
-	  uintN_mul (&_x, &_x, &_x);
-	  uintN_dec (&_n);
-	}
-      else
-	uintN_mul (&_x, &_x, &_x);
-      uintN_rshift (&_n, 1, &_n);
+      uintp_copy (c->parts, p, pn);
+      uintp_zero (c->parts + pn, NUMBER_OF_PARTS - pn);
     }
-  while (!uintN_isone (&_n));
+  else
+    {
+      uint64_t *tp = uintN_ws_alloc (ws, UINTP_DIVREM_SCRATCH(pn, mn));
 
-  uintN_mul (&_x, &_y, c);
+      uintp_divrem (NULL, c->parts, p, pn, m->parts, mn, tp);
+      uintp_zero (c->parts + mn, NUMBER_OF_PARTS - mn);
+    }
 
-  // zeroize
-  uintN_zeroize (&_x);
-  uintN_zeroize (&_y);
-  uintN_zeroize (&_n);
+  uintN_ws_release (ws, mark);
 }
 
 // https://en.wikipedia.org/wiki/Fermat's_little_theorem
 void
-uintN_modp (const uintN_t *base, const uintN_t *exp, const uintN_t *mod,
-	    uintN_t *dest)
+uintN_modp_ws (const uintN_t *base, const uintN_t *exp, const uintN_t *mod,
+	       uintN_t *dest, uintN_ws_t *ws)
 {
   assert(base != NULL);
   assert(exp != NULL);
   assert(mod != NULL);
   assert(dest != NULL);
-
-  uintN_zeroize (dest);
+  assert(ws != NULL);
 
   if (uintN_isequal (mod, &ONE))
-    return;
+    {
+      uintN_zeroize (dest);
+      return;
+    }
 
-  // SENSITIVE -> zeroize after use
-  uintN_t _base;
-  uintN_t _exp;
+  uintN_reducer_t red;
+  uintN_mont_t ctx;
+  bool odd;
 
-  uintN_set (dest, ONE.parts);
-  uintN_set (&_exp, exp->parts);
+  odd = uintN_modcache_lookup (mod, &ctx, &red);
 
-  uintN_mod (base, mod, &_base);
+  // for odd moduli only the one-limb folding beats Montgomery multiplication
+  if (red.form != UINTN_FORM_GENERIC
+      && (!odd
+	  || (red.form == UINTN_FORM_PSEUDO_MERSENNE
+	      && red.n >= UINTN_REDUCER_MONT_PARTS)))
+    {
+      uintN_reducer_modp (&red, base, exp, dest, ws);
+      return;
+    }
 
-  while (!uintN_iszero (&_exp))
+  if (odd)
     {
-      if (uintN_isodd (&_exp))
-	{
-	  uintN_mul (dest, &_base, dest);
-	  uintN_mod (dest, mod, dest);
-	}
-      uintN_rshift (&_exp, 1, &_exp);
-      uintN_mul (&_base, &_base, &_base);
-      uintN_mod (&_base, mod, &_base);
+      uintN_mont_modp (&ctx, base, exp, dest, ws);
+      return;
+    }
+
+  size_t mark = uintN_ws_mark (ws);
+  uintN_t *_base = uintN_ws_alloc_N (ws);
+  uintN_t *_exp = uintN_ws_alloc_N (ws);
+
+  uintN_set (_exp, exp->parts);
+  divrem (base, mod, NULL, _base, ws);
+  uintN_set (dest, ONE.parts);
+
+  while (!uintN_iszero (_exp))
+    {
+      if (uintN_isodd (_exp))
+	mulmod (dest, _base, mod, dest, ws);
+      uintN_rshift (_exp, 1, _exp);
+      mulmod (_base, _base, mod, _base, ws);
     }
 
-  // zeroize
-  uintN_zeroize (&_base);
-  uintN_zeroize (&_exp);
+  uintN_ws_release (ws, mark);
+}
+
+void
+uintN_modp (const uintN_t *base, const uintN_t *exp, const uintN_t *mod,
+	    uintN_t *dest)
+{
+  uintN_modp_ws (base, exp, mod, dest, uintN_ws_thread ());
 }
 
 void
@@ -380,26 +547,13 @@ uintN_lshift (const uintN_t *bn, uint16_t n, uintN_t *dest)
   assert(dest != NULL);
   assert(n < NUMBER_OF_BITS);
 
-  if (n == 0)
-    return;
+  uint16_t t;
 
-  int16_t j;
-  uint16_t i;
-  uint8_t d, t, k;
-  uint64_t carry, mask;
+  t = n / PART_SIZE_BITS;
 
-  d = n % PART_SIZE_BITS;
-  k = n - d;
-  t = k / PART_SIZE_BITS;
-  mask = (1 << d) - 1;
-  uintp_rotr (&mask, d, &mask);
-
-  for (i = NUMBER_OF_PARTS; i > 0;)
-    {
-      j = --i - t;
-      carry = (j > 0) ? (bn->parts[j - 1] & mask) >> k : 0;
-      dest->parts[i] = (j >= 0) ? (bn->parts[j] << d) | carry : 0;
-    }
+  uintp_lshift (dest->parts + t, bn->parts, NUMBER_OF_PARTS - t,
+		n % PART_SIZE_BITS);
+  uintp_zero (dest->parts, t);
 }
 
 void
@@ -409,25 +563,13 @@ uintN_rshift (const uintN_t *bn, uint16_t n, uintN_t *c)
   assert(c != NULL);
   assert(n < NUMBER_OF_BITS);
 
-  if (n == 0)
-    return;
-
-  int16_t j;
-  uint16_t i;
-  uint8_t mod, residue, shift;
-  uint64_t carry, mask;
+  uint16_t t;
 
-  mod = n % PART_SIZE_BITS;
-  residue = n - mod;
-  shift = residue / PART_SIZE_BITS;
-  mask = (1 << mod) - 1;
+  t = n / PART_SIZE_BITS;
 
-  for (i = 0; i < NUMBER_OF_PARTS; i++)
-    {
-      j = i + shift;
-      carry = (j < NUMBER_OF_PARTS - 1) ? bn->parts[j + 1] & mask : 0;
-      c->parts[i] = (j < NUMBER_OF_PARTS) ? (bn->parts[j] >> mod) | carry : 0;
-    }
+  uintp_rshift (c->parts, bn->parts + t, NUMBER_OF_PARTS - t,
+		n % PART_SIZE_BITS);
+  uintp_zero (c->parts + NUMBER_OF_PARTS - t, t);
 }
 
 void
@@ -435,7 +577,27 @@ uintN_zeroize (const uintN_t *bn)
 {
   assert(bn != NULL);
 
-  memset((void * ) bn->parts, 0, NUMBER_OF_BYTES);
+  uintN_wipe ((void *) bn->parts, NUMBER_OF_BYTES);
+}
+
+void
+uintN_cselect (const uintN_t *a, const uintN_t *b, bool cond, uintN_t *c)
+{
+  assert(a != NULL);
+  assert(b != NULL);
+  assert(c != NULL);
+
+  uintp_cselect (c->parts, a->parts, b->parts, NUMBER_OF_PARTS,
+		 -(uint64_t) cond);
+}
+
+void
+uintN_cswap (uintN_t *a, uintN_t *b, bool cond)
+{
+  assert(a != NULL);
+  assert(b != NULL);
+
+  uintp_cswap (a->parts, b->parts, NUMBER_OF_PARTS, -(uint64_t) cond);
 }
 
 void
@@ -445,15 +607,16 @@ uintN_swap (uintN_t *a, uintN_t *b)
   assert(b != NULL);
   assert(a != b);
 
-  // SENSITIVE -> zeroize after use
-  uintN_t _t;
-
-  uintN_set (&_t, a->parts);
-  uintN_set (a, b->parts);
-  uintN_set (b, _t.parts);
+  uint16_t i;
+  uint64_t t;
 
-  // zeroize
-  uintN_zeroize (&_t);
+  // limb by limb, so there is no whole temporary to wipe
+  for (i = 0; i < NUMBER_OF_PARTS; i++)
+    {
+      t = a->parts[i];
+      a->parts[i] = b->parts[i];
+      b->parts[i] = t;
+    }
 }
 
 void
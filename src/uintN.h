@@ -6,6 +6,9 @@
  *
  * Used for handling big integer operations by the cryptography library.
  *
+ * Compound routines take their temporaries from the calling thread's
+ * workspace, see workspace.h for variants taking an explicit one.
+ *
  *  Created on: Jan 16, 2017
  *      Author: pyk
  */
@@ -28,6 +31,8 @@ extern "C"
 
 #define PRINT_FORMAT "%016llx"
 
+/* C++ has its own bool and std::min/std::max, see uint.hpp */
+#ifndef __cplusplus
 #define true 1u
 #define false 0u
 
@@ -38,13 +43,25 @@ extern "C"
 #ifndef min
 #define min(a,b) ((a) < (b) ? (a) : (b))
 #endif
+#endif
 
 typedef struct
 {
   uint64_t parts[NUMBER_OF_PARTS];
 } uintN_t;
 
+#ifndef __cplusplus
 typedef _Bool bool;
+#endif
+
+/**
+ * uintN compare, returns -1, 0 or 1 when a is less, equal or greater than b.
+ * all limbs are compared without branches, whatever the data.
+ *
+ * The running time of implemented algorithm is O(n) where n is number of bytes is uintN.
+ */
+int
+uintN_cmp (const uintN_t *a, const uintN_t *b);
 
 /**
  * uintN check if a > b.
@@ -130,6 +147,15 @@ uintN_add (const uintN_t *a, const uintN_t *b, uintN_t *c);
 void
 uintN_inc (uintN_t *a);
 
+/**
+ * uintN addition of a single limb c = a + b.
+ * carry propagation stops at the first limb that does not overflow.
+ *
+ * The running time of implemented algorithm is O(1) amortized, O(n) worst case.
+ */
+void
+uintN_add_ui (const uintN_t *a, uint64_t b, uintN_t *c);
+
 /**
  * uintN subtraction c = a - b.
  *
@@ -147,12 +173,47 @@ void
 uintN_dec (uintN_t *a);
 
 /**
- * uintN multiplication c = a * b.
- * the implementation use the shift-and-add algorithm.
+ * uintN subtraction of a single limb c = a - b.
+ * borrow propagation stops at the first limb that does not underflow.
+ *
+ * The running time of implemented algorithm is O(1) amortized, O(n) worst case.
+ */
+void
+uintN_sub_ui (const uintN_t *a, uint64_t b, uintN_t *c);
+
+/**
+ * uintN multiplication by a single limb c = a * b, truncated to NUMBER_OF_BITS.
+ *
+ * The running time of implemented algorithm is O(n), where n is number of significant parts in a.
+ */
+void
+uintN_mul_ui (const uintN_t *a, uint64_t b, uintN_t *c);
+
+/**
+ * uintN division by a single limb q = a / d, returns a mod d.
+ * q may be NULL or equal to a, d must be non-zero.
+ * the implementation use a precomputed reciprocal of d, see uintp_divrem_1.
+ *
+ * The running time of implemented algorithm is O(n), where n is number of significant parts in a.
+ */
+uint64_t
+uintN_divmod_ui (const uintN_t *a, uint64_t d, uintN_t *q);
+
+/**
+ * uintN modular a mod d for a single limb d, d must be non-zero.
+ *
+ * The running time of implemented algorithm is O(n), where n is number of significant parts in a.
+ */
+uint64_t
+uintN_mod_ui (const uintN_t *a, uint64_t d);
+
+/**
+ * uintN multiplication c = a * b, truncated to NUMBER_OF_BITS.
+ * the implementation use operand scanning over the limb kernels in uintp.h.
  *
  * TODO implement divide-and-conquer (https://en.wikipedia.org/wiki/Divide_and_conquer_algorithm)
  *
- * The running time of implemented algorithm is O(n^2), where n is number of bits in a.
+ * The running time of implemented algorithm is O(n^2), where n is number of parts in a.
  */
 void
 uintN_mul (const uintN_t *a, const uintN_t *b, uintN_t *c);
@@ -164,11 +225,18 @@ uintN_mul (const uintN_t *a, const uintN_t *b, uintN_t *c);
 void
 uintN_gcd (const uintN_t *a, const uintN_t *b, uintN_t *c);
 
+/**
+ * uintN division c = a / b.
+ * the implementation use Knuth's algorithm D, see uintp_divrem.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintN_div (const uintN_t *a, const uintN_t *b, uintN_t *c);
+
 /**
  * uintN modular c ≡ b (mod m).
- * the implementation use the Stein's algorithm.
- * this method drastically reduces the number of operations
- * to perform modular exponentiation, while keeping the same memory.
+ * the implementation use Knuth's algorithm D, see uintp_divrem.
  *
  * The running time of implemented algorithm is O(n^2).
  */
@@ -184,7 +252,9 @@ uintN_pow (const uintN_t *base, const uintN_t *exp, uintN_t *c);
 
 /**
  * uintN modular exponentiation c ≡ b ^ exp (mod m).
- * the implementation use the right-to-left binary method.
+ * odd moduli go through Montgomery multiplication, see montgomery.h.
+ * even moduli use the right-to-left binary method,
+ * every product is reduced over its full double width.
  * this method drastically reduces the number of operations
  * to perform modular exponentiation, while keeping the same memory.
  * based on Applied Cryptography, p. 244. by Bruce Schneier.
@@ -218,13 +288,31 @@ void
 uintN_rshift (const uintN_t *bn, uint16_t n, uintN_t *c);
 
 /**
- * uintN zeroize.
+ * uintN zeroize, in a way the compiler may not optimize away.
  *
  * The running time of implemented algorithm is O(n) where n is number of bytes is uintN.
  */
 void
 uintN_zeroize (const uintN_t *bn);
 
+/**
+ * uintN select c = cond ? a : b with a mask rather than a branch.
+ * c may be equal to a or b.
+ *
+ * The running time of implemented algorithm is O(n) where n is number of bytes is uintN.
+ */
+void
+uintN_cselect (const uintN_t *a, const uintN_t *b, bool cond, uintN_t *c);
+
+/**
+ * uintN swap a and b if cond, with a mask rather than a branch. a may be
+ * equal to b.
+ *
+ * The running time of implemented algorithm is O(n) where n is number of bytes is uintN.
+ */
+void
+uintN_cswap (uintN_t *a, uintN_t *b, bool cond);
+
 /**
  * uintN swap
  */
@@ -0,0 +1,445 @@
+#include <assert.h>
+#include <string.h>
+
+#include "uintp.h"
+
+typedef unsigned __int128 uint128_t;
+
+uint64_t
+uintp_add_n (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+{
+  size_t i;
+  uint64_t sum, carry;
+
+  for (i = 0, carry = 0; i < n; i++)
+    {
+      uint64_t c1 = __builtin_add_overflow (a[i], carry, &sum);
+      uint64_t c2 = __builtin_add_overflow (sum, b[i], &r[i]);
+      carry = c1 | c2;
+    }
+  return carry;
+}
+
+uint64_t
+uintp_add_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    {
+      b = __builtin_add_overflow (a[i], b, &r[i]);
+      if (b == 0)
+	{
+	  if (r != a)
+	    uintp_copy (r + i + 1, a + i + 1, n - i - 1);
+	  return 0;
+	}
+    }
+  return b;
+}
+
+uint64_t
+uintp_sub_n (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+{
+  size_t i;
+  uint64_t diff, borrow;
+
+  for (i = 0, borrow = 0; i < n; i++)
+    {
+      uint64_t b1 = __builtin_sub_overflow (a[i], borrow, &diff);
+      uint64_t b2 = __builtin_sub_overflow (diff, b[i], &r[i]);
+      borrow = b1 | b2;
+    }
+  return borrow;
+}
+
+uint64_t
+uintp_sub_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    {
+      b = __builtin_sub_overflow (a[i], b, &r[i]);
+      if (b == 0)
+	{
+	  if (r != a)
+	    uintp_copy (r + i + 1, a + i + 1, n - i - 1);
+	  return 0;
+	}
+    }
+  return b;
+}
+
+uint64_t
+uintp_mul_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+{
+  size_t i;
+  uint128_t t;
+  uint64_t carry;
+
+  for (i = 0, carry = 0; i < n; i++)
+    {
+      t = (uint128_t) a[i] * b + carry;
+      r[i] = (uint64_t) t;
+      carry = (uint64_t) (t >> 64);
+    }
+  return carry;
+}
+
+uint64_t
+uintp_addmul_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+{
+  size_t i;
+  uint128_t t;
+  uint64_t carry;
+
+  for (i = 0, carry = 0; i < n; i++)
+    {
+      t = (uint128_t) a[i] * b + r[i] + carry;
+      r[i] = (uint64_t) t;
+      carry = (uint64_t) (t >> 64);
+    }
+  return carry;
+}
+
+uint64_t
+uintp_submul_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+{
+  size_t i;
+  uint128_t t;
+  uint64_t lo, carry;
+
+  for (i = 0, carry = 0; i < n; i++)
+    {
+      t = (uint128_t) a[i] * b + carry;
+      lo = (uint64_t) t;
+      carry = (uint64_t) (t >> 64);
+      carry += __builtin_sub_overflow (r[i], lo, &r[i]);
+    }
+  return carry;
+}
+
+uint64_t
+uintp_lshift (uint64_t *r, const uint64_t *a, size_t n, unsigned int cnt)
+{
+  assert(cnt < 64);
+
+  size_t i;
+  uint64_t out;
+
+  if (n == 0)
+    return 0;
+  if (cnt == 0)
+    {
+      memmove (r, a, n * sizeof(uint64_t));
+      return 0;
+    }
+
+  out = a[n - 1] >> (64 - cnt);
+  for (i = n - 1; i > 0; i--)
+    r[i] = (a[i] << cnt) | (a[i - 1] >> (64 - cnt));
+  r[0] = a[0] << cnt;
+
+  return out;
+}
+
+uint64_t
+uintp_rshift (uint64_t *r, const uint64_t *a, size_t n, unsigned int cnt)
+{
+  assert(cnt < 64);
+
+  size_t i;
+  uint64_t out;
+
+  if (n == 0)
+    return 0;
+  if (cnt == 0)
+    {
+      memmove (r, a, n * sizeof(uint64_t));
+      return 0;
+    }
+
+  out = a[0] << (64 - cnt);
+  for (i = 0; i < n - 1; i++)
+    r[i] = (a[i] >> cnt) | (a[i + 1] << (64 - cnt));
+  r[n - 1] = a[n - 1] >> cnt;
+
+  return out;
+}
+
+int
+uintp_cmp (const uint64_t *a, const uint64_t *b, size_t n)
+{
+  while (n > 0)
+    {
+      n--;
+      if (a[n] != b[n])
+	return a[n] > b[n] ? 1 : -1;
+    }
+  return 0;
+}
+
+int
+uintp_cmp_ct (const uint64_t *a, const uint64_t *b, size_t n)
+{
+  size_t i;
+  uint64_t diff, borrow, x;
+
+  // the borrow of a - b says a < b, any differing bit says a != b
+  for (i = 0, borrow = 0, x = 0; i < n; i++)
+    {
+      uint64_t b1 = __builtin_sub_overflow (a[i], borrow, &diff);
+      uint64_t b2 = __builtin_sub_overflow (diff, b[i], &diff);
+      borrow = b1 | b2;
+      x |= a[i] ^ b[i];
+    }
+  return (int) (x != 0) - 2 * (int) borrow;
+}
+
+void
+uintp_cselect (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n,
+	       uint64_t mask)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    r[i] = b[i] ^ ((a[i] ^ b[i]) & mask);
+}
+
+void
+uintp_cswap (uint64_t *a, uint64_t *b, size_t n, uint64_t mask)
+{
+  size_t i;
+  uint64_t t;
+
+  for (i = 0; i < n; i++)
+    {
+      t = (a[i] ^ b[i]) & mask;
+      a[i] ^= t;
+      b[i] ^= t;
+    }
+}
+
+void
+uintp_copy (uint64_t *r, const uint64_t *a, size_t n)
+{
+  if (r != a)
+    memmove (r, a, n * sizeof(uint64_t));
+}
+
+void
+uintp_zero (uint64_t *r, size_t n)
+{
+  memset (r, 0, n * sizeof(uint64_t));
+}
+
+size_t
+uintp_normalize (const uint64_t *a, size_t n)
+{
+  while (n > 0 && a[n - 1] == 0)
+    n--;
+  return n;
+}
+
+void
+uintp_mul (uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b,
+	   size_t bn)
+{
+  size_t i;
+
+  uintp_zero (r, an + bn);
+  for (i = 0; i < bn; i++)
+    r[an + i] = uintp_addmul_1 (r + i, a, an, b[i]);
+}
+
+void
+uintp_sqr (uint64_t *r, const uint64_t *a, size_t n)
+{
+  size_t i;
+  uint128_t t, s;
+  uint64_t c;
+
+  if (n == 0)
+    return;
+
+  // cross products a[i] a[j] for i < j, row i ends in the fresh limb r[n + i]
+  uintp_zero (r, 2 * n);
+  for (i = 0; i + 1 < n; i++)
+    r[n + i] = uintp_addmul_1 (r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+
+  uintp_lshift (r, r, 2 * n, 1);
+
+  // plus the squares on the diagonal
+  for (i = 0, c = 0; i < n; i++)
+    {
+      t = (uint128_t) a[i] * a[i];
+      s = (uint128_t) r[2 * i] + (uint64_t) t + c;
+      r[2 * i] = (uint64_t) s;
+      s = (uint128_t) r[2 * i + 1] + (uint64_t) (t >> 64)
+	  + (uint64_t) (s >> 64);
+      r[2 * i + 1] = (uint64_t) s;
+      c = (uint64_t) (s >> 64);
+    }
+}
+
+void
+uintp_mullo_n (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+{
+  size_t i;
+
+  uintp_zero (r, n);
+  for (i = 0; i < n; i++)
+    uintp_addmul_1 (r + i, a, n - i, b[i]);
+}
+
+uint64_t
+uintp_reciprocal (uint64_t d)
+{
+  assert(d >> 63 != 0);
+
+  // floor((2^128 - 1) / d) - 2^64, the high limb ~d keeps it below 2^128
+  return (uint64_t) ((((uint128_t) ~d) << 64 | ~0ull) / d);
+}
+
+/*
+ * 2/1 division of <u1, u0> by the normalized d with its reciprocal v, u1 < d.
+ * Möller and Granlund, Improved division by invariant integers, algorithm 4.
+ */
+static inline uint64_t
+div_2by1 (uint64_t *rem, uint64_t u1, uint64_t u0, uint64_t d, uint64_t v)
+{
+  uint128_t p;
+  uint64_t q1, q0, r;
+
+  p = (uint128_t) v * u1;
+  p += ((uint128_t) (u1 + 1) << 64) | u0;
+  q1 = (uint64_t) (p >> 64);
+  q0 = (uint64_t) p;
+
+  r = u0 - q1 * d;
+  if (r > q0)
+    {
+      q1--;
+      r += d;
+    }
+  if (__builtin_expect (r >= d, 0))
+    {
+      q1++;
+      r -= d;
+    }
+  *rem = r;
+  return q1;
+}
+
+uint64_t
+uintp_divrem_1_preinv (uint64_t *q, const uint64_t *a, size_t n, uint64_t d,
+		       uint64_t v)
+{
+  assert(d != 0);
+
+  size_t i;
+  unsigned int s;
+  uint64_t rem, u0, qi;
+
+  if (n == 0)
+    return 0;
+
+  // divide a 2^s by d 2^s, same quotient and the remainder shifted by s
+  s = __builtin_clzll (d);
+  d <<= s;
+  rem = s == 0 ? 0 : a[n - 1] >> (64 - s);
+
+  for (i = n; i > 0;)
+    {
+      i--;
+      u0 = a[i] << s;
+      if (s != 0 && i > 0)
+	u0 |= a[i - 1] >> (64 - s);
+      qi = div_2by1 (&rem, rem, u0, d, v);
+      if (q != NULL)
+	q[i] = qi;
+    }
+  return rem >> s;
+}
+
+uint64_t
+uintp_divrem_1 (uint64_t *q, const uint64_t *a, size_t n, uint64_t d)
+{
+  assert(d != 0);
+
+  uint64_t rem;
+
+  // a single division does not pay for the reciprocal
+  if (n == 1)
+    {
+      rem = a[0] % d;
+      if (q != NULL)
+	q[0] = a[0] / d;
+      return rem;
+    }
+
+  return uintp_divrem_1_preinv (q, a, n, d,
+				uintp_reciprocal (d << __builtin_clzll (d)));
+}
+
+void
+uintp_divrem (uint64_t *q, uint64_t *r, const uint64_t *a, size_t an,
+	      const uint64_t *d, size_t dn, uint64_t *tp)
+{
+  assert(dn > 0);
+  assert(an >= dn);
+  assert(d[dn - 1] != 0);
+
+  size_t j;
+  unsigned int s;
+  uint64_t *un, *vn, top;
+  uint128_t num, qhat, rhat;
+
+  if (dn == 1)
+    {
+      uint64_t rem = uintp_divrem_1 (q, a, an, d[0]);
+      if (r != NULL)
+	r[0] = rem;
+      return;
+    }
+
+  // normalize so that the top bit of the divisor is set
+  un = tp;
+  vn = tp + an + 1;
+  s = __builtin_clzll (d[dn - 1]);
+  uintp_lshift (vn, d, dn, s);
+  un[an] = uintp_lshift (un, a, an, s);
+
+  for (j = an - dn + 1; j > 0;)
+    {
+      j--;
+
+      // estimate qhat from the top two limbs, then correct it at most twice
+      num = ((uint128_t) un[j + dn] << 64) | un[j + dn - 1];
+      qhat = num / vn[dn - 1];
+      rhat = num % vn[dn - 1];
+      while ((qhat >> 64) != 0
+	  || qhat * vn[dn - 2] > ((rhat << 64) | un[j + dn - 2]))
+	{
+	  qhat--;
+	  rhat += vn[dn - 1];
+	  if ((rhat >> 64) != 0)
+	    break;
+	}
+
+      top = uintp_submul_1 (un + j, vn, dn, (uint64_t) qhat);
+      if (__builtin_sub_overflow (un[j + dn], top, &un[j + dn]))
+	{
+	  // qhat was one too large, add the divisor back
+	  qhat--;
+	  un[j + dn] += uintp_add_n (un + j, un + j, vn, dn);
+	}
+
+      if (q != NULL)
+	q[j] = (uint64_t) qhat;
+    }
+
+  if (r != NULL)
+    uintp_rshift (r, un, dn, s);
+}
@@ -0,0 +1,242 @@
+/*
+ * uintp.h
+ *
+ * Header file for the low-level limb kernels.
+ *
+ * Every routine works on a span of limbs (uint64_t *parts, size_t n), least
+ * significant limb first, and returns the carry or borrow out of the span.
+ * The uintN_t API is built on top of these; they are also the building blocks
+ * for algorithms that need to operate on sub-ranges or on operands of
+ * different length without copying whole uintN_t values around.
+ *
+ * Unless stated otherwise the destination may be equal to any source, but
+ * must not partially overlap it.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef UINTP_H_
+#define UINTP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/**
+ * uintp addition r = a + b, returns the carry out (0 or 1).
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_add_n (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * uintp addition of a single limb r = a + b, returns the carry out.
+ * Carry propagation stops at the first limb that does not overflow.
+ *
+ * The running time of implemented algorithm is O(n) worst case.
+ */
+uint64_t
+uintp_add_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+/**
+ * uintp subtraction r = a - b, returns the borrow out (0 or 1).
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_sub_n (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * uintp subtraction of a single limb r = a - b, returns the borrow out.
+ * Borrow propagation stops at the first limb that does not underflow.
+ *
+ * The running time of implemented algorithm is O(n) worst case.
+ */
+uint64_t
+uintp_sub_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+/**
+ * uintp multiplication by a single limb r = a * b, returns the high limb.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_mul_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+/**
+ * uintp multiply-accumulate r += a * b, returns the high limb.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_addmul_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+/**
+ * uintp multiply-subtract r -= a * b, returns the high limb of the borrow.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_submul_1 (uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+/**
+ * uintp logical left shift by cnt < 64 bits, returns the bits shifted out
+ * (in the low end of the result). r may be equal to or above a.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_lshift (uint64_t *r, const uint64_t *a, size_t n, unsigned int cnt);
+
+/**
+ * uintp logical right shift by cnt < 64 bits, returns the bits shifted out
+ * (in the high end of the result). r may be equal to or below a.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_rshift (uint64_t *r, const uint64_t *a, size_t n, unsigned int cnt);
+
+/**
+ * uintp compare, returns -1, 0 or 1 when a is less, equal or greater than b.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+int
+uintp_cmp (const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * uintp compare as uintp_cmp, without branches on the limbs: every limb is
+ * read whatever the data, in the same time.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+int
+uintp_cmp_ct (const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * uintp select r = a if mask is all ones, r = b if mask is zero.
+ * r may be equal to a or b.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintp_cselect (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n,
+	       uint64_t mask);
+
+/**
+ * uintp swap a and b if mask is all ones, nothing if mask is zero.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+void
+uintp_cswap (uint64_t *a, uint64_t *b, size_t n, uint64_t mask);
+
+/**
+ * uintp copy r = a.
+ */
+void
+uintp_copy (uint64_t *r, const uint64_t *a, size_t n);
+
+/**
+ * uintp set all limbs to zero.
+ */
+void
+uintp_zero (uint64_t *r, size_t n);
+
+/**
+ * uintp number of significant limbs, i.e. n without the leading zero limbs.
+ */
+size_t
+uintp_normalize (const uint64_t *a, size_t n);
+
+/**
+ * uintp full multiplication r = a * b, r holds an + bn limbs.
+ * r must not overlap a or b.
+ *
+ * The running time of implemented algorithm is O(an * bn).
+ */
+void
+uintp_mul (uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b,
+	   size_t bn);
+
+/**
+ * uintp squaring r = a * a, r holds 2n limbs.
+ * r must not overlap a. computes each cross product once and doubles, about
+ * half the work of uintp_mul.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintp_sqr (uint64_t *r, const uint64_t *a, size_t n);
+
+/**
+ * uintp truncated multiplication r = a * b mod 2^(64 n).
+ * r must not overlap a or b.
+ *
+ * The running time of implemented algorithm is O(n^2).
+ */
+void
+uintp_mullo_n (uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n);
+
+/**
+ * uintp reciprocal floor((2^128 - 1) / d) - 2^64 of a limb d with the top bit
+ * set, for uintp_divrem_1_preinv.
+ *
+ * The running time of implemented algorithm is O(1).
+ */
+uint64_t
+uintp_reciprocal (uint64_t d);
+
+/**
+ * uintp division by a single limb a = q * d + r, returns r.
+ * q receives n limbs (may be NULL or equal to a), d must be non-zero.
+ * the reciprocal of d is computed once and every limb is divided with two
+ * multiplications instead of a hardware division.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_divrem_1 (uint64_t *q, const uint64_t *a, size_t n, uint64_t d);
+
+/**
+ * uintp division by a single limb as uintp_divrem_1, with the reciprocal
+ * v = uintp_reciprocal (d << clz(d)) precomputed by the caller, for divisors
+ * used over and over such as a table of small primes.
+ *
+ * The running time of implemented algorithm is O(n).
+ */
+uint64_t
+uintp_divrem_1_preinv (uint64_t *q, const uint64_t *a, size_t n, uint64_t d,
+		       uint64_t v);
+
+/**
+ * uintp scratch limbs needed by uintp_divrem for an an-limb numerator and a
+ * dn-limb divisor.
+ */
+#define UINTP_DIVREM_SCRATCH(an, dn) ((an) + 1 + (dn))
+
+/**
+ * uintp division a = q * d + r.
+ * q receives an - dn + 1 limbs (may be NULL), r receives dn limbs (may be
+ * NULL). The top limb of d must be non-zero and an >= dn.
+ * tp is scratch of UINTP_DIVREM_SCRATCH(an, dn) limbs; q and r must not
+ * overlap a, d or tp.
+ * the implementation use Knuth's algorithm D (TAOCP vol. 2, 4.3.1).
+ *
+ * The running time of implemented algorithm is O((an - dn) * dn).
+ */
+void
+uintp_divrem (uint64_t *q, uint64_t *r, const uint64_t *a, size_t an,
+	      const uint64_t *d, size_t dn, uint64_t *tp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UINTP_H_ */
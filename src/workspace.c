@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "workspace.h"
+
+#define WS_ALIGN 64
+
+static void *
+(*const volatile memset_v) (void *, int, size_t) = memset;
+
+void
+uintN_wipe (void *p, size_t n)
+{
+  assert(p != NULL || n == 0);
+
+  memset_v (p, 0, n);
+}
+
+bool
+uintN_ws_init (uintN_ws_t *ws, size_t size, uint8_t flags)
+{
+  assert(ws != NULL);
+  assert(size > 0);
+
+  size_t bytes;
+
+  bytes = (size * sizeof(uint64_t) + WS_ALIGN - 1) & ~(size_t) (WS_ALIGN - 1);
+
+  memset (ws, 0, sizeof(*ws));
+
+  if (flags & UINTN_WS_LOCKED)
+    {
+      void *p = mmap (NULL, bytes, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED)
+	return false;
+      if (mlock (p, bytes) != 0)
+	{
+	  munmap (p, bytes);
+	  return false;
+	}
+#ifdef MADV_DONTDUMP
+      madvise (p, bytes, MADV_DONTDUMP);
+#endif
+      ws->base = p;
+    }
+  else
+    {
+      ws->base = aligned_alloc (WS_ALIGN, bytes);
+      if (ws->base == NULL)
+	return false;
+    }
+
+  ws->size = bytes / sizeof(uint64_t);
+  ws->flags = flags;
+
+  return true;
+}
+
+void
+uintN_ws_wipe (uintN_ws_t *ws)
+{
+  assert(ws != NULL);
+
+  uintN_wipe (ws->base, ws->peak * sizeof(uint64_t));
+  ws->peak = ws->top;
+}
+
+void
+uintN_ws_free (uintN_ws_t *ws)
+{
+  assert(ws != NULL);
+
+  size_t bytes;
+
+  if (ws->base == NULL)
+    return;
+
+  bytes = ws->size * sizeof(uint64_t);
+  ws->top = 0;
+  uintN_ws_wipe (ws);
+
+  if (ws->flags & UINTN_WS_LOCKED)
+    {
+      munlock (ws->base, bytes);
+      munmap (ws->base, bytes);
+    }
+  else
+    free (ws->base);
+
+  memset (ws, 0, sizeof(*ws));
+}
+
+uint64_t *
+uintN_ws_alloc (uintN_ws_t *ws, size_t n)
+{
+  assert(ws != NULL);
+
+  uint64_t *p;
+
+  if (n > ws->size - ws->top)
+    {
+      printf ("workspace exhausted (%zu of %zu limbs in use, %zu requested)\n",
+	      ws->top, ws->size, n);
+      abort ();
+    }
+
+  p = ws->base + ws->top;
+  ws->top += n;
+  ws->peak = max(ws->peak, ws->top);
+
+  return p;
+}
+
+size_t
+uintN_ws_mark (const uintN_ws_t *ws)
+{
+  assert(ws != NULL);
+
+  return ws->top;
+}
+
+void
+uintN_ws_release (uintN_ws_t *ws, size_t mark)
+{
+  assert(ws != NULL);
+  assert(mark <= ws->top);
+
+  ws->top = mark;
+
+  // the outermost routine is done, its secrets go now rather than at
+  // thread exit
+  if (mark == 0)
+    uintN_ws_wipe (ws);
+}
+
+static pthread_key_t thread_key;
+static pthread_once_t thread_once = PTHREAD_ONCE_INIT;
+static __thread uintN_ws_t thread_ws;
+
+static void
+thread_ws_destroy (void *ws)
+{
+  uintN_ws_free (ws);
+}
+
+static void
+thread_ws_exit (void)
+{
+  // the key destructor does not run for the thread calling exit()
+  uintN_ws_free (&thread_ws);
+}
+
+static void
+thread_key_create (void)
+{
+  pthread_key_create (&thread_key, thread_ws_destroy);
+  atexit (thread_ws_exit);
+}
+
+uintN_ws_t *
+uintN_ws_thread (void)
+{
+  if (thread_ws.base != NULL)
+    return &thread_ws;
+
+  pthread_once (&thread_once, thread_key_create);
+
+  if (!uintN_ws_init (&thread_ws, UINTN_WS_DEFAULT_PARTS, 0))
+    {
+      printf ("failed to allocate the thread workspace\n");
+      abort ();
+    }
+  pthread_setspecific (thread_key, &thread_ws);
+
+  return &thread_ws;
+}
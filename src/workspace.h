@@ -0,0 +1,153 @@
+/*
+ * workspace.h
+ *
+ * Header file for the scratch workspace used by compound uintN routines.
+ *
+ * A workspace is a stack-like arena of limbs: routines take their temporaries
+ * from it with uintN_ws_alloc and hand them back with uintN_ws_release, so a
+ * long sequence of operations reuses the same few cache lines instead of
+ * fresh stack temporaries that are each copied into and wiped.
+ *
+ * The arena is wiped securely in one pass when the outermost allocation is
+ * released, when it is freed or on request with uintN_ws_wipe, covering
+ * everything handed out since the last wipe.
+ *
+ * The plain uintN API uses the calling thread's default workspace, the _ws
+ * variants below take an explicit one.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#ifndef WORKSPACE_H_
+#define WORKSPACE_H_
+
+#include <stddef.h>
+
+#include "uintN.h"
+
+#ifdef __cplusplus
+extern "C"
+  {
+#endif
+
+/* keep the workspace on mlock'd pages so it is never swapped out */
+#define UINTN_WS_LOCKED 0x01
+
+/* default size of a workspace, enough for every routine in uintN.h */
+#define UINTN_WS_DEFAULT_PARTS (64 * NUMBER_OF_PARTS)
+
+typedef struct
+{
+  uint64_t *base;
+  size_t size;
+  size_t top;
+  size_t peak;
+  uint8_t flags;
+} uintN_ws_t;
+
+/**
+ * workspace init with room for size limbs.
+ * returns false if the memory could not be allocated (or locked).
+ */
+bool
+uintN_ws_init (uintN_ws_t *ws, size_t size, uint8_t flags);
+
+/**
+ * workspace free, wipes every limb that was handed out before releasing it.
+ */
+void
+uintN_ws_free (uintN_ws_t *ws);
+
+/**
+ * workspace wipe every limb that was handed out so far, keeps the memory.
+ */
+void
+uintN_ws_wipe (uintN_ws_t *ws);
+
+/**
+ * workspace take n limbs from the top of the arena.
+ * the returned limbs are not cleared. aborts if the arena is exhausted.
+ *
+ * The running time of implemented algorithm is O(1).
+ */
+uint64_t *
+uintN_ws_alloc (uintN_ws_t *ws, size_t n);
+
+/**
+ * workspace take room for one uintN_t from the top of the arena.
+ */
+#define uintN_ws_alloc_N(ws) ((uintN_t *) uintN_ws_alloc ((ws), NUMBER_OF_PARTS))
+
+/**
+ * workspace current top, pass it to uintN_ws_release to hand back
+ * everything allocated after it.
+ */
+size_t
+uintN_ws_mark (const uintN_ws_t *ws);
+
+/**
+ * workspace hand back everything allocated after mark.
+ * the limbs of nested routines are not wiped here, releasing mark 0 wipes
+ * everything handed out since the last wipe.
+ *
+ * The running time of implemented algorithm is O(1), O(peak) for mark 0.
+ */
+void
+uintN_ws_release (uintN_ws_t *ws, size_t mark);
+
+/**
+ * workspace of the calling thread, created on first use and wiped and freed
+ * when the thread exits.
+ */
+uintN_ws_t *
+uintN_ws_thread (void);
+
+/**
+ * wipe n bytes in a way the compiler may not optimize away.
+ */
+void
+uintN_wipe (void *p, size_t n);
+
+/**
+ * uintN multiplication c = a * b using the workspace ws.
+ */
+void
+uintN_mul_ws (const uintN_t *a, const uintN_t *b, uintN_t *c, uintN_ws_t *ws);
+
+/**
+ * uintN division c = a / b using the workspace ws.
+ */
+void
+uintN_div_ws (const uintN_t *a, const uintN_t *b, uintN_t *c, uintN_ws_t *ws);
+
+/**
+ * uintN modular c ≡ a (mod m) using the workspace ws.
+ */
+void
+uintN_mod_ws (const uintN_t *a, const uintN_t *m, uintN_t *c, uintN_ws_t *ws);
+
+/**
+ * uintN greatest common divisor c = gcd(a, b) using the workspace ws.
+ */
+void
+uintN_gcd_ws (const uintN_t *a, const uintN_t *b, uintN_t *c, uintN_ws_t *ws);
+
+/**
+ * uintN power c = base ^ exp using the workspace ws.
+ */
+void
+uintN_pow_ws (const uintN_t *base, const uintN_t *exp, uintN_t *c,
+	      uintN_ws_t *ws);
+
+/**
+ * uintN modular exponentiation c ≡ b ^ exp (mod m) using the workspace ws.
+ */
+void
+uintN_modp_ws (const uintN_t *base, const uintN_t *exp, const uintN_t *mod,
+	       uintN_t *c, uintN_ws_t *ws);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORKSPACE_H_ */
@@ -2,8 +2,30 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 #include "../src/uintN.h"
+#include "../src/uintp.h"
+#include "../src/workspace.h"
+#include "../src/fixedbase.h"
+#include "../src/modarith.h"
+#include "../src/reducer.h"
+#include "../src/modcache.h"
+#include "../src/rsa.h"
+#include "../src/jobpool.h"
+#include "../src/random.h"
+#include "../src/ntt.h"
+#include "../src/batchgcd.h"
+#include "../src/loadgen.h"
+#include "../src/tables.h"
+#include "../src/tune.h"
+#include "../src/rns.h"
+#include "../src/gf2m.h"
+#include "../src/p256.h"
 
 static void
 test_add_simple ()
@@ -117,7 +139,7 @@ test_lshift_simple ()
   assert(uintN_isequal (&b, &c3) == 1);
 
   uintN_t c4 =
-    { 0x00, 0x8000000000000000, 0xfe };
+    { 0x00, 0x8000000000000000, 0x7f };
   uintN_lshift (&a, 2 * PART_SIZE_BITS - 1, &b);
   assert(uintN_isequal (&b, &c4) == 1);
 
@@ -231,6 +253,51 @@ test_greater ()
     }
 }
 
+static void
+test_cmp ()
+{
+  uintN_t a, b, c, d;
+  uint16_t i, j;
+
+  uintN_zeroize (&a);
+  uintN_zeroize (&b);
+  assert(uintN_cmp (&a, &b) == 0);
+
+  for (i = 0; i < 64; i++)
+    {
+      uintN_random_bits (&a, NUMBER_OF_BITS);
+      uintN_set (&b, a.parts);
+      assert(uintN_cmp (&a, &b) == 0);
+
+      // one limb apart, from the bottom limb to the top one
+      j = i % NUMBER_OF_PARTS;
+      b.parts[j] ^= 1ull << (i % 64);
+      assert(uintN_cmp (&a, &b)
+	  == uintp_cmp (a.parts, b.parts, NUMBER_OF_PARTS));
+      assert(uintN_cmp (&b, &a) == -uintN_cmp (&a, &b));
+      assert(uintN_isless (&a, &b) == (uintN_cmp (&a, &b) < 0));
+      assert(uintN_isgreatoreq (&a, &b) == (uintN_cmp (&a, &b) >= 0));
+
+      uintN_random_bits (&b, NUMBER_OF_BITS);
+      assert(uintN_cmp (&a, &b)
+	  == uintp_cmp (a.parts, b.parts, NUMBER_OF_PARTS));
+
+      uintN_cselect (&a, &b, 1, &c);
+      assert(uintN_isequal (&c, &a));
+      uintN_cselect (&a, &b, 0, &c);
+      assert(uintN_isequal (&c, &b));
+
+      uintN_set (&c, a.parts);
+      uintN_set (&d, b.parts);
+      uintN_cswap (&c, &d, 0);
+      assert(uintN_isequal (&c, &a) && uintN_isequal (&d, &b));
+      uintN_cswap (&c, &d, 1);
+      assert(uintN_isequal (&c, &b) && uintN_isequal (&d, &a));
+      uintN_cswap (&c, &c, 1);
+      assert(uintN_isequal (&c, &b));
+    }
+}
+
 static void
 test_oddeven ()
 {
@@ -298,6 +365,112 @@ test_gcd ()
   assert(uintN_isequal (&c, &check) == 1);
 }
 
+static void
+test_div ()
+{
+  uintN_t a =
+    { 0x13579bdf2468ace0, 0xf3a1c5e7b9d24680, 0x13579bdf2468ace0,
+	0xf3a1c5e7b9d24680, 0x13579bdf2468ace0, 0xf3a1c5e7b9d24680,
+	0x13579bdf2468ace0, 0xf3a1c5e7b9d24680, 0x13579bdf2468ace0,
+	0xf3a1c5e7b9d24680, 0x13579bdf2468ace0, 0xf3a1c5e7b9d24680 };
+  uintN_t m =
+    { 0x0b1c2d3e4f506172, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506172,
+	0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506172, 0xc7e1a3b5d9f2468a };
+  uintN_t q_check =
+    { 0x58f1150b21dbf65b, 0xd490ba614ac0048f, 0x338e64a2226ed0de,
+	0x719850ee7806d986, 0x6c2244cbc9c1ce11, 0x3808ad53e2586743, 0x01 };
+  uintN_t r_check =
+    { 0x638de648a6ac7d5a, 0x38fcefdce79fd8c9, 0x638de648a6ac7d5a,
+	0x38fcefdce79fd8c9, 0x638de648a6ac7d5a, 0x38fcefdce79fd8c9 };
+  uintN_t q, r;
+
+  uintN_div (&a, &m, &q);
+  uintN_mod (&a, &m, &r);
+  assert(uintN_isequal (&q, &q_check) == 1);
+  assert(uintN_isequal (&r, &r_check) == 1);
+}
+
+static void
+test_uintp ()
+{
+  uint64_t a[3] =
+    { ~0ull, ~0ull, 0x00 };
+  uint64_t b[3] =
+    { 0x01, 0x00, 0x00 };
+  uint64_t r[3], s[4], t[4];
+
+  assert(uintp_add_n (r, a, b, 2) == 1);
+  assert(r[0] == 0 && r[1] == 0);
+  assert(uintp_sub_n (r, r, b, 2) == 1);
+  assert(uintp_cmp (r, a, 2) == 0);
+
+  // (2^128 - 1) * 2 = 2^129 - 2
+  assert(uintp_mul_1 (r, a, 2, 0x02) == 1);
+  assert(r[0] == ~1ull && r[1] == ~0ull);
+  assert(uintp_submul_1 (r, a, 2, 0x02) == 1);
+  assert(uintp_normalize (r, 2) == 0);
+
+  assert(uintp_lshift (r, a, 2, 4) == 0x0f);
+  assert(uintp_rshift (r, r, 2, 4) == 0);
+  assert(r[0] == ~0ull && r[1] == 0x0fffffffffffffff);
+
+  uintp_sqr (s, r, 2);
+  uintp_mul (t, r, 2, r, 2);
+  assert(memcmp (s, t, sizeof(s)) == 0);
+}
+
+static void
+test_ui ()
+{
+  uintN_t a =
+    { ~0ull, ~0ull, 0x05 };
+  uintN_t check =
+    { 0x00, 0x00, 0x06 };
+  uintN_t b, q, r, q_check, r_check;
+  uint64_t d[] =
+    { 0x03, 10, 0xfffffffb, 1ull << 63, ~0ull, 0x1234567890abcdefull };
+  size_t i;
+
+  uintN_add_ui (&a, 1, &b);
+  assert(uintN_isequal (&b, &check) == 1);
+  uintN_sub_ui (&b, 1, &b);
+  assert(uintN_isequal (&b, &a) == 1);
+  uintN_inc (&b);
+  assert(uintN_isequal (&b, &check) == 1);
+  uintN_dec (&b);
+  assert(uintN_isequal (&b, &a) == 1);
+
+  // carry out of the top limb wraps around
+  memset (b.parts, 0xff, NUMBER_OF_BYTES);
+  uintN_add_ui (&b, 2, &b);
+  assert(uintN_isone (&b) == 1);
+
+  for (i = 0; i < sizeof(d) / sizeof(d[0]); i++)
+    {
+      uintN_zeroize (&b);
+      b.parts[0] = d[i];
+
+      uintN_mul_ui (&a, d[i], &q);
+      uintN_mul (&a, &b, &check);
+      assert(uintN_isequal (&q, &check) == 1);
+
+      uintN_div (&a, &b, &q_check);
+      uintN_mod (&a, &b, &r_check);
+      assert(uintN_divmod_ui (&a, d[i], &q) == r_check.parts[0]);
+      assert(uintN_isequal (&q, &q_check) == 1);
+      assert(uintN_mod_ui (&a, d[i]) == r_check.parts[0]);
+
+      // in place
+      r = a;
+      uintN_divmod_ui (&r, d[i], &r);
+      assert(uintN_isequal (&r, &q_check) == 1);
+    }
+
+  uintN_zeroize (&b);
+  assert(uintN_divmod_ui (&b, 7, &q) == 0);
+  assert(uintN_iszero (&q) == 1);
+}
+
 static void
 test_mod ()
 {
@@ -353,25 +526,1239 @@ test_modp ()
       "a63fb6b665165b254ed49b84bfdb1912d900eb55d302a649c55a5640533c4bc22ace842e2ff7d396ddca4ac226bcae5d390163c2b1599e81aa736a9fa0fad3ed006efd0666769988c99753c92882c4cefcd0586dd0c7fb01027225cbcdb6a5638dd414ee69b9db1a4ce3089349b8c83ce7e84da0e7073351100f64a738c999f11ccb6276d2f67bd199bbd31f2d5cdfe8155edd0e2733e8a324116ca535c622e788334e75911dd79e88da82655522e82ed42d5f4c7b78f0ee5ea6beb26fb718f7df1408da7d4051c24e4cb7e0f4ddcd6bf98039eacd92d02217b2ad8dcbab196c0799f79e352a487626f389cd180075d8a8d1a59161692675499c1c65e14f3fe5";
   char *d_str =
       "1635d1dfa93ea4dba59df2cef7e0ba07521574db48ef042f3bddf742edbbd2f53449d5cfe3d9ac9b6db30e6cc4c715565ffcc70aa62dee66ad52710eb56f7d2b9f10b4de0b8751b8bc11eb002758dd19381e4f8a1047ff4921be053da6947da100bc3235adcb4631cbced300f66ae8d976340b56f1367d8d1963ad13481b6ae4db90cfddd45f20148aefe1462271e484d9a8e5ece9b7dae558c5467d37869cf43e7ac7b10bd89825743b1c3ad10a25012dee4fadc23a5b277dd083e11bc40e40a035dffa2b44af2affafc7941448349a3ab1abc3cbcb584a900c8bffdfd5a077475dca2e0d52e7e70863f86e190eddfbb1837b2075db28d2c561b7957e95894b";
-  char *EM_str =
-      "ff3fb6b665165b254ed49b84bfdb1912d900eb55d302a649c55a5640533c4bc22ace842e2ff7d396ddca4ac226bcae5d390163c2b1599e81aa736a9fa0fad3ed006efd0666769988c99753c92882c4cefcd0586dd0c7fb01027225cbcdb6a5638dd414ee69b9db1a4ce3089349b8c83ce7e84da0e7073351100f64a738c999f11ccb6276d2f67bd199bbd31f2d5cdfe8155edd0e2733e8a324116ca535c622e788334e75911dd79e88da82655522e82ed42d5f4c7b78f0ee5ea6beb26fb718f7df1408da7d4051c24e4cb7e0f4ddcd6bf98039eacd92d02217b2ad8dcbab196c0799f79e352a487626f389cd180075d8a8d1a59161692675499c1c65e14f40bc";
 
-  uintN_t n, d, mod, EM;
+  uintN_t n, d, mod;
 
   uintN_zeroize (&mod);
   mod.parts[0] = 0x800;
 
   uintN_readstr (n_str, &n);
   uintN_readstr (d_str, &d);
-  uintN_readstr (EM_str, &EM);
 
   uintN_t c;
   uintN_zeroize (&c);
 
+  // n is even and d >= 11, so n ^ d is a multiple of 2 ^ 11
   uintN_modp (&n, &d, &mod, &c);
-  uintN_print (&c);
+  assert(uintN_iszero (&c) == 1);
+}
+
+static void
+test_modp_2 ()
+{
+  uintN_t a =
+    { 0x13579bdf2468ace0, 0xf3a1c5e7b9d24680, 0x13579bdf2468ace0,
+	0xf3a1c5e7b9d24680, 0x13579bdf2468ace0, 0xf3a1c5e7b9d24680,
+	0x13579bdf2468ace0, 0xf3a1c5e7b9d24680, 0x13579bdf2468ace0,
+	0xf3a1c5e7b9d24680, 0x13579bdf2468ace0, 0xf3a1c5e7b9d24680 };
+  uintN_t m =
+    { 0x0b1c2d3e4f506172, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506172,
+	0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506172, 0xc7e1a3b5d9f2468a };
+  uintN_t e =
+    { 0x10001 };
+  uintN_t check =
+    { 0x38f616ac04260f14, 0x3fbe8c42d184ee5b, 0x38f616ac04260f14,
+	0x3fbe8c42d184ee5b, 0x38f616ac04260f14, 0x3fbe8c42d184ee5b };
+  uintN_t c;
+
+  uintN_modp (&a, &e, &m, &c);
+  assert(uintN_isequal (&c, &check) == 1);
+}
+
+static void
+test_workspace ()
+{
+  uintN_ws_t ws;
+  uintN_t a =
+    { 0x02dde08c3b };
+  uintN_t b =
+    { 0x2bdf };
+  uintN_t check =
+    { 0x129b };
+  uintN_t c;
+  size_t mark;
+  uint64_t *p;
+
+  assert(uintN_ws_init (&ws, UINTN_WS_DEFAULT_PARTS, 0) == 1);
+
+  mark = uintN_ws_mark (&ws);
+  p = uintN_ws_alloc (&ws, 4);
+  p[0] = 0xdeadbeef;
+  uintN_ws_release (&ws, mark);
+  assert(uintN_ws_alloc (&ws, 4) == p);
+  uintN_ws_release (&ws, mark);
+
+  uintN_mod_ws (&a, &b, &c, &ws);
+  assert(uintN_isequal (&c, &check) == 1);
+  assert(uintN_ws_mark (&ws) == mark);
+
+  // releasing the outermost mark wipes, a nested release does not
+  p = uintN_ws_alloc (&ws, 4);
+  uintN_ws_alloc (&ws, 4)[0] = 0xdeadbeef;
+  uintN_ws_release (&ws, 4);
+  assert(p[4] == 0xdeadbeef);
+  uintN_ws_release (&ws, mark);
+  assert(p[4] == 0);
+
+  // everything handed out is wiped, not only what is still in use
+  p = uintN_ws_alloc (&ws, 8);
+  p[4] = 0xdeadbeef;
+  uintN_ws_release (&ws, 4);
+  uintN_ws_wipe (&ws);
+  assert(p[4] == 0);
+  uintN_ws_release (&ws, mark);
+
+  uintN_ws_free (&ws);
+  assert(ws.base == NULL);
+
+  // locked pages may be refused by RLIMIT_MEMLOCK, that is not an error here
+  if (uintN_ws_init (&ws, NUMBER_OF_PARTS * 8, UINTN_WS_LOCKED))
+    {
+      uintN_mod_ws (&a, &b, &c, &ws);
+      assert(uintN_isequal (&c, &check) == 1);
+      uintN_ws_free (&ws);
+    }
+}
+
+static void
+test_fixedbase ()
+{
+  uintN_t g =
+    { 0x05 };
+  uintN_t p =
+    { 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173,
+	0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a };
+  uintN_t e =
+    { 0x468013579bdf2468, 0xace0f3a1c5e7b9d2, 0x468013579bdf2468,
+	0xace0f3a1c5e7b9d2, 0x468013579bdf2468, 0x0000f3a1c5e7b9d2 };
+  uintN_t check =
+    { 0xbe1280c6dd921f81, 0x3d225c594a5905f2, 0xe80adb0dca8771db,
+	0x87aa04129362bf3a, 0x1c3eb0f36208a262, 0x1c4082908ed148c8 };
+  uintN_t c;
+  uintN_fb_t fb;
+
+  // odd modulus, through Montgomery
+  uintN_modp (&g, &e, &p, &c);
+  assert(uintN_isequal (&c, &check) == 1);
+
+  assert(uintN_fb_init (&fb, &g, &p, 384, UINTN_FB_TEETH, UINTN_FB_BLOCKS));
+  uintN_fb_modp (&fb, &e, &c, uintN_ws_thread ());
+  assert(uintN_isequal (&c, &check) == 1);
+
+  // longer than the table was built for
+  uintN_lshift (&e, 32, &e);
+  uintN_fb_modp (&fb, &e, &c, uintN_ws_thread ());
+  uintN_modp (&g, &e, &p, &check);
+  assert(uintN_isequal (&c, &check) == 1);
+  uintN_fb_free (&fb);
+
+  uintN_dec (&p);
+  assert(uintN_fb_init (&fb, &g, &p, 384, UINTN_FB_TEETH, UINTN_FB_BLOCKS) == 0);
+}
+
+static void
+test_tables ()
+{
+  uintN_t g =
+    { 0x05 };
+  uintN_t p =
+    { 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173,
+	0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a };
+  uintN_t e =
+    { 0x468013579bdf2468, 0xace0f3a1c5e7b9d2, 0x468013579bdf2468,
+	0xace0f3a1c5e7b9d2, 0x468013579bdf2468, 0x0000f3a1c5e7b9d2 };
+  uintN_t c, check;
+  uintN_fb_t fb, mapped;
+  uintN_mont_t ctx, loaded;
+  uintN_tables_t t;
+  char path[] = "/tmp/tablesXXXXXX";
+  struct stat st;
+  uint8_t byte;
+  int fd;
+
+  assert(uintN_fb_init (&fb, &g, &p, 384, UINTN_FB_TEETH, UINTN_FB_BLOCKS));
+  assert(uintN_mont_init (&ctx, &p));
+  uintN_tables_rec_t recs[] =
+    {
+      { "group", NULL, &fb },
+      { "modulus", &ctx, NULL } };
+
+  fd = mkstemp (path);
+  assert(fd >= 0);
+  close (fd);
+  assert(uintN_tables_save (path, recs, 2));
+  assert(stat (path, &st) == 0 && (st.st_mode & 0777) == 0644);
+  recs[1].name = "group";
+  assert(!uintN_tables_save (path, recs, 2));
+
+  assert(uintN_tables_open (&t, path));
+  assert(uintN_tables_mont (&t, "modulus", &loaded));
+  assert(memcmp (&loaded, &ctx, sizeof(ctx)) == 0);
+  assert(!uintN_tables_mont (&t, "group", &loaded));
+  assert(!uintN_tables_fb (&t, "missing", &mapped));
+
+  assert(uintN_tables_fb (&t, "group", &mapped));
+  assert(mapped.mapped);
+  uintN_fb_modp (&fb, &e, &check, uintN_ws_thread ());
+  uintN_fb_modp (&mapped, &e, &c, uintN_ws_thread ());
+  assert(uintN_isequal (&c, &check) == 1);
+  uintN_fb_free (&mapped);
+  uintN_tables_close (&t);
+
+  // a damaged record no longer loads, a damaged header no file at all
+  fd = open (path, O_RDWR);
+  assert(fd >= 0);
+  assert(pread (fd, &byte, 1, 4096) == 1);
+  byte ^= 0x01;
+  assert(pwrite (fd, &byte, 1, 4096) == 1);
+  assert(uintN_tables_open (&t, path));
+  assert(!uintN_tables_fb (&t, "group", &mapped));
+  assert(uintN_tables_mont (&t, "modulus", &loaded));
+  uintN_tables_close (&t);
+  assert(pwrite (fd, "x", 1, 8) == 1);
+  assert(!uintN_tables_open (&t, path) && errno == EINVAL);
+  close (fd);
+
+  unlink (path);
+  uintN_fb_free (&fb);
+}
+
+static void
+test_modarith ()
+{
+  uintN_t m =
+    { 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173,
+	0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a };
+  uintN_t a0 =
+    { 0x083b6ea0d5184b6d, 0x2bc02231dfdffff6, 0x083b6ea0d5184b6d,
+	0x2bc02231dfdffff6, 0x083b6ea0d5184b6d, 0x2bc02231dfdffff6 };
+  uintN_t a1 =
+    { 0x0123456789abcdef };
+  uintN_t a2 =
+    { 0x0b1c2d3e4f506172, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173,
+	0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a };
+  uintN_t b0 =
+    { 0x0b1c2d3e4f506171, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173,
+	0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a };
+  uintN_t b1 =
+    { 0x0123456789abcdef, 0x0123456789abcdef, 0x0123456789abcdef,
+	0x0123456789abcdef, 0x0123456789abcdef, 0x0123456789abcdef };
+  uintN_t sop_check =
+    { 0x15003372d3b2ccaf, 0x71b2c5c0c31be18d, 0x15003372d3b2ccae,
+	0x71b2c5c0c31be18d, 0x15003372d3b2ccae, 0x71b2c5c0c31be18d };
+  uintN_t addmul_check =
+    { 0xfbc895642ecb9888, 0x70615f521a32469d, 0xfaa54ffca51fca99,
+	0x70615f521a32469d, 0xfaa54ffca51fca99, 0x70615f521a32469d };
+  uintN_t sub_check =
+    { 0x0404040503e3e3f5, 0x9c218183fa124694, 0x02e0be9d7a381606,
+	0x9c218183fa124694, 0x02e0be9d7a381606, 0x9c218183fa124694 };
+  uintN_t submul_check =
+    { 0xfbc895642ecb9888, 0x7184a4b9a3de148c, 0xfbc895642ecb9888,
+	0x7184a4b9a3de148c, 0xfbc895642ecb9888, 0x7184a4b9a3de148c };
+  const uintN_t *a[] =
+    { &a0, &a1, &a2 };
+  const uintN_t *b[] =
+    { &b0, &b1, &a2 };
+  uintN_t c, d;
+  uintN_modacc_t acc;
+
+  uintN_modsop (a, b, 3, &m, &c);
+  assert(uintN_isequal (&c, &sop_check) == 1);
+
+  uintN_modaddmul (&a1, &a0, &b0, &m, &c);
+  assert(uintN_isequal (&c, &addmul_check) == 1);
+
+  uintN_modsub (&a1, &a0, &m, &c);
+  assert(uintN_isequal (&c, &sub_check) == 1);
+  uintN_modadd (&c, &a0, &m, &c);
+  assert(uintN_isequal (&c, &a1) == 1);
+
+  uintN_modneg (&a2, &m, &c);
+  assert(uintN_isone (&c) == 1);
+
+  uintN_modmul (&a2, &a2, &m, &c);
+  uintN_modsqr (&a2, &m, &d);
+  assert(uintN_isone (&c) == 1);
+  assert(uintN_isone (&d) == 1);
+
+  uintN_modacc_init (&acc, &m);
+  uintN_modacc_addmul (&acc, &a0, &b0);
+  uintN_modacc_submul (&acc, &a2, &b1);
+  uintN_modacc_get (&acc, &c);
+  assert(uintN_isequal (&c, &submul_check) == 1);
+  uintN_modacc_zeroize (&acc);
+}
+
+static void
+test_modinv ()
+{
+  // 2^127 - 1 is prime
+  uintN_t m =
+    { ~0ull, 0x7fffffffffffffff };
+  uintN_t m15 =
+    { 0x0f };
+  uintN_t a[16], c[16], t, f0;
+  uint8_t seed[32] =
+    { 0x02 };
+  uintN_rng_t rng;
+  size_t i;
+
+  uintN_rng_seed (&rng, seed);
+  for (i = 0; i < 16; i++)
+    do
+      uintN_random_below_rng (&a[i], &m, &rng);
+    while (uintN_iszero (&a[i]));
+
+  assert(uintN_modinv_batch (a, 16, &m, c));
+  for (i = 0; i < 16; i++)
+    {
+      uintN_modmul (&a[i], &c[i], &m, &t);
+      assert(uintN_isone (&t) == 1);
+      assert(uintN_modinv (&a[i], &m, &t));
+      assert(uintN_isequal (&t, &c[i]) == 1);
+    }
+
+  assert(uintN_modinv_batch (a, 1, &m, c));
+  uintN_modmul (&a[0], &c[0], &m, &t);
+  assert(uintN_isone (&t) == 1);
+
+  // gcd(5, 15) = 5
+  uintN_zeroize (&a[0]);
+  uintN_zeroize (&a[1]);
+  a[0].parts[0] = 0x02;
+  a[1].parts[0] = 0x05;
+  assert(uintN_modinv (&a[0], &m15, &t));
+  assert(t.parts[0] == 0x08);
+  assert(!uintN_modinv (&a[1], &m15, &t));
+  assert(!uintN_modinv_batch (a, 2, &m15, c));
+  assert(!uintN_modinv (&m, &m, &t));
+
+  // even moduli, e.g. d = e^-1 mod lambda(n): 65537^-1 mod 2^127 - 2, a
+  // above m, a = 1 and a common factor 2
+  uintN_t m2 =
+    { ~0ull - 1, 0x7fffffffffffffff };
+  uintN_zeroize (&a[0]);
+  a[0].parts[0] = 0x010001;
+  assert(uintN_modinv (&a[0], &m2, &t));
+  uintN_modmul (&a[0], &t, &m2, &f0);
+  assert(uintN_isone (&f0) && uintN_isless (&t, &m2));
+  for (i = 0; i < 8; i++)
+    {
+      uintN_rng_bytes (&rng, a[0].parts, 3 * sizeof(uint64_t));
+      a[0].parts[0] |= 1;
+      if (uintN_modinv (&a[0], &m2, &t))
+	{
+	  uintN_modmul (&a[0], &t, &m2, &f0);
+	  assert(uintN_isone (&f0) && uintN_isless (&t, &m2));
+	}
+    }
+  uintN_zeroize (&a[0]);
+  a[0].parts[0] = 0x01;
+  assert(uintN_modinv (&a[0], &m2, &t) && uintN_isone (&t));
+  a[0].parts[0] = 0x06;
+  assert(!uintN_modinv (&a[0], &m2, &t));
+  uintN_zeroize (&m2);
+  m2.parts[3] = 1ull << 63;
+  a[0].parts[0] = 0x010001;
+  assert(uintN_modinv (&a[0], &m2, &t));
+  uintN_modmul (&a[0], &t, &m2, &f0);
+  assert(uintN_isone (&f0) && uintN_isless (&t, &m2));
+
+  // against Fermat modulo the order of P-256, for a above n and longer
+  // than n
+  uintN_t n =
+    { 0xf3b9cac2fc632551, 0xbce6faada7179e84, 0xffffffffffffffff,
+	0xffffffff00000000 };
+  uintN_t e, f;
+
+  uintN_set (&e, n.parts);
+  uintN_sub_ui (&e, 2, &e);
+  for (i = 0; i < 3; i++)
+    {
+      uintN_rng_bytes (&rng, a[0].parts, 4 * sizeof(uint64_t));
+      a[0].parts[3] |= 1ull << 63;
+      if (i == 2)
+	a[0].parts[NUMBER_OF_PARTS - 1] = 0x01;
+      assert(uintN_modinv (&a[0], &n, &t));
+      uintN_modp (&a[0], &e, &n, &f);
+      assert(uintN_isequal (&t, &f) == 1);
+    }
+}
+
+static void
+test_modcache ()
+{
+  uintN_t m[UINTN_MODCACHE_SLOTS + 1];
+  uintN_mont_t ctx, check;
+  uintN_reducer_t red;
+  size_t i;
+
+  for (i = 0; i <= UINTN_MODCACHE_SLOTS; i++)
+    {
+      uintN_zeroize (&m[i]);
+      m[i].parts[0] = 2 * i + 3;
+      m[i].parts[1] = 0x0123456789abcdef;
+    }
+
+  assert(uintN_modcache_mont (&m[0], &ctx));
+  assert(uintN_mont_init (&check, &m[0]));
+  assert(memcmp (&ctx, &check, sizeof(ctx)) == 0);
+  m[0].parts[0]++;
+  assert(!uintN_modcache_mont (&m[0], &ctx));
+  m[0].parts[0]--;
+
+  // pinned entries are never evicted, so the slots run out
+  for (i = 0; i < UINTN_MODCACHE_SLOTS; i++)
+    assert(uintN_modcache_pin (&m[i]));
+  assert(!uintN_modcache_pin (&m[i]));
+
+  // the lookup still works, just without caching
+  assert(uintN_modcache_mont (&m[i], &ctx));
+  assert(uintN_mont_init (&check, &m[i]));
+  assert(memcmp (&ctx, &check, sizeof(ctx)) == 0);
+
+  uintN_modcache_clear ();
+  assert(uintN_modcache_mont (&m[1], &ctx));
+
+  for (i = 0; i < UINTN_MODCACHE_SLOTS; i++)
+    uintN_modcache_unpin (&m[i]);
+  assert(uintN_modcache_pin (&m[i]));
+  uintN_modcache_unpin (&m[i]);
+  uintN_modcache_clear ();
+
+  // a peek detects the form of a modulus it does not have
+  uintN_zeroize (&m[0]);
+  m[0].parts[0] = 0xffffffffffffffed;
+  m[0].parts[1] = 0x7fffffffffffffff;
+  assert(uintN_modcache_reducer_peek (&m[0], &red));
+  assert(red.form == UINTN_FORM_PSEUDO_MERSENNE);
+  assert(!uintN_modcache_reducer_peek (&m[1], &red));
+
+  // one lookup gives both
+  assert(uintN_modcache_lookup (&m[1], &ctx, &red));
+  assert(uintN_mont_init (&check, &m[1]));
+  assert(memcmp (&ctx, &check, sizeof(ctx)) == 0);
+  assert(red.form == UINTN_FORM_GENERIC);
+  m[2].parts[0]++;
+  assert(!uintN_modcache_lookup (&m[2], &ctx, &red));
+  uintN_modcache_clear ();
+}
+
+static void
+test_reducer ()
+{
+  uintN_t m1 =
+    { 0xffffffffffffffed, 0xffffffffffffffff, 0xffffffffffffffff,
+	0x7fffffffffffffff };
+  uintN_t m2 =
+    { 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+	0xfffffffeffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+	0xffffffffffffffff };
+  uintN_t m3 =
+    { 0x123456789abcdef1, 0x0fedcba987654321, 0xffffffffffffffff };
+  uintN_t m4 =
+    { 0xffffffffffffffff, 0x00000000ffffffff, 0x0000000000000000,
+	0xffffffff00000001 };
+  uintN_t m5 =
+    { 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+	0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+	0xffffffffffffffff, 0xffffffffffffffff, 0x00000000000001ff };
+  uintN_t m6 =
+    { 0x0123456789abcdef, 0x0000000000000001 };
+  uintN_t check1 =
+    { 0x2c5f92c5f92c5f69, 0x2c5f92c5f92c5f69, 0x2c5f92c5f92c5f69,
+	0x2c5f92c5f92c5f69 };
+  uintN_t check2 =
+    { 0x8bf258be147ae145, 0x8bf258be147ae145, 0x8bf258be147ae145,
+	0x8d159e25147ae145, 0x8d159e259e26af34, 0x8d159e259e26af34,
+	0x8d159e259e26af34 };
+  uintN_t check3 =
+    { 0x2ec663113e49287a, 0xaf98257aeff59d90, 0x6db702470b0e3f6d };
+  uintN_t check5 =
+    { 0x9549e74e7f0795fe, 0xf8f2482252b5e9f6, 0xdfd5d02bbb2aed7f,
+	0x10697284a1bd8bc7, 0x059e7987ba0576c9, 0x6d7251fb8a1f79c0,
+	0x9f69249dff5f2e06, 0x4695ba207206027a, 0x00000000000000cd };
+  uintN_t three =
+    { 0x03 };
+  uintN_t e =
+    { 0x01, 0x01 };
+  uintN_t a, c;
+  uintN_reducer_t red;
+  uint16_t i;
+
+  assert(uintN_reducer_init (&red, &m1) == 1);
+  assert(red.form == UINTN_FORM_PSEUDO_MERSENNE);
+  assert(uintN_reducer_init (&red, &m2) == 1);
+  assert(red.form == UINTN_FORM_SOLINAS);
+  assert(uintN_reducer_init (&red, &m3) == 1);
+  assert(red.form == UINTN_FORM_TOP_ONES);
+  // d = 2^224 - 2^192 - 2^96 + 1 is too wide to fold
+  assert(uintN_reducer_init (&red, &m4) == 0);
+  assert(red.form == UINTN_FORM_GENERIC);
+  // d = 0xfedcba9876543211 is almost as wide as m = 2^65 - d, a fold
+  // would take off a single bit
+  assert(uintN_reducer_init (&red, &m6) == 0);
+  assert(red.form == UINTN_FORM_GENERIC);
+  assert(uintN_reducer_maybe (&m1) && uintN_reducer_maybe (&m2));
+  assert(uintN_reducer_maybe (&m3) && !uintN_reducer_maybe (&m6));
+
+  uintN_zeroize (&a);
+  for (i = 0; i < 14; i++)
+    a.parts[i] = 0x0123456789abcdef;
+  uintN_mod (&a, &m2, &c);
+  assert(uintN_isequal (&c, &check2) == 1);
+
+  uintp_zero (a.parts + 8, NUMBER_OF_PARTS - 8);
+  uintN_mod (&a, &m1, &c);
+  assert(uintN_isequal (&c, &check1) == 1);
+
+  uintp_zero (a.parts + 6, NUMBER_OF_PARTS - 6);
+  uintN_mod (&a, &m3, &c);
+  assert(uintN_isequal (&c, &check3) == 1);
+
+  // second lookup is served from the cache
+  assert(uintN_modcache_reducer (&m3, &red) == 1);
+  assert(red.form == UINTN_FORM_TOP_ONES);
 
-  assert(uintN_isequal (&c, &EM) == 1);
+  uintN_modp (&three, &e, &m5, &c);
+  assert(uintN_isequal (&c, &check5) == 1);
+}
+
+static void
+test_rsa ()
+{
+  // n = (2^255 - 19) (2^127 - 1)
+  uintN_t n =
+    { 0x0000000000000013, 0x8000000000000000, 0xfffffffffffffff6,
+	0x7fffffffffffffff, 0xffffffffffffffff, 0x3fffffffffffffff };
+  uintN_t sig1 =
+    { 0x8796a5b4c3d2e1f0, 0x0f1e2d3c4b5a6978, 0xfedcba9876543210,
+	0x0123456789abcdef };
+  uintN_t em1 =
+    { 0x11bfaad7b90a5a93, 0x3229f50fe4ed268e, 0x8774602ddfea5efe,
+	0xfce7ffc0d621208f, 0xe4e6e3f92cd741dd, 0x1844f0ca9bf29f2c };
+  uintN_t em2 =
+    { 0xf53b4d86e74af44c, 0x36a8ea807323e687, 0xb0af046ffa0f89ad,
+	0x0205a0cba1c424fe, 0xaa59aa6649257e0e, 0x3152f4fa1254f3de };
+  uintN_t em3 =
+    { 0xb1ef6083c5893238, 0x30d061f305ded18e, 0xe32832f7f3f7f4c1,
+	0x53b82604d183f43f, 0x3df42bd78b755471, 0x25f25c474c7f31ba };
+  uintN_t eml =
+    { 0xf7c77d5d47e044b2, 0xd73ad0d9b0c4e07f, 0x6171a4cefc28091e,
+	0x089bfba6b27679dc, 0x1066915d11c3a057, 0x2a950857956f0551 };
+  uintN_t d =
+    { 0x36b3c94c36b3c951, 0x36b3c94c36b3c94c, 0x690696f9690696f8,
+	0x690696f9690696f9, 0x87a8785787a87857, 0x07a8785787a87857 };
+  uintN_t sig2, c;
+  const uintN_t *sig[] =
+    { &sig1, &sig2, &sig1 };
+  const uintN_t *em[] =
+    { &em1, &em2, &em2 };
+  bool ok[3];
+  size_t i;
+  rsa_pub_t pub;
+  rsa_blind_t blind;
+  uintN_ws_t *ws = uintN_ws_thread ();
+
+  assert(rsa_pub_init (&pub, &n, 65536) == 0);
+  assert(rsa_pub_init (&pub, &n, 3) == 1);
+  assert(rsa_public (&pub, &sig1, &c, ws) == 1);
+  assert(uintN_isequal (&c, &em3) == 1);
+
+  assert(rsa_pub_init (&pub, &n, 0x8000000123456789) == 1);
+  assert(rsa_public (&pub, &sig1, &c, ws) == 1);
+  assert(uintN_isequal (&c, &eml) == 1);
+
+  assert(rsa_pub_init (&pub, &n, RSA_F4) == 1);
+  assert(rsa_verify (&pub, &sig1, &em1, ws) == 1);
+  assert(rsa_verify (&pub, &sig1, &em2, ws) == 0);
+  assert(rsa_public (&pub, &n, &c, ws) == 0);
+
+  // sig2 = n - 2
+  uintN_set (&sig2, n.parts);
+  sig2.parts[0] -= 2;
+  assert(rsa_verify_batch (&pub, sig, em, 3, ok, ws) == 2);
+  assert(ok[0] == 1 && ok[1] == 1 && ok[2] == 0);
+
+  assert(rsa_private (&pub, &d, NULL, &em1, &c, ws) == 1);
+  assert(uintN_isequal (&c, &sig1) == 1);
+
+  // past the limit of 3 uses the factors are drawn again
+  assert(rsa_blind_init (&blind, &pub, 3) == 1);
+  for (i = 0; i < 8; i++)
+    {
+      assert(rsa_private (&pub, &d, &blind, &em1, &c, ws) == 1);
+      assert(uintN_isequal (&c, &sig1) == 1);
+    }
+  assert(rsa_private (&pub, &d, &blind, &n, &c, ws) == 0);
+  rsa_blind_free (&blind);
+
+  // the constant-time ladder agrees with uintN_mont_modp, zero windows and
+  // a zero exponent included
+  uintN_t e0 =
+    { 0x8000000000000001, 0x01 };
+  uintN_mont_modp (&pub.mont, &em1, &e0, &sig2, ws);
+  uintN_mont_modp_ct (&pub.mont, &em1, &e0, 130, &c, ws);
+  assert(uintN_isequal (&c, &sig2) == 1);
+  uintN_zeroize (&e0);
+  uintN_mont_modp_ct (&pub.mont, &em1, &e0, 64, &c, ws);
+  assert(uintN_isone (&c) == 1);
+}
+
+static void
+count_job (uintN_job_t *job, void *arg)
+{
+  __atomic_add_fetch ((int *) arg, job->ok, __ATOMIC_RELAXED);
+}
+
+static void
+test_jobpool ()
+{
+  uintN_t m =
+    { 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173,
+	0xc7e1a3b5d9f2468a };
+  uintN_t e =
+    { 0x1234567890abcdef, 0x01 };
+  uintN_t n =
+    { 0x0000000000000013, 0x8000000000000000, 0xfffffffffffffff6,
+	0x7fffffffffffffff, 0xffffffffffffffff, 0x3fffffffffffffff };
+  uintN_t b[24], c;
+  uintN_job_t jobs[32], *done[32];
+  rsa_pub_t pub;
+  uintN_pool_t pool;
+  size_t i, k;
+  int ok = 0;
+
+  assert(uintN_pool_init (&pool, 4) == 1);
+  assert(rsa_pub_init (&pub, &n, RSA_F4) == 1);
+
+  for (i = 0; i < 24; i++)
+    {
+      uintN_zeroize (&b[i]);
+      b[i].parts[0] = i + 2;
+      uintN_job_modp (&jobs[i], &b[i], &e, &m);
+      uintN_pool_submit (&pool, &jobs[i], NULL, NULL);
+    }
+  for (i = 24; i < 32; i++)
+    {
+      uintN_job_rsa_public (&jobs[i], &pub, &b[i - 24]);
+      uintN_pool_submit (&pool, &jobs[i], count_job, &ok);
+    }
+
+  uintN_pool_drain (&pool);
+  assert(ok == 8);
+
+  k = uintN_pool_reap (&pool, done, 32);
+  assert(k == 24);
+  assert(uintN_pool_reap (&pool, done, 32) == 0);
+
+  for (i = 0; i < 32; i++)
+    {
+      assert(uintN_job_done (&jobs[i]) == 1);
+      if (i < 24)
+	uintN_modp (&b[i], &e, &m, &c);
+      else
+	rsa_public (&pub, &b[i - 24], &c, uintN_ws_thread ());
+      assert(uintN_isequal (&jobs[i].result, &c) == 1);
+    }
+
+  uintN_pool_free (&pool);
+}
+
+static void
+test_random ()
+{
+  // RFC 8439, A.1 test vector 1, bytes 32 to 39 of the first block (the
+  // first 32 bytes become the next key)
+  uint8_t seed[32] =
+    { 0x00 };
+  uint8_t check[8] =
+    { 0xda, 0x41, 0x59, 0x7c, 0x51, 0x57, 0x48, 0x8d };
+  uint8_t out[8];
+  uintN_t m =
+    { 0x01, 0x00, 0x8000000000000000 };
+  uintN_t r[64];
+  uintN_rng_t rng;
+  size_t i;
+
+  uintN_rng_seed (&rng, seed);
+  uintN_rng_bytes (&rng, out, sizeof(out));
+  assert(memcmp (out, check, sizeof(out)) == 0);
+  uintN_rng_zeroize (&rng);
+
+  uintN_random_fill (r, 64, &m);
+  for (i = 0; i < 64; i++)
+    assert(uintN_isless (&r[i], &m) == 1);
+  assert(uintN_isequal (&r[0], &r[1]) == 0);
+
+  uintN_random_bits (&r[0], 65);
+  assert(r[0].parts[1] <= 1 && r[0].parts[2] == 0);
+
+  m.parts[2] = 0;
+  m.parts[0] = 0x03;
+  uintN_random_below (&r[0], &m);
+  assert(uintN_isless (&r[0], &m) == 1);
+}
+
+static void
+test_ntt ()
+{
+  size_t len[][2] =
+    {
+      { 1, 1 },
+      { 3, 1 },
+      { 17, 40 },
+      { UINTP_NTT_THRESHOLD, UINTP_NTT_THRESHOLD + 3 } };
+  size_t n = 2 * UINTP_NTT_THRESHOLD + 3;
+  uint64_t *a, *b, *r, *check, *tp;
+  uint8_t seed[32] =
+    { 0x01 };
+  uintN_rng_t rng;
+  size_t i, an, bn;
+
+  a = malloc (n * sizeof(uint64_t));
+  b = malloc (n * sizeof(uint64_t));
+  r = malloc (2 * n * sizeof(uint64_t));
+  check = malloc (2 * n * sizeof(uint64_t));
+  tp = malloc (uintp_mul_ntt_scratch (n, n) * sizeof(uint64_t));
+  assert(a != NULL && b != NULL && r != NULL && check != NULL && tp != NULL);
+
+  uintN_rng_seed (&rng, seed);
+  uintN_rng_bytes (&rng, a, n * sizeof(uint64_t));
+  uintN_rng_bytes (&rng, b, n * sizeof(uint64_t));
+  // all ones limbs give the largest coefficients
+  memset (a, 0xff, 8 * sizeof(uint64_t));
+
+  for (i = 0; i < sizeof(len) / sizeof(len[0]); i++)
+    {
+      an = len[i][0];
+      bn = len[i][1];
+
+      uintp_mul (check, a, an, b, bn);
+      uintp_mul_ntt (r, a, an, b, bn, tp);
+      assert(memcmp (r, check, (an + bn) * sizeof(uint64_t)) == 0);
+      assert(uintp_mul_large (r, a, an, b, bn));
+      assert(memcmp (r, check, (an + bn) * sizeof(uint64_t)) == 0);
+
+      // squaring transforms once
+      uintp_sqr (check, a, an);
+      uintp_mul_ntt (r, a, an, a, an, tp);
+      assert(memcmp (r, check, 2 * an * sizeof(uint64_t)) == 0);
+    }
+
+  free (tp);
+  free (check);
+  free (r);
+  free (b);
+  free (a);
+
+  // Newton division against Knuth's
+  an = 2 * UINTP_NTT_DIVREM_THRESHOLD + 5;
+  bn = UINTP_NTT_DIVREM_THRESHOLD + 1;
+  a = malloc (an * sizeof(uint64_t));
+  b = malloc (bn * sizeof(uint64_t));
+  r = malloc (2 * (an + 1) * sizeof(uint64_t));
+  check = malloc (2 * (an + 1) * sizeof(uint64_t));
+  tp = malloc (UINTP_DIVREM_SCRATCH(an, bn) * sizeof(uint64_t));
+  assert(a != NULL && b != NULL && r != NULL && check != NULL && tp != NULL);
+
+  uintN_rng_bytes (&rng, a, an * sizeof(uint64_t));
+  uintN_rng_bytes (&rng, b, bn * sizeof(uint64_t));
+  b[bn - 1] >>= 7;
+
+  uintp_divrem (check, check + an + 1, a, an, b, bn, tp);
+  assert(uintp_divrem_large (r, r + an + 1, a, an, b, bn));
+  assert(memcmp (r, check, (an - bn + 1) * sizeof(uint64_t)) == 0);
+  assert(memcmp (r + an + 1, check + an + 1, bn * sizeof(uint64_t)) == 0);
+
+  free (tp);
+  free (check);
+  free (r);
+  free (b);
+  free (a);
+}
+
+static void
+test_tune ()
+{
+  uintN_t m =
+    { 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173,
+	0xc7e1a3b5d9f2468a, 0x0b1c2d3e4f506173, 0xc7e1a3b5d9f2468a };
+  uintN_t b =
+    { 0x083b6ea0d5184b6d, 0x2bc02231dfdffff6, 0x083b6ea0d5184b6d };
+  uintN_t e =
+    { 0x468013579bdf2468, 0xace0f3a1c5e7b9d2, 0x468013579bdf2468,
+	0xace0f3a1c5e7b9d2, 0x468013579bdf2468, 0x0000f3a1c5e7b9d2 };
+  uintN_tune_t t, loaded, saved;
+  uintN_mont_t ctx;
+  struct stat st;
+  uintN_t c, check;
+  uint64_t a[40], d[17], q[24], r[17], q2[24], r2[17], tp[80];
+  uint8_t seed[32] =
+    { 0x02 };
+  uintN_rng_t rng;
+  char path[] = "/tmp/tuneXXXXXX";
+  FILE *f;
+  int fd;
+
+  uintN_tune_get (&saved);
+
+  uintN_tune_defaults (&t);
+  assert(uintN_tune_set (&t));
+  assert(uintN_tune_window (31) == 1);
+  assert(uintN_tune_window (32) == 3);
+  assert(uintN_tune_window (767) == 4);
+  assert(uintN_tune_window (2048) == 5);
+
+  t.window[1] = 8;
+  assert(!uintN_tune_set (&t));
+  t.window[1] = 0;
+  t.ntt_divrem = UINTN_TUNE_DIVREM_MIN - 1;
+  assert(!uintN_tune_set (&t));
+
+  // the transform and Newton division on short operands
+  uintN_rng_seed (&rng, seed);
+  uintN_rng_bytes (&rng, a, sizeof(a));
+  uintN_rng_bytes (&rng, d, sizeof(d));
+  d[16] |= 1;
+  uintN_tune_defaults (&t);
+  t.ntt_mul = 1;
+  t.ntt_divrem = UINTN_TUNE_DIVREM_MIN;
+  assert(uintN_tune_set (&t));
+  uintp_mul (tp, a, 20, d, 17);
+  assert(uintp_mul_large (tp + 40, a, 20, d, 17));
+  assert(memcmp (tp, tp + 40, 37 * sizeof(uint64_t)) == 0);
+  uintp_divrem (q, r, a, 40, d, 17, tp);
+  assert(uintp_divrem_large (q2, r2, a, 40, d, 17));
+  assert(memcmp (q, q2, sizeof(q)) == 0);
+  assert(memcmp (r, r2, sizeof(r)) == 0);
+
+  // every window width gives the same power
+  assert(uintN_mont_init (&ctx, &m));
+  uintN_tune_defaults (&t);
+  assert(uintN_tune_set (&t));
+  uintN_mont_modp (&ctx, &b, &e, &check, uintN_ws_thread ());
+  t.window[3] = t.window[4] = t.window[5] = UINTN_TUNE_NEVER;
+  assert(uintN_tune_set (&t));
+  uintN_mont_modp (&ctx, &b, &e, &c, uintN_ws_thread ());
+  assert(uintN_isequal (&c, &check) == 1);
+  t.window[2] = 0;
+  assert(uintN_tune_set (&t));
+  uintN_mont_modp (&ctx, &b, &e, &c, uintN_ws_thread ());
+  assert(uintN_isequal (&c, &check) == 1);
+
+  // a profile off the defaults in every field survives the file, the
+  // measurement itself is left to the tune mode of cryptolib
+  t.ntt_mul = 123;
+  t.ntt_divrem = UINTN_TUNE_NEVER;
+  t.window[2] = 7;
+  t.window[4] = 901;
+  fd = mkstemp (path);
+  assert(fd >= 0);
+  close (fd);
+  assert(uintN_tune_save (path, &t));
+  assert(stat (path, &st) == 0 && (st.st_mode & 0777) == 0644);
+  assert(uintN_tune_load (path, &loaded));
+  assert(memcmp (&loaded, &t, sizeof(t)) == 0);
+
+  f = fopen (path, "w");
+  assert(f != NULL);
+  fputs ("# comment\nuintN-tune 1\nntt_mul 700\nwindow 4 100\n", f);
+  fclose (f);
+  assert(uintN_tune_load (path, &loaded));
+  assert(loaded.ntt_mul == 700);
+  assert(loaded.ntt_divrem == UINTP_NTT_DIVREM_THRESHOLD);
+  assert(loaded.window[3] == UINTN_TUNE_NEVER && loaded.window[4] == 100);
+
+  f = fopen (path, "w");
+  assert(f != NULL);
+  fputs ("uintN-tune 2\nntt_mul 700\n", f);
+  fclose (f);
+  assert(!uintN_tune_load (path, &loaded) && errno == EINVAL);
+  f = fopen (path, "w");
+  assert(f != NULL);
+  fputs ("uintN-tune 1\nntt_mul 700 cycles\n", f);
+  fclose (f);
+  assert(!uintN_tune_load (path, &loaded) && errno == EINVAL);
+
+  unlink (path);
+  assert(uintN_tune_set (&saved));
+}
+
+/*
+ * c = a b (mod m) on limbs.
+ */
+static void
+mulmod_ref (const uintN_t *a, const uintN_t *b, const uintN_t *m, uintN_t *c)
+{
+  uint64_t t[2 * NUMBER_OF_PARTS], tp[UINTP_DIVREM_SCRATCH(2 * NUMBER_OF_PARTS,
+							   NUMBER_OF_PARTS)];
+  size_t n = uintp_normalize (m->parts, NUMBER_OF_PARTS);
+
+  uintp_mul (t, a->parts, NUMBER_OF_PARTS, b->parts, NUMBER_OF_PARTS);
+  uintN_zeroize (c);
+  uintp_divrem (NULL, c->parts, t, 2 * NUMBER_OF_PARTS, m->parts, n, tp);
+}
+
+static void
+test_rns ()
+{
+  uintN_t m[4], a, b, c, check, e, ma, mb;
+  uintN_rns_ctx_t ctx;
+  uintN_rns_t ra, rb, rc;
+  uintN_ws_t *ws = uintN_ws_thread ();
+  uint8_t seed[32] =
+    { 0x03 };
+  uintN_rng_t rng;
+  size_t i, j;
+
+  uintN_rng_seed (&rng, seed);
+
+  // full width odd, 1000 bits even, one limb and the smallest modulus
+  memset (m, 0, sizeof(m));
+  uintN_rng_bytes (&rng, m[0].parts, NUMBER_OF_BYTES);
+  m[0].parts[0] |= 1;
+  m[0].parts[NUMBER_OF_PARTS - 1] |= 1ull << 63;
+  uintN_rng_bytes (&rng, m[1].parts, 125);
+  m[1].parts[0] &= ~1ull;
+  m[1].parts[15] |= 1ull << 39;
+  m[2].parts[0] = 0xffffffffffffffc5;
+  m[3].parts[0] = 2;
+
+  for (i = 0; i < 4; i++)
+    {
+      assert(uintN_rns_init (&ctx, &m[i]));
+
+      for (j = 0; j < 4; j++)
+	{
+	  uintN_rng_bytes (&rng, a.parts, NUMBER_OF_BYTES);
+	  uintN_rng_bytes (&rng, b.parts, NUMBER_OF_BYTES);
+	  uintN_rns_to (&ctx, &a, &ra, ws);
+	  uintN_rns_to (&ctx, &b, &rb, ws);
+
+	  uintN_rns_from (&ctx, &ra, &c, ws);
+	  uintN_mod (&a, &m[i], &check);
+	  assert(uintN_isequal (&c, &check) == 1);
+
+	  uintN_rns_mul (&ctx, &ra, &rb, &rc);
+	  uintN_rns_from (&ctx, &rc, &c, ws);
+	  mulmod_ref (&a, &b, &m[i], &check);
+	  assert(uintN_isequal (&c, &check) == 1);
+
+	  // sums and differences are operands of the next product
+	  uintN_mod (&a, &m[i], &ma);
+	  uintN_mod (&b, &m[i], &mb);
+	  uintN_sub (&m[i], &mb, &e);
+	  if (uintN_isgreatoreq (&ma, &e))
+	    uintN_sub (&ma, &e, &e);
+	  else
+	    uintN_add (&ma, &mb, &e);
+	  uintN_rns_add (&ctx, &ra, &rb, &rc);
+	  uintN_rns_mul (&ctx, &rc, &rc, &rc);
+	  uintN_rns_from (&ctx, &rc, &c, ws);
+	  mulmod_ref (&e, &e, &m[i], &check);
+	  assert(uintN_isequal (&c, &check) == 1);
+
+	  uintN_sub (&ma, &mb, &e);
+	  if (uintN_isless (&ma, &mb))
+	    uintN_add (&e, &m[i], &e);
+	  uintN_rns_sub (&ctx, &ra, &rb, &rc);
+	  uintN_rns_mul (&ctx, &rc, &ra, &rc);
+	  uintN_rns_from (&ctx, &rc, &c, ws);
+	  mulmod_ref (&e, &ma, &m[i], &check);
+	  assert(uintN_isequal (&c, &check) == 1);
+	}
+
+      uintN_rng_bytes (&rng, a.parts, NUMBER_OF_BYTES);
+      uintN_rng_bytes (&rng, e.parts, NUMBER_OF_BYTES);
+      uintN_rns_modp (&ctx, &a, &e, &c, ws);
+      uintN_modp (&a, &e, &m[i], &check);
+      assert(uintN_isequal (&c, &check) == 1);
+
+      uintN_zeroize (&e);
+      uintN_rns_modp (&ctx, &a, &e, &c, ws);
+      assert(uintN_isone (&c));
+
+      uintN_rns_free (&ctx);
+    }
+
+  // no inverse of m modulo a prime of the bases
+  uintN_zeroize (&m[0]);
+  m[0].parts[0] = 0x3fffffffffffffc7;
+  assert(!uintN_rns_init (&ctx, &m[0]));
+  m[0].parts[0] = 1;
+  assert(!uintN_rns_init (&ctx, &m[0]));
+}
+
+/*
+ * c = a b mod f one bit of b at a time, m below NUMBER_OF_BITS.
+ */
+static void
+gf2m_mul_ref (const uintN_gf2m_t *f, const uintN_t *a, const uintN_t *b,
+	      uintN_t *c)
+{
+  unsigned int i, j;
+  uintN_t r;
+
+  uintN_zeroize (&r);
+  for (i = f->m; i-- > 0;)
+    {
+      uintN_lshift (&r, 1, &r);
+      if ((r.parts[f->m / PART_SIZE_BITS] >> (f->m % PART_SIZE_BITS)) & 1)
+	{
+	  r.parts[f->m / PART_SIZE_BITS] ^= 1ull << (f->m % PART_SIZE_BITS);
+	  r.parts[0] ^= 1;
+	  for (j = 0; j < f->terms; j++)
+	    r.parts[f->k[j] / PART_SIZE_BITS] ^= 1ull
+		<< (f->k[j] % PART_SIZE_BITS);
+	}
+      if ((b->parts[i / PART_SIZE_BITS] >> (i % PART_SIZE_BITS)) & 1)
+	for (j = 0; j < f->n; j++)
+	  r.parts[j] ^= a->parts[j];
+    }
+  uintN_set (c, r.parts);
+}
+
+static void
+test_gf2m ()
+{
+  unsigned int fields[][4] =
+    {
+      { 8, 4, 3, 1 },
+      { 128, 7, 2, 1 },
+      { 233, 74, 0, 0 },
+      { 283, 12, 7, 5 } };
+  uintN_ws_t *ws = uintN_ws_thread ();
+  uintN_gf2m_t f;
+  uintN_t a, b, c, check;
+  uint64_t x[5], y[3], r[8], r2[8];
+  uint8_t seed[32] =
+    { 0x04 };
+  uintN_rng_t rng;
+  size_t i, j;
+
+  uintN_rng_seed (&rng, seed);
+
+  // both carry-less products against shifts and xors
+  uintN_rng_bytes (&rng, x, sizeof(x));
+  uintN_rng_bytes (&rng, y, sizeof(y));
+  x[0] = UINT64_MAX;
+  uintp_clmul (r, x, 5, y, 3);
+  uintp_clmul_portable (r2, x, 5, y, 3);
+  assert(memcmp (r, r2, sizeof(r)) == 0);
+  memset (r2, 0, sizeof(r2));
+  for (i = 0; i < 5 * 64; i++)
+    if ((x[i / 64] >> (i % 64)) & 1)
+      for (j = 0; j < 3; j++)
+	{
+	  r2[i / 64 + j] ^= y[j] << (i % 64);
+	  if (i % 64 != 0)
+	    r2[i / 64 + j + 1] ^= y[j] >> (64 - i % 64);
+	}
+  assert(memcmp (r, r2, sizeof(r)) == 0);
+
+  assert(!uintN_gf2m_init (&f, 128, 128, 0, 0));
+  assert(!uintN_gf2m_init (&f, 128, 7, 1, 2));
+  assert(!uintN_gf2m_init (&f, NUMBER_OF_BITS + 1, 1, 0, 0));
+
+  for (i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+    {
+      assert(uintN_gf2m_init (&f, fields[i][0], fields[i][1], fields[i][2],
+			      fields[i][3]));
+
+      // x^m = f - x^m
+      uintN_zeroize (&a);
+      a.parts[f.m / PART_SIZE_BITS] = 1ull << (f.m % PART_SIZE_BITS);
+      uintN_gf2m_reduce (&f, &a, &c);
+      uintN_zeroize (&check);
+      check.parts[0] = 1;
+      for (j = 0; j < f.terms; j++)
+	check.parts[f.k[j] / PART_SIZE_BITS] |= 1ull
+	    << (f.k[j] % PART_SIZE_BITS);
+      assert(uintN_isequal (&c, &check) == 1);
+
+      for (j = 0; j < 8; j++)
+	{
+	  uintN_rng_bytes (&rng, a.parts, NUMBER_OF_BYTES);
+	  uintN_rng_bytes (&rng, b.parts, NUMBER_OF_BYTES);
+	  uintN_gf2m_reduce (&f, &a, &a);
+	  uintN_gf2m_reduce (&f, &b, &b);
+
+	  uintN_gf2m_mul (&f, &a, &b, &c, ws);
+	  gf2m_mul_ref (&f, &a, &b, &check);
+	  assert(uintN_isequal (&c, &check) == 1);
+
+	  uintN_gf2m_sqr (&f, &a, &c, ws);
+	  uintN_gf2m_mul (&f, &a, &a, &check, ws);
+	  assert(uintN_isequal (&c, &check) == 1);
+
+	  // (a + b) a^-1 = 1 + b a^-1
+	  assert(uintN_gf2m_inv (&f, &a, &c, ws));
+	  uintN_gf2m_mul (&f, &a, &c, &check, ws);
+	  assert(uintN_isone (&check));
+	  uintN_gf2m_add (&f, &a, &b, &check);
+	  uintN_gf2m_mul (&f, &check, &c, &check, ws);
+	  uintN_gf2m_mul (&f, &b, &c, &b, ws);
+	  b.parts[0] ^= 1;
+	  assert(uintN_isequal (&b, &check) == 1);
+	}
+
+      uintN_zeroize (&a);
+      assert(!uintN_gf2m_inv (&f, &a, &c, ws));
+    }
+
+  // the AES field: {53}^-1 = {ca}
+  assert(uintN_gf2m_init (&f, 8, 4, 3, 1));
+  uintN_zeroize (&a);
+  a.parts[0] = 0x53;
+  assert(uintN_gf2m_inv (&f, &a, &c, ws));
+  assert(c.parts[0] == 0xca);
+}
+
+static void
+batchgcd_found (size_t i, const uintN_t *g, void *arg)
+{
+  uintN_t *found = arg;
+
+  uintN_set (&found[i], g->parts);
+}
+
+/*
+ * m = 2^e - 1, gcd(2^a - 1, 2^b - 1) = 2^gcd(a, b) - 1.
+ */
+static void
+mersenne (uintN_t *m, size_t e)
+{
+  uintN_zeroize (m);
+  memset (m->parts, 0xff, e / PART_SIZE_BITS * sizeof(uint64_t));
+  if (e % PART_SIZE_BITS != 0)
+    m->parts[e / PART_SIZE_BITS] = (1ull << (e % PART_SIZE_BITS)) - 1;
+}
+
+static void
+test_batchgcd ()
+{
+  uintN_t *moduli, *found, g1021;
+  size_t e, i, j, k;
+  char path[] = "/tmp/batchgcdXXXXXX";
+  FILE *out;
+  int fd;
+
+  moduli = calloc (512, sizeof(uintN_t));
+  found = calloc (512, sizeof(uintN_t));
+  assert(moduli != NULL && found != NULL);
+
+  // prime exponents give pairwise coprime moduli
+  for (e = 257, k = 0; e < NUMBER_OF_BITS; e += 2)
+    {
+      for (j = 3; j * j <= e && e % j != 0; j += 2)
+	;
+      if (j * j > e)
+	mersenne (&moduli[k++], e);
+    }
+  // 2^2042 - 1 shares 2^1021 - 1, plus a duplicate
+  mersenne (&moduli[k++], 2 * 1021);
+  mersenne (&moduli[k++], 1279);
+  mersenne (&g1021, 1021);
+
+  assert(uintN_batchgcd (moduli, k, 4, batchgcd_found, found));
+  for (i = 0; i < k; i++)
+    if (uintN_isequal (&moduli[i], &g1021) || i == k - 2)
+      assert(uintN_isequal (&found[i], &g1021) == 1);
+    else if (uintN_isequal (&moduli[i], &moduli[k - 1]))
+      assert(uintN_isequal (&found[i], &moduli[i]) == 1);
+    else
+      assert(uintN_iszero (&found[i]) == 1);
+
+  fd = mkstemp (path);
+  assert(fd >= 0);
+  assert(write (fd, moduli, k * sizeof(uintN_t))
+      == (ssize_t) (k * sizeof(uintN_t)));
+  close (fd);
+  out = tmpfile ();
+  assert(out != NULL);
+  assert(uintN_batchgcd_file (path, out, 0) == 4);
+  fclose (out);
+  unlink (path);
+
+  free (found);
+  free (moduli);
+}
+
+static void
+test_loadgen ()
+{
+  loadgen_conf_t conf;
+  loadgen_result_t *res;
+  uint64_t p50, p99;
+
+  res = malloc (sizeof(*res));
+  assert(res != NULL);
+
+  loadgen_conf_init (&conf);
+  conf.threads = 2;
+  conf.seconds = 0.2;
+  conf.weight[LOADGEN_SIGN] = 0;
+  assert(loadgen_run (&conf, res));
+  assert(res->threads == 2 && res->failed == 0);
+  assert(res->count[LOADGEN_SIGN] == 0);
+  assert(res->count[LOADGEN_VERIFY] > 0);
+
+  p50 = loadgen_percentile (res, LOADGEN_OPS, 0.5);
+  p99 = loadgen_percentile (res, LOADGEN_OPS, 0.99);
+  assert(p50 > 0 && p50 <= p99);
+  assert(p99 <= loadgen_percentile (res, LOADGEN_OPS, 0.999));
+  assert(loadgen_percentile (res, LOADGEN_SIGN, 0.5) == 0);
+
+  free (res);
+}
+
+static void
+test_p256 ()
+{
+  uintN_t k =
+    { 0x1234567890abcdef, 0xfedcba0987654321, 0x1111222233334444,
+	0x5555666677778888 };
+  uintN_t three =
+    { 0x03 };
+  p256_affine_t check =
+    {
+      { 0x8b3a74f61e60f32b, 0x080dd25b7dd6d8c5, 0x0019f4c2ef8d4276,
+	  0x61f94fd6bbe63bf9 },
+      { 0x718102c9585b8982, 0x9da070ffa48002c5, 0x2fe33ec146693327,
+	  0x58d61b37c9942cba } };
+  p256_affine_t check3 =
+    {
+      { 0x353a891b9b9c528f, 0xa246c24dd1070634, 0xb463ec5a82672e1a,
+	  0xd6e3a4b1a2697395 },
+      { 0x7def8e90d3f72903, 0x2a70b99c7ecedd92, 0x91ecaaff6c4846bf,
+	  0xe9314654a1b985fd } };
+  uintN_t zero =
+    { 0x00 };
+  p256_affine_t r, s;
+  p256_point_t a, b;
+
+  assert(p256_is_on_curve (&P256_G) == 1);
+
+  assert(p256_point_mul (&r, &k, &P256_G) == 1);
+  assert(memcmp (&r, &check, sizeof(r)) == 0);
+
+  assert(p256_point_mul_base (&s, &k) == 1);
+  assert(memcmp (&s, &check, sizeof(s)) == 0);
+
+  // 3 (k G) = k G + 2 (k G)
+  assert(p256_point_mul (&s, &three, &r) == 1);
+  assert(memcmp (&s, &check3, sizeof(s)) == 0);
+  p256_point_from_affine (&a, &r);
+  p256_point_double (&b, &a);
+  p256_point_add (&b, &b, &a);
+  assert(p256_point_to_affine (&s, &b) == 1);
+  assert(memcmp (&s, &check3, sizeof(s)) == 0);
+  assert(p256_is_on_curve (&s) == 1);
+
+  assert(p256_point_mul_base (&s, &zero) == 0);
+  s.y[0] ^= 1;
+  assert(p256_is_on_curve (&s) == 0);
 }
 
 void
@@ -394,6 +1781,7 @@ test ()
   test_oddeven ();
 
   test_greater ();
+  test_cmp ();
 
   test_mul ();
   test_mul_2 ();
@@ -402,10 +1790,46 @@ test ()
 
   test_pow ();
 
+  test_uintp ();
+  test_ui ();
+
+  test_div ();
   test_mod ();
   test_mod_2 ();
 
   test_modp ();
+  test_modp_2 ();
+
+  test_workspace ();
+
+  test_fixedbase ();
+
+  test_tables ();
+
+  test_modarith ();
+
+  test_modinv ();
+
+  test_modcache ();
+
+  test_reducer ();
+
+  test_rsa ();
+
+  test_jobpool ();
+
+  test_random ();
+
+  test_ntt ();
+  test_tune ();
+  test_rns ();
+  test_gf2m ();
+
+  test_batchgcd ();
+
+  test_loadgen ();
+
+  test_p256 ();
 
   printf ("Testfall avklarade.");
 }
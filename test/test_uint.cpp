@@ -0,0 +1,149 @@
+/*
+ * test_uint.cpp
+ *
+ * Tests of the C++ front end uint.hpp: the static asserts run the constexpr
+ * path (P-256 and 2048-bit Montgomery setup at compile time), the runtime
+ * checks compare the kernel path against the C API. Built on its own with
+ * the library objects other than cryptolib.c:
+ *
+ *   g++ -std=c++20 -Isrc test/test_uint.cpp <library objects> -pthread
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: pyk
+ */
+#include <cstdio>
+#include <cassert>
+
+#include "../src/uint.hpp"
+#include "../src/modarith.h"
+#include "../src/random.h"
+
+using uintn::uint_t;
+using uintn::mont_t;
+
+typedef uint_t<256> u256;
+typedef uint_t<2048> u2048;
+typedef uint_t<NUMBER_OF_BITS> uN;
+
+/* the P-256 prime */
+constexpr u256 p256 = u256::from_hex (
+    "ffffffff00000001000000000000000000000000ffffffffffffffffffffffff");
+constexpr mont_t<256> ctx256 (p256);
+
+/* R mod p = 2^256 - p */
+static_assert(ctx256.to (1)
+    == u256::from_hex (
+	"fffffffeffffffffffffffffffffffff000000000000000000000001"));
+static_assert(ctx256.from (ctx256.to (12345)) == 12345);
+/* Fermat, p is prime */
+static_assert(ctx256.pow (3, p256 - 1) == 1);
+static_assert(ctx256.pow (p256 - 1, 2) == 1);
+
+/* an odd 2048-bit modulus */
+constexpr u2048 m2048 = u2048::from_hex (
+    "b5185d113e483bf251be0aa860d9d7e550b432769c81b3f59554c672b9d6f894"
+    "9084a7ea8070b3af019c26353c68f0117759753c271c2ba61d1584a1fec833cc"
+    "1fcd84d6f8bdfebd9ea17fb170fd6323d4d6069b7073dc2e48202fe1b8504382"
+    "eff17925ad56a2e06d0977179a1529c437ed536ed62bebbd3cf8b56febf86dc8"
+    "ff89b19fd94c3e98d02e375de133a82e3575a55db256ede3a636069216ad10c6"
+    "214f06e90a156d43dda9278f9dec29391cd1a0e9e0938401cd85e3f700c2ecd4"
+    "f046cd22ea39f334d345d00c543a1fc83e4fcefebe9cae145b74943bd7aa4170"
+    "a236a09faf759682844a3b45bc53d56961c6ca3484e717bc7fdfe7e949f075f7");
+constexpr mont_t<2048> ctx2048 (m2048);
+constexpr u2048 a2048 = u2048::from_hex (
+    "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+    "fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210");
+constexpr u2048 b2048 = m2048 - 0x0f;
+
+static_assert(ctx2048.from (ctx2048.mul (ctx2048.to (a2048),
+					 ctx2048.to (b2048)))
+    == (a2048 * b2048) % m2048);
+static_assert((a2048 * b2048 + a2048) % m2048
+    == ((a2048 * b2048) % m2048 + a2048) % m2048);
+static_assert((a2048 << 100 >> 100) == a2048);
+static_assert(m2048 / a2048 * a2048 + m2048 % a2048 == m2048);
+
+static uintN_t
+random_N (size_t bits)
+{
+  uintN_t r;
+
+  uintN_random_bits (&r, bits);
+  return r;
+}
+
+static void
+test_arith ()
+{
+  uintN_t a, b, c;
+
+  for (int i = 0; i < 64; i++)
+    {
+      a = random_N (NUMBER_OF_BITS);
+      b = random_N (NUMBER_OF_BITS / 2 - i);
+      uN x (a), y (b);
+
+      uintN_add (&a, &b, &c);
+      assert(uN (c) == x + y);
+      uintN_sub (&a, &b, &c);
+      assert(uN (c) == x - y);
+      if (!uintN_iszero (&b))
+	{
+	  uintN_div (&a, &b, &c);
+	  assert(uN (c) == x / y);
+	  uintN_mod (&a, &b, &c);
+	  assert(uN (c) == x % y);
+	}
+      uintN_lshift (&a, i * 7, &c);
+      assert(uN (c) == x << (i * 7));
+      uintN_rshift (&a, i * 7, &c);
+      assert(uN (c) == x >> (i * 7));
+      assert((x < y) == uintN_isless (&a, &b));
+      assert((x == x) && !(x == x + 1));
+    }
+}
+
+static void
+test_modmul ()
+{
+  uintN_t a, b, c, m, t;
+
+  for (int i = 0; i < 32; i++)
+    {
+      m = random_N (NUMBER_OF_BITS - 8 * i);
+      m.parts[0] |= 1;
+      uintN_random_below (&a, &m);
+      uintN_random_below (&b, &m);
+      c = random_N (NUMBER_OF_BITS);
+      uN x (a), y (b), z (c), n (m);
+
+      uintN_modmul (&a, &b, &m, &t);
+      assert(uN (t) == (x * y) % n);
+      uintN_mod (&c, &m, &c);
+      uintN_modadd (&t, &c, &m, &t);
+      assert(uN (t) == (x * y + z) % n);
+      assert(uN (t) == (z + x * y) % n);
+
+      // the masked final subtraction against the C Montgomery product
+      mont_t<NUMBER_OF_BITS> ctx (n);
+      uintN_modmul (&a, &b, &m, &t);
+      assert(uN (t) == ctx.from (ctx.mul (ctx.to (x), ctx.to (y))));
+
+      if (i % 8 == 0)
+	{
+	  b = random_N (NUMBER_OF_BITS / 4);
+	  uintN_modp (&a, &b, &m, &t);
+	  assert(uN (t) == ctx.pow (x, uN (b)));
+	}
+    }
+}
+
+int
+main ()
+{
+  test_arith ();
+  test_modmul ();
+
+  printf ("Testfall avklarade.");
+  return 0;
+}